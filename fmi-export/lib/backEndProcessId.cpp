@@ -0,0 +1,50 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include <cstdlib>
+
+#include <unistd.h>
+
+#include "backend-zygote.h"
+
+
+namespace {
+
+	// Process ID of a backend instance hosted by a shared process (set per thread).
+	thread_local pid_t hosted_backend_pid = 0;
+}
+
+
+// The FMU frontend identifies the backend by the process ID of the process it has started. Backend
+// instances forked from a zygote (or hosted by a shared process) are started by the launcher, hence
+// they have to use the launcher's process ID instead of their own. The FMI++ backend component is
+// compiled with function 'getpid' replaced by this function (see CMakeLists.txt).
+extern "C" pid_t fmippex_backend_pid()
+{
+	if ( 0 != hosted_backend_pid ) return hosted_backend_pid;
+
+	const char* pid = std::getenv( NS3_FMU_BACKEND_PID_ENV );
+	return ( 0 != pid ) ? static_cast<pid_t>( std::atol( pid ) ) : getpid();
+}
+
+
+extern "C" void fmippex_set_backend_pid( pid_t pid )
+{
+	hosted_backend_pid = pid;
+}
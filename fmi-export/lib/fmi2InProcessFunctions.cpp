@@ -0,0 +1,583 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+// FMI 2.0 DLL for ns-3 FMUs in in-process mode. Instead of starting the ns-3 executable and
+// exchanging data via shared memory, the ns-3 scenario (compiled as shared library and stored
+// in the FMU's resources directory) is loaded into the same process and driven directly via
+// the C interface defined in 'in-process-api.h'.
+
+#include <string>
+#include <map>
+#include <cstdlib>
+#include <fstream>
+
+#include <dlfcn.h>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+#include "common/fmi_v2.0/fmi2Functions.h"
+
+#include "in-process-api.h"
+
+
+namespace {
+
+	// Reference to a scalar variable of the backend.
+	struct VariableRef {
+		int index;
+		int type;
+	};
+
+	struct InProcessComponent {
+		std::string instanceName;
+		fmi2CallbackFunctions functions;
+		bool loggingOn;
+
+		// Handle of the scenario library and its functions.
+		void* library;
+		ns3_fmu_create_backend_t create_backend;
+		ns3_fmu_instantiate_t instantiate;
+		ns3_fmu_lookup_t lookup;
+		ns3_fmu_set_real_t set_real;
+		ns3_fmu_get_real_t get_real;
+		ns3_fmu_set_integer_t set_integer;
+		ns3_fmu_get_integer_t get_integer;
+		ns3_fmu_set_boolean_t set_boolean;
+		ns3_fmu_get_boolean_t get_boolean;
+		ns3_fmu_set_string_t set_string;
+		ns3_fmu_get_string_t get_string;
+		ns3_fmu_set_logging_t set_logging;
+		ns3_fmu_initialize_t initialize;
+		ns3_fmu_do_step_t do_step;
+		ns3_fmu_free_t free;
+
+		// Instance of the backend (returned by 'ns3_fmu_instantiate').
+		void* instance;
+
+		std::map<fmi2ValueReference, VariableRef> variables;
+
+		fmi2Real startTime;
+		fmi2Real stopTime;
+		fmi2Boolean stopTimeDefined;
+		fmi2Real time;
+		bool initialized;
+	};
+
+	// The ns-3 simulator is a singleton, hence only one FMU instance can run in-process.
+	bool instantiated = false;
+
+
+	void logMessage( InProcessComponent* c, fmi2Status status, const char* category, const char* message )
+	{
+		if ( ( 0 == c->functions.logger ) || ( ( false == c->loggingOn ) && ( fmi2OK == status ) ) ) return;
+		c->functions.logger( c->functions.componentEnvironment, c->instanceName.c_str(), status, category, "%s", message );
+	}
+
+
+	// Retrieve a function from the scenario library.
+	template<typename T>
+	bool loadFunction( void* library, const char* name, T& function )
+	{
+		function = reinterpret_cast<T>( dlsym( library, name ) );
+		return ( 0 != function );
+	}
+
+
+	// Convert a file URI (as used for the resource location) to a path.
+	std::string pathFromUri( const std::string& uri )
+	{
+		std::string path = uri;
+		if ( 0 == path.compare( 0, 16, "file://localhost" ) ) path = path.substr( 16 );
+		else if ( 0 == path.compare( 0, 7, "file://" ) ) path = path.substr( 7 );
+		else if ( 0 == path.compare( 0, 5, "file:" ) ) path = path.substr( 5 );
+
+		// Decode percent-encoded characters.
+		std::string decoded;
+		for ( size_t i = 0; i < path.size(); ++i ) {
+			if ( ( '%' == path[i] ) && ( i + 2 < path.size() ) ) {
+				decoded += static_cast<char>( std::strtol( path.substr( i + 1, 2 ).c_str(), 0, 16 ) );
+				i += 2;
+			} else {
+				decoded += path[i];
+			}
+		}
+
+		while ( ( decoded.size() > 1 ) && ( '/' == decoded[decoded.size() - 1] ) ) decoded.erase( decoded.size() - 1 );
+		return decoded;
+	}
+
+
+	std::string baseName( const std::string& path )
+	{
+		size_t pos = path.find_last_of( '/' );
+		return ( std::string::npos == pos ) ? path : path.substr( pos + 1 );
+	}
+
+
+	// Copy a file from the resources directory to the working directory (same as in IPC mode).
+	bool copyFile( const std::string& from, const std::string& to )
+	{
+		std::ifstream in( from.c_str(), std::ios::binary );
+		if ( false == in.good() ) return false;
+		std::ofstream out( to.c_str(), std::ios::binary );
+		out << in.rdbuf();
+		return out.good();
+	}
+
+
+	bool setStartValue( InProcessComponent* c, const VariableRef& var, const std::string& value )
+	{
+		switch ( var.type ) {
+		case NS3_FMU_REAL: return 0 == c->set_real( c->instance, var.index, std::atof( value.c_str() ) );
+		case NS3_FMU_INTEGER: return 0 == c->set_integer( c->instance, var.index, std::atoi( value.c_str() ) );
+		case NS3_FMU_BOOLEAN: return 0 == c->set_boolean( c->instance, var.index, ( "true" == value ) || ( "1" == value ) );
+		case NS3_FMU_STRING: return 0 == c->set_string( c->instance, var.index, value.c_str() );
+		}
+		return false;
+	}
+
+
+	// Find the scenario library in the model description and copy the additional files to the
+	// working directory (same as in IPC mode).
+	bool readVendorAnnotations( InProcessComponent* c, const boost::property_tree::ptree& md,
+		const std::string& resources, std::string& library )
+	{
+		using boost::property_tree::ptree;
+
+		boost::optional<const ptree&> annotations = md.get_child_optional( "fmiModelDescription.VendorAnnotations" );
+		if ( false == annotations.is_initialized() ) return false;
+
+		for ( ptree::const_iterator it = annotations->begin(); it != annotations->end(); ++it ) {
+			if ( ( "Tool" != it->first ) || ( "FMI++Export" != it->second.get( "<xmlattr>.name", "" ) ) ) continue;
+
+			const ptree& tool = it->second;
+			library = tool.get( "InProcess.<xmlattr>.library", "" );
+
+			for ( ptree::const_iterator file = tool.begin(); file != tool.end(); ++file ) {
+				if ( "File" != file->first ) continue;
+				std::string file_name = baseName( pathFromUri( file->second.get( "<xmlattr>.file", "" ) ) );
+				if ( false == copyFile( resources + "/" + file_name, file_name ) ) {
+					logMessage( c, fmi2Warning, "WARNING", ( "unable to copy file: " + file_name ).c_str() );
+				}
+			}
+		}
+
+		if ( true == library.empty() ) {
+			logMessage( c, fmi2Fatal, "ERROR", "model description does not define an in-process scenario" );
+			return false;
+		}
+
+		library = resources + "/" + library;
+		return true;
+	}
+
+
+	// Map the value references to variables of the backend and apply the start values.
+	bool mapVariables( InProcessComponent* c, const boost::property_tree::ptree& md )
+	{
+		using boost::property_tree::ptree;
+
+		const ptree& variables = md.get_child( "fmiModelDescription.ModelVariables" );
+		for ( ptree::const_iterator it = variables.begin(); it != variables.end(); ++it ) {
+			if ( "ScalarVariable" != it->first ) continue;
+
+			std::string name = it->second.get( "<xmlattr>.name", "" );
+			fmi2ValueReference vr = it->second.get<fmi2ValueReference>( "<xmlattr>.valueReference" );
+
+			VariableRef var;
+			var.index = c->lookup( c->instance, name.c_str(), &var.type );
+			if ( -1 == var.index ) {
+				logMessage( c, fmi2Fatal, "ERROR", ( "unknown variable: " + name ).c_str() );
+				return false;
+			}
+
+			c->variables[vr] = var;
+
+			for ( ptree::const_iterator type = it->second.begin(); type != it->second.end(); ++type ) {
+				if ( "<xmlattr>" == type->first ) continue;
+				boost::optional<std::string> start = type->second.get_optional<std::string>( "<xmlattr>.start" );
+				if ( ( true == start.is_initialized() ) && ( false == setStartValue( c, var, *start ) ) ) {
+					logMessage( c, fmi2Warning, "WARNING", ( "unable to set start value: " + name ).c_str() );
+				}
+			}
+		}
+
+		return true;
+	}
+
+
+	bool loadScenario( InProcessComponent* c, const std::string& library )
+	{
+		c->library = dlopen( library.c_str(), RTLD_NOW | RTLD_LOCAL );
+		if ( 0 == c->library ) {
+			logMessage( c, fmi2Fatal, "ERROR", dlerror() );
+			return false;
+		}
+
+		bool ok = loadFunction( c->library, "ns3_fmu_create_backend", c->create_backend );
+		ok = loadFunction( c->library, "ns3_fmu_instantiate", c->instantiate ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_lookup", c->lookup ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_real", c->set_real ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_real", c->get_real ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_integer", c->set_integer ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_integer", c->get_integer ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_boolean", c->set_boolean ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_boolean", c->get_boolean ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_string", c->set_string ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_string", c->get_string ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_logging", c->set_logging ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_initialize", c->initialize ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_do_step", c->do_step ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_free", c->free ) && ok;
+
+		if ( false == ok ) {
+			logMessage( c, fmi2Fatal, "ERROR", "scenario library does not provide the in-process interface" );
+			return false;
+		}
+
+		c->instance = c->instantiate( c->create_backend(), ( true == c->loggingOn ) ? 1 : 0 );
+		return ( 0 != c->instance );
+	}
+
+
+	void freeComponent( InProcessComponent* c )
+	{
+		if ( 0 != c->instance ) c->free( c->instance );
+		if ( 0 != c->library ) dlclose( c->library );
+		delete c;
+		instantiated = false;
+	}
+
+
+	InProcessComponent* toComponent( fmi2Component c ) {
+		return static_cast<InProcessComponent*>( c );
+	}
+
+
+	template<typename T, typename Function>
+	fmi2Status getValues( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, T value[], int type, Function get )
+	{
+		InProcessComponent* component = toComponent( c );
+		for ( size_t i = 0; i < nvr; ++i ) {
+			std::map<fmi2ValueReference, VariableRef>::const_iterator it = component->variables.find( vr[i] );
+			if ( ( component->variables.end() == it ) || ( type != it->second.type ) ) return fmi2Error;
+			if ( 0 != get( component->instance, it->second.index, &value[i] ) ) return fmi2Error;
+		}
+		return fmi2OK;
+	}
+
+
+	template<typename T, typename Function>
+	fmi2Status setValues( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const T value[], int type, Function set )
+	{
+		InProcessComponent* component = toComponent( c );
+		for ( size_t i = 0; i < nvr; ++i ) {
+			std::map<fmi2ValueReference, VariableRef>::const_iterator it = component->variables.find( vr[i] );
+			if ( ( component->variables.end() == it ) || ( type != it->second.type ) ) return fmi2Error;
+			if ( 0 != set( component->instance, it->second.index, value[i] ) ) return fmi2Error;
+		}
+		return fmi2OK;
+	}
+}
+
+
+extern "C" {
+
+
+FMI2_Export const char* fmi2GetTypesPlatform()
+{
+	return fmi2TypesPlatform;
+}
+
+
+FMI2_Export const char* fmi2GetVersion()
+{
+	return fmi2Version;
+}
+
+
+FMI2_Export fmi2Status fmi2SetDebugLogging( fmi2Component c, fmi2Boolean loggingOn, size_t, const fmi2String[] )
+{
+	InProcessComponent* component = toComponent( c );
+	component->loggingOn = ( fmi2True == loggingOn );
+
+	// Forward the setting to the backend (opens or closes its debug trace).
+	if ( 0 != component->instance ) component->set_logging( component->instance, ( true == component->loggingOn ) ? 1 : 0 );
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Component fmi2Instantiate( fmi2String instanceName, fmi2Type fmuType, fmi2String,
+	fmi2String fmuResourceLocation, const fmi2CallbackFunctions* functions, fmi2Boolean, fmi2Boolean loggingOn )
+{
+	if ( ( fmi2CoSimulation != fmuType ) || ( 0 == fmuResourceLocation ) || ( true == instantiated ) ) return 0;
+
+	InProcessComponent* c = new InProcessComponent();
+	c->instanceName = instanceName;
+	if ( 0 != functions ) c->functions = *functions;
+	c->loggingOn = ( fmi2True == loggingOn );
+	c->library = 0;
+	c->instance = 0;
+	c->startTime = 0.;
+	c->stopTime = 0.;
+	c->stopTimeDefined = fmi2False;
+	c->time = 0.;
+	c->initialized = false;
+
+	instantiated = true;
+
+	std::string resources = pathFromUri( fmuResourceLocation );
+	std::string library;
+
+	boost::property_tree::ptree md;
+	try {
+		boost::property_tree::read_xml( resources + "/../modelDescription.xml", md );
+		if ( ( false == readVendorAnnotations( c, md, resources, library ) ) ||
+		     ( false == loadScenario( c, library ) ) ||
+		     ( false == mapVariables( c, md ) ) ) {
+			freeComponent( c );
+			return 0;
+		}
+	} catch ( const boost::property_tree::ptree_error& e ) {
+		logMessage( c, fmi2Fatal, "ERROR", e.what() );
+		freeComponent( c );
+		return 0;
+	}
+
+	return c;
+}
+
+
+FMI2_Export void fmi2FreeInstance( fmi2Component c )
+{
+	if ( 0 != c ) freeComponent( toComponent( c ) );
+}
+
+
+FMI2_Export fmi2Status fmi2SetupExperiment( fmi2Component c, fmi2Boolean, fmi2Real,
+	fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime )
+{
+	InProcessComponent* component = toComponent( c );
+	component->startTime = startTime;
+	component->stopTime = stopTime;
+	component->stopTimeDefined = stopTimeDefined;
+	component->time = startTime;
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2EnterInitializationMode( fmi2Component )
+{
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2ExitInitializationMode( fmi2Component c )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( true == component->initialized ) return fmi2OK;
+
+	if ( 0 != component->initialize( component->instance, component->startTime, component->stopTime, component->stopTimeDefined ) ) {
+		logMessage( component, fmi2Fatal, "ERROR", "initialization of backend failed" );
+		return fmi2Fatal;
+	}
+
+	component->initialized = true;
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2Terminate( fmi2Component )
+{
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2Reset( fmi2Component )
+{
+	// The ns-3 simulator can not be reset.
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetReal( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[] )
+{
+	return getValues( c, vr, nvr, value, NS3_FMU_REAL, toComponent( c )->get_real );
+}
+
+
+FMI2_Export fmi2Status fmi2GetInteger( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[] )
+{
+	return getValues( c, vr, nvr, value, NS3_FMU_INTEGER, toComponent( c )->get_integer );
+}
+
+
+FMI2_Export fmi2Status fmi2GetBoolean( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[] )
+{
+	return getValues( c, vr, nvr, value, NS3_FMU_BOOLEAN, toComponent( c )->get_boolean );
+}
+
+
+FMI2_Export fmi2Status fmi2GetString( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String value[] )
+{
+	return getValues( c, vr, nvr, value, NS3_FMU_STRING, toComponent( c )->get_string );
+}
+
+
+FMI2_Export fmi2Status fmi2SetReal( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[] )
+{
+	return setValues( c, vr, nvr, value, NS3_FMU_REAL, toComponent( c )->set_real );
+}
+
+
+FMI2_Export fmi2Status fmi2SetInteger( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[] )
+{
+	return setValues( c, vr, nvr, value, NS3_FMU_INTEGER, toComponent( c )->set_integer );
+}
+
+
+FMI2_Export fmi2Status fmi2SetBoolean( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[] )
+{
+	return setValues( c, vr, nvr, value, NS3_FMU_BOOLEAN, toComponent( c )->set_boolean );
+}
+
+
+FMI2_Export fmi2Status fmi2SetString( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[] )
+{
+	return setValues( c, vr, nvr, value, NS3_FMU_STRING, toComponent( c )->set_string );
+}
+
+
+FMI2_Export fmi2Status fmi2GetFMUstate( fmi2Component, fmi2FMUstate* )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2SetFMUstate( fmi2Component, fmi2FMUstate )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2FreeFMUstate( fmi2Component, fmi2FMUstate* )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2SerializedFMUstateSize( fmi2Component, fmi2FMUstate, size_t* )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2SerializeFMUstate( fmi2Component, fmi2FMUstate, fmi2Byte[], size_t )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2DeSerializeFMUstate( fmi2Component, const fmi2Byte[], size_t, fmi2FMUstate* )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetDirectionalDerivative( fmi2Component, const fmi2ValueReference[], size_t,
+	const fmi2ValueReference[], size_t, const fmi2Real[], fmi2Real[] )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2SetRealInputDerivatives( fmi2Component, const fmi2ValueReference[], size_t, const fmi2Integer[], const fmi2Real[] )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetRealOutputDerivatives( fmi2Component, const fmi2ValueReference[], size_t, const fmi2Integer[], fmi2Real[] )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2DoStep( fmi2Component c, fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize, fmi2Boolean )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( false == component->initialized ) return fmi2Error;
+
+	fmi2Real end_time = currentCommunicationPoint;
+	int status = component->do_step( component->instance, currentCommunicationPoint, communicationStepSize, &end_time );
+
+	if ( NS3_FMU_DISCARD == status ) {
+		// The step has returned early at the time of the next event (see 'fmi2GetRealStatus').
+		component->time = end_time;
+		return fmi2Discard;
+	} else if ( 0 != status ) {
+		logMessage( component, fmi2Error, "ERROR", "backend failed to do step" );
+		return fmi2Error;
+	}
+
+	component->time = end_time;
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2CancelStep( fmi2Component )
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetStatus( fmi2Component, const fmi2StatusKind, fmi2Status* )
+{
+	return fmi2Discard;
+}
+
+
+FMI2_Export fmi2Status fmi2GetRealStatus( fmi2Component c, const fmi2StatusKind s, fmi2Real* value )
+{
+	if ( fmi2LastSuccessfulTime != s ) return fmi2Discard;
+	*value = toComponent( c )->time;
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetIntegerStatus( fmi2Component, const fmi2StatusKind, fmi2Integer* )
+{
+	return fmi2Discard;
+}
+
+
+FMI2_Export fmi2Status fmi2GetBooleanStatus( fmi2Component, const fmi2StatusKind, fmi2Boolean* )
+{
+	return fmi2Discard;
+}
+
+
+FMI2_Export fmi2Status fmi2GetStringStatus( fmi2Component, const fmi2StatusKind, fmi2String* )
+{
+	return fmi2Discard;
+}
+
+
+}
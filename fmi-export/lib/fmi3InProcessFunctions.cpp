@@ -0,0 +1,992 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+// FMI 3.0 DLL (co-simulation) for ns-3 FMUs in in-process mode. Like the FMI 2.0 DLL for in-process
+// mode, the ns-3 scenario (compiled as shared library and stored in the FMU's resources directory)
+// is loaded into the same process and driven directly via the C interface defined in 'in-process-api.h'.
+//
+// Messages are exchanged via clocks: every integer input (output) associated to messages is clocked
+// by an input (output) clock, which ticks whenever a message is sent (delivered). Events of the backend are handled in
+// event mode, i.e., a step returns early at the time of the next event and the messages of this event
+// are delivered when entering event mode. New messages are sent with 'fmi3UpdateDiscreteStates'.
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+#include <fstream>
+
+#include <dlfcn.h>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+#include "fmi3Functions.h"
+
+#include "in-process-api.h"
+
+
+namespace {
+
+	// Variables of the FMU that are not variables of the backend.
+	const int TYPE_TIME = -1; // Independent variable.
+	const int TYPE_CLOCK = -2; // Input or output clock (index refers to the list of clocks).
+
+	// Reference to a scalar variable of the backend.
+	struct VariableRef {
+		int index;
+		int type;
+		bool binary; // String variable exchanged as raw bytes.
+		int clock; // Index of the clock of this variable (-1 if not clocked).
+	};
+
+	// Clock associated to integer inputs (messages sent) or integer outputs (messages delivered).
+	struct Clock {
+		bool input;
+		bool active;
+		std::vector<int> variables; // Indices of the clocked (integer) variables of the backend.
+	};
+
+	enum Mode {
+		MODE_INSTANTIATED,
+		MODE_INITIALIZATION,
+		MODE_EVENT,
+		MODE_STEP,
+		MODE_TERMINATED
+	};
+
+	struct InProcessComponent {
+		std::string instanceName;
+		fmi3InstanceEnvironment environment;
+		fmi3LogMessageCallback logger;
+		bool loggingOn;
+		bool eventModeUsed;
+		bool earlyReturnAllowed;
+
+		// Handle of the scenario library and its functions.
+		void* library;
+		ns3_fmu_create_backend_t create_backend;
+		ns3_fmu_instantiate_t instantiate;
+		ns3_fmu_lookup_t lookup;
+		ns3_fmu_set_real_t set_real;
+		ns3_fmu_get_real_t get_real;
+		ns3_fmu_set_integer_t set_integer;
+		ns3_fmu_get_integer_t get_integer;
+		ns3_fmu_set_boolean_t set_boolean;
+		ns3_fmu_get_boolean_t get_boolean;
+		ns3_fmu_set_string_t set_string;
+		ns3_fmu_get_string_t get_string;
+		ns3_fmu_set_binary_t set_binary;
+		ns3_fmu_get_binary_t get_binary;
+		ns3_fmu_set_logging_t set_logging;
+		ns3_fmu_initialize_t initialize;
+		ns3_fmu_do_step_t do_step;
+		ns3_fmu_free_t free;
+
+		// Instance of the backend (returned by 'ns3_fmu_instantiate').
+		void* instance;
+
+		std::map<fmi3ValueReference, VariableRef> variables;
+		std::vector<Clock> clocks;
+
+		// Index of the backend's output 'next_event_time'.
+		int nextEventTime;
+
+		fmi3Float64 startTime;
+		fmi3Float64 stopTime;
+		fmi3Boolean stopTimeDefined;
+		fmi3Float64 time;
+		Mode mode;
+
+		// Messages have been set in step mode (only without event mode).
+		bool pendingMessages;
+	};
+
+	// The ns-3 simulator is a singleton, hence only one FMU instance can run in-process.
+	bool instantiated = false;
+
+
+	void logMessage( InProcessComponent* c, fmi3Status status, const char* category, const char* message )
+	{
+		if ( ( 0 == c->logger ) || ( ( false == c->loggingOn ) && ( fmi3OK == status ) ) ) return;
+		c->logger( c->environment, status, category, message );
+	}
+
+
+	// Retrieve a function from the scenario library.
+	template<typename T>
+	bool loadFunction( void* library, const char* name, T& function )
+	{
+		function = reinterpret_cast<T>( dlsym( library, name ) );
+		return ( 0 != function );
+	}
+
+
+	std::string baseName( const std::string& path )
+	{
+		size_t pos = path.find_last_of( '/' );
+		return ( std::string::npos == pos ) ? path : path.substr( pos + 1 );
+	}
+
+
+	// Copy a file from the resources directory to the working directory (same as in IPC mode).
+	bool copyFile( const std::string& from, const std::string& to )
+	{
+		std::ifstream in( from.c_str(), std::ios::binary );
+		if ( false == in.good() ) return false;
+		std::ofstream out( to.c_str(), std::ios::binary );
+		out << in.rdbuf();
+		return out.good();
+	}
+
+
+	// Decode the start value of a binary variable (hexadecimal string).
+	std::string fromHex( const std::string& hex )
+	{
+		std::string bytes;
+		for ( size_t i = 0; i + 1 < hex.size(); i += 2 ) {
+			bytes += static_cast<char>( std::strtol( hex.substr( i, 2 ).c_str(), 0, 16 ) );
+		}
+		return bytes;
+	}
+
+
+	bool setStartValue( InProcessComponent* c, const VariableRef& var, const std::string& value )
+	{
+		if ( true == var.binary ) {
+			std::string bytes = fromHex( value );
+			return 0 == c->set_binary( c->instance, var.index, reinterpret_cast<const unsigned char*>( bytes.data() ), bytes.size() );
+		}
+
+		switch ( var.type ) {
+		case NS3_FMU_REAL: return 0 == c->set_real( c->instance, var.index, std::atof( value.c_str() ) );
+		case NS3_FMU_INTEGER: return 0 == c->set_integer( c->instance, var.index, std::atoi( value.c_str() ) );
+		case NS3_FMU_BOOLEAN: return 0 == c->set_boolean( c->instance, var.index, ( "true" == value ) || ( "1" == value ) );
+		case NS3_FMU_STRING: return 0 == c->set_string( c->instance, var.index, value.c_str() );
+		}
+		return false;
+	}
+
+
+	// Find the scenario library in the model description and copy the additional files to the
+	// working directory (same as in IPC mode).
+	bool readAnnotations( InProcessComponent* c, const boost::property_tree::ptree& md,
+		const std::string& resources, std::string& library )
+	{
+		using boost::property_tree::ptree;
+
+		boost::optional<const ptree&> annotations = md.get_child_optional( "fmiModelDescription.Annotations" );
+		if ( false == annotations.is_initialized() ) return false;
+
+		for ( ptree::const_iterator it = annotations->begin(); it != annotations->end(); ++it ) {
+			if ( ( "Annotation" != it->first ) || ( "FMI++Export" != it->second.get( "<xmlattr>.type", "" ) ) ) continue;
+
+			const ptree& tool = it->second;
+			library = tool.get( "InProcess.<xmlattr>.library", "" );
+
+			for ( ptree::const_iterator file = tool.begin(); file != tool.end(); ++file ) {
+				if ( "File" != file->first ) continue;
+				std::string file_name = baseName( file->second.get( "<xmlattr>.file", "" ) );
+				if ( false == copyFile( resources + "/" + file_name, file_name ) ) {
+					logMessage( c, fmi3Warning, "logStatusWarning", ( "unable to copy file: " + file_name ).c_str() );
+				}
+			}
+		}
+
+		if ( true == library.empty() ) {
+			logMessage( c, fmi3Fatal, "logStatusFatal", "model description does not define an in-process scenario" );
+			return false;
+		}
+
+		library = resources + "/" + library;
+		return true;
+	}
+
+
+	// Type of the backend's variable for a variable element of the model description.
+	int variableType( const std::string& element )
+	{
+		if ( "Float64" == element ) return NS3_FMU_REAL;
+		if ( "Int32" == element ) return NS3_FMU_INTEGER;
+		if ( "Boolean" == element ) return NS3_FMU_BOOLEAN;
+		if ( ( "String" == element ) || ( "Binary" == element ) ) return NS3_FMU_STRING;
+		return -1;
+	}
+
+
+	// Map the value references to variables of the backend and clocks and apply the start values.
+	bool mapVariables( InProcessComponent* c, const boost::property_tree::ptree& md )
+	{
+		using boost::property_tree::ptree;
+
+		// Clocked variables and the value references of their clocks.
+		std::vector< std::pair<fmi3ValueReference, fmi3ValueReference> > clocked;
+
+		const ptree& variables = md.get_child( "fmiModelDescription.ModelVariables" );
+		for ( ptree::const_iterator it = variables.begin(); it != variables.end(); ++it ) {
+			if ( "<xmlattr>" == it->first ) continue;
+
+			std::string name = it->second.get( "<xmlattr>.name", "" );
+			std::string causality = it->second.get( "<xmlattr>.causality", "local" );
+			fmi3ValueReference vr = it->second.get<fmi3ValueReference>( "<xmlattr>.valueReference" );
+
+			VariableRef var;
+			var.binary = ( "Binary" == it->first );
+			var.clock = -1;
+
+			if ( "independent" == causality ) {
+				var.index = -1;
+				var.type = TYPE_TIME;
+				c->variables[vr] = var;
+				continue;
+			}
+
+			if ( "Clock" == it->first ) {
+				Clock clock;
+				clock.input = ( "input" == causality );
+				clock.active = false;
+
+				var.index = static_cast<int>( c->clocks.size() );
+				var.type = TYPE_CLOCK;
+				c->variables[vr] = var;
+				c->clocks.push_back( clock );
+				continue;
+			}
+
+			var.index = c->lookup( c->instance, name.c_str(), &var.type );
+			if ( ( -1 == var.index ) || ( variableType( it->first ) != var.type ) ) {
+				logMessage( c, fmi3Fatal, "logStatusFatal", ( "unknown variable: " + name ).c_str() );
+				return false;
+			}
+
+			c->variables[vr] = var;
+
+			boost::optional<fmi3ValueReference> clock = it->second.get_optional<fmi3ValueReference>( "<xmlattr>.clocks" );
+			if ( true == clock.is_initialized() ) clocked.push_back( std::make_pair( vr, *clock ) );
+
+			// The start values of string and binary variables are defined by child elements.
+			boost::optional<std::string> start = ( ( "String" == it->first ) || ( "Binary" == it->first ) ) ?
+				it->second.get_optional<std::string>( "Start.<xmlattr>.value" ) :
+				it->second.get_optional<std::string>( "<xmlattr>.start" );
+			if ( ( true == start.is_initialized() ) && ( false == setStartValue( c, var, *start ) ) ) {
+				logMessage( c, fmi3Warning, "logStatusWarning", ( "unable to set start value: " + name ).c_str() );
+			}
+		}
+
+		// Associate the clocked variables to their clocks.
+		for ( size_t i = 0; i < clocked.size(); ++i ) {
+			std::map<fmi3ValueReference, VariableRef>::iterator clock = c->variables.find( clocked[i].second );
+			if ( ( c->variables.end() == clock ) || ( TYPE_CLOCK != clock->second.type ) ) {
+				logMessage( c, fmi3Fatal, "logStatusFatal", "unknown clock" );
+				return false;
+			}
+
+			VariableRef& var = c->variables[clocked[i].first];
+			var.clock = clock->second.index;
+			c->clocks[var.clock].variables.push_back( var.index );
+		}
+
+		int type = -1;
+		c->nextEventTime = c->lookup( c->instance, "next_event_time", &type );
+		return ( -1 != c->nextEventTime );
+	}
+
+
+	bool loadScenario( InProcessComponent* c, const std::string& library )
+	{
+		c->library = dlopen( library.c_str(), RTLD_NOW | RTLD_LOCAL );
+		if ( 0 == c->library ) {
+			logMessage( c, fmi3Fatal, "logStatusFatal", dlerror() );
+			return false;
+		}
+
+		bool ok = loadFunction( c->library, "ns3_fmu_create_backend", c->create_backend );
+		ok = loadFunction( c->library, "ns3_fmu_instantiate", c->instantiate ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_lookup", c->lookup ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_real", c->set_real ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_real", c->get_real ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_integer", c->set_integer ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_integer", c->get_integer ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_boolean", c->set_boolean ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_boolean", c->get_boolean ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_string", c->set_string ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_string", c->get_string ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_binary", c->set_binary ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_get_binary", c->get_binary ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_set_logging", c->set_logging ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_initialize", c->initialize ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_do_step", c->do_step ) && ok;
+		ok = loadFunction( c->library, "ns3_fmu_free", c->free ) && ok;
+
+		if ( false == ok ) {
+			logMessage( c, fmi3Fatal, "logStatusFatal", "scenario library does not provide the in-process interface" );
+			return false;
+		}
+
+		c->instance = c->instantiate( c->create_backend(), ( true == c->loggingOn ) ? 1 : 0 );
+		return ( 0 != c->instance );
+	}
+
+
+	void freeComponent( InProcessComponent* c )
+	{
+		if ( 0 != c->instance ) c->free( c->instance );
+		if ( 0 != c->library ) dlclose( c->library );
+		delete c;
+		instantiated = false;
+	}
+
+
+	InProcessComponent* toComponent( fmi3Instance c ) {
+		return static_cast<InProcessComponent*>( c );
+	}
+
+
+	fmi3Float64 getNextEventTime( InProcessComponent* c )
+	{
+		fmi3Float64 next = 0.;
+		c->get_real( c->instance, c->nextEventTime, &next );
+		return next;
+	}
+
+
+	void deactivateClocks( InProcessComponent* c, bool input )
+	{
+		for ( size_t i = 0; i < c->clocks.size(); ++i ) {
+			if ( input == c->clocks[i].input ) c->clocks[i].active = false;
+		}
+	}
+
+
+	// FMU iteration of the backend (step size 0) at the current time, i.e., send new messages and deliver
+	// the messages of the current event. The output clocks tick for the messages delivered. Returns the
+	// number of output clocks that tick.
+	int iterate( InProcessComponent* c )
+	{
+		// The backend does not reset the outputs of messages delivered by a previous iteration at the same
+		// time, hence the clocked outputs are reset here (otherwise their clocks would tick again).
+		for ( size_t i = 0; i < c->clocks.size(); ++i ) {
+			if ( true == c->clocks[i].input ) continue;
+			for ( size_t j = 0; j < c->clocks[i].variables.size(); ++j ) c->set_integer( c->instance, c->clocks[i].variables[j], 0 );
+		}
+
+		fmi3Float64 end_time = c->time;
+		if ( 0 != c->do_step( c->instance, c->time, 0., &end_time ) ) return -1;
+
+		c->pendingMessages = false;
+
+		int ticks = 0;
+		for ( size_t i = 0; i < c->clocks.size(); ++i ) {
+			Clock& clock = c->clocks[i];
+			if ( true == clock.input ) continue;
+
+			clock.active = false;
+			for ( size_t j = 0; j < clock.variables.size(); ++j ) {
+				int msg_id = 0;
+				c->get_integer( c->instance, clock.variables[j], &msg_id );
+				if ( 0 != msg_id ) clock.active = true;
+			}
+			if ( true == clock.active ) ++ticks;
+		}
+
+		return ticks;
+	}
+
+
+	// Enter event mode, the messages of an event at the current time are delivered right away.
+	fmi3Status enterEventMode( InProcessComponent* c )
+	{
+		c->mode = MODE_EVENT;
+
+		if ( ( c->time >= getNextEventTime( c ) ) && ( 0 > iterate( c ) ) ) {
+			logMessage( c, fmi3Error, "logStatusError", "backend failed to handle event" );
+			return fmi3Error;
+		}
+
+		return fmi3OK;
+	}
+
+
+	// Check if a variable can be set: clocked inputs can only be set in event mode while their clock is active
+	// (or in step mode in case event mode is not used).
+	bool isSettable( InProcessComponent* c, const VariableRef& var )
+	{
+		if ( ( TYPE_TIME == var.type ) || ( TYPE_CLOCK == var.type ) ) return false;
+		if ( -1 == var.clock ) return true;
+
+		if ( false == c->eventModeUsed ) {
+			c->pendingMessages = true;
+			return true;
+		}
+
+		return ( MODE_EVENT == c->mode ) && ( true == c->clocks[var.clock].active );
+	}
+
+
+	const VariableRef* findVariable( InProcessComponent* c, fmi3ValueReference vr, int type, bool binary = false )
+	{
+		std::map<fmi3ValueReference, VariableRef>::const_iterator it = c->variables.find( vr );
+		if ( ( c->variables.end() == it ) || ( type != it->second.type ) || ( binary != it->second.binary ) ) return 0;
+		return &it->second;
+	}
+
+
+	template<typename T, typename Function>
+	fmi3Status getValues( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, T value[], int type, Function get )
+	{
+		InProcessComponent* component = toComponent( c );
+		for ( size_t i = 0; i < nvr; ++i ) {
+			const VariableRef* var = findVariable( component, vr[i], type );
+			if ( ( 0 == var ) || ( 0 != get( component->instance, var->index, &value[i] ) ) ) return fmi3Error;
+		}
+		return fmi3OK;
+	}
+
+
+	template<typename T, typename Function>
+	fmi3Status setValues( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const T value[], int type, Function set )
+	{
+		InProcessComponent* component = toComponent( c );
+		for ( size_t i = 0; i < nvr; ++i ) {
+			const VariableRef* var = findVariable( component, vr[i], type );
+			if ( ( 0 == var ) || ( false == isSettable( component, *var ) ) ) return fmi3Error;
+			if ( 0 != set( component->instance, var->index, value[i] ) ) return fmi3Error;
+		}
+		return fmi3OK;
+	}
+}
+
+
+extern "C" {
+
+
+FMI3_Export const char* fmi3GetVersion()
+{
+	return fmi3Version;
+}
+
+
+FMI3_Export fmi3Status fmi3SetDebugLogging( fmi3Instance c, fmi3Boolean loggingOn, size_t, const fmi3String[] )
+{
+	InProcessComponent* component = toComponent( c );
+	component->loggingOn = ( fmi3True == loggingOn );
+
+	// Forward the setting to the backend (opens or closes its debug trace).
+	if ( 0 != component->instance ) component->set_logging( component->instance, ( true == component->loggingOn ) ? 1 : 0 );
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Instance fmi3InstantiateModelExchange( fmi3String, fmi3String, fmi3String, fmi3Boolean, fmi3Boolean,
+	fmi3InstanceEnvironment, fmi3LogMessageCallback )
+{
+	return 0;
+}
+
+
+FMI3_Export fmi3Instance fmi3InstantiateCoSimulation( fmi3String instanceName, fmi3String, fmi3String resourcePath,
+	fmi3Boolean, fmi3Boolean loggingOn, fmi3Boolean eventModeUsed, fmi3Boolean earlyReturnAllowed,
+	const fmi3ValueReference[], size_t, fmi3InstanceEnvironment instanceEnvironment,
+	fmi3LogMessageCallback logMessage, fmi3IntermediateUpdateCallback )
+{
+	if ( ( 0 == resourcePath ) || ( true == instantiated ) ) return 0;
+
+	InProcessComponent* c = new InProcessComponent();
+	c->instanceName = instanceName;
+	c->environment = instanceEnvironment;
+	c->logger = logMessage;
+	c->loggingOn = ( fmi3True == loggingOn );
+	c->eventModeUsed = ( fmi3True == eventModeUsed );
+	c->earlyReturnAllowed = ( fmi3True == earlyReturnAllowed );
+	c->library = 0;
+	c->instance = 0;
+	c->nextEventTime = -1;
+	c->startTime = 0.;
+	c->stopTime = 0.;
+	c->stopTimeDefined = fmi3False;
+	c->time = 0.;
+	c->mode = MODE_INSTANTIATED;
+	c->pendingMessages = false;
+
+	instantiated = true;
+
+	// The resource path is a native path (with a trailing separator).
+	std::string resources = resourcePath;
+	while ( ( resources.size() > 1 ) && ( '/' == resources[resources.size() - 1] ) ) resources.erase( resources.size() - 1 );
+	std::string library;
+
+	boost::property_tree::ptree md;
+	try {
+		boost::property_tree::read_xml( resources + "/../modelDescription.xml", md );
+		if ( ( false == readAnnotations( c, md, resources, library ) ) ||
+		     ( false == loadScenario( c, library ) ) ||
+		     ( false == mapVariables( c, md ) ) ) {
+			freeComponent( c );
+			return 0;
+		}
+	} catch ( const boost::property_tree::ptree_error& e ) {
+		logMessage( c, fmi3Fatal, "logStatusFatal", e.what() );
+		freeComponent( c );
+		return 0;
+	}
+
+	return c;
+}
+
+
+FMI3_Export fmi3Instance fmi3InstantiateScheduledExecution( fmi3String, fmi3String, fmi3String, fmi3Boolean, fmi3Boolean,
+	fmi3InstanceEnvironment, fmi3LogMessageCallback, fmi3ClockUpdateCallback, fmi3LockPreemptionCallback, fmi3UnlockPreemptionCallback )
+{
+	return 0;
+}
+
+
+FMI3_Export void fmi3FreeInstance( fmi3Instance c )
+{
+	if ( 0 != c ) freeComponent( toComponent( c ) );
+}
+
+
+FMI3_Export fmi3Status fmi3EnterInitializationMode( fmi3Instance c, fmi3Boolean, fmi3Float64,
+	fmi3Float64 startTime, fmi3Boolean stopTimeDefined, fmi3Float64 stopTime )
+{
+	InProcessComponent* component = toComponent( c );
+	component->startTime = startTime;
+	component->stopTime = stopTime;
+	component->stopTimeDefined = stopTimeDefined;
+	component->time = startTime;
+	component->mode = MODE_INITIALIZATION;
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3ExitInitializationMode( fmi3Instance c )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( MODE_INITIALIZATION != component->mode ) return fmi3Error;
+
+	if ( 0 != component->initialize( component->instance, component->startTime, component->stopTime, component->stopTimeDefined ) ) {
+		logMessage( component, fmi3Fatal, "logStatusFatal", "initialization of backend failed" );
+		return fmi3Fatal;
+	}
+
+	// The first event of the backend is at the start time.
+	if ( true == component->eventModeUsed ) return enterEventMode( component );
+
+	component->mode = MODE_STEP;
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3EnterEventMode( fmi3Instance c )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( MODE_STEP != component->mode ) return fmi3Error;
+
+	return enterEventMode( component );
+}
+
+
+FMI3_Export fmi3Status fmi3Terminate( fmi3Instance c )
+{
+	toComponent( c )->mode = MODE_TERMINATED;
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3Reset( fmi3Instance )
+{
+	// The ns-3 simulator can not be reset.
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3GetFloat64( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Float64 value[], size_t )
+{
+	InProcessComponent* component = toComponent( c );
+	for ( size_t i = 0; i < nvr; ++i ) {
+		if ( 0 != findVariable( component, vr[i], TYPE_TIME ) ) {
+			value[i] = component->time;
+			continue;
+		}
+
+		const VariableRef* var = findVariable( component, vr[i], NS3_FMU_REAL );
+		if ( ( 0 == var ) || ( 0 != component->get_real( component->instance, var->index, &value[i] ) ) ) return fmi3Error;
+	}
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3GetInt32( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Int32 value[], size_t )
+{
+	return getValues( c, vr, nvr, value, NS3_FMU_INTEGER, toComponent( c )->get_integer );
+}
+
+
+FMI3_Export fmi3Status fmi3GetBoolean( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Boolean value[], size_t )
+{
+	InProcessComponent* component = toComponent( c );
+	for ( size_t i = 0; i < nvr; ++i ) {
+		const VariableRef* var = findVariable( component, vr[i], NS3_FMU_BOOLEAN );
+		int b = 0;
+		if ( ( 0 == var ) || ( 0 != component->get_boolean( component->instance, var->index, &b ) ) ) return fmi3Error;
+		value[i] = ( 0 != b ) ? fmi3True : fmi3False;
+	}
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3GetString( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3String value[], size_t )
+{
+	return getValues( c, vr, nvr, value, NS3_FMU_STRING, toComponent( c )->get_string );
+}
+
+
+FMI3_Export fmi3Status fmi3GetBinary( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, size_t valueSizes[], fmi3Binary value[], size_t )
+{
+	InProcessComponent* component = toComponent( c );
+	for ( size_t i = 0; i < nvr; ++i ) {
+		const VariableRef* var = findVariable( component, vr[i], NS3_FMU_STRING, true );
+		if ( ( 0 == var ) || ( 0 != component->get_binary( component->instance, var->index, &value[i], &valueSizes[i] ) ) ) return fmi3Error;
+	}
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3GetClock( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, fmi3Clock value[] )
+{
+	InProcessComponent* component = toComponent( c );
+	for ( size_t i = 0; i < nvr; ++i ) {
+		const VariableRef* var = findVariable( component, vr[i], TYPE_CLOCK );
+		if ( 0 == var ) return fmi3Error;
+
+		// Output clocks are deactivated once they have been reported.
+		Clock& clock = component->clocks[var->index];
+		value[i] = ( true == clock.active ) ? fmi3ClockActive : fmi3ClockInactive;
+		if ( false == clock.input ) clock.active = false;
+	}
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3SetFloat64( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Float64 value[], size_t )
+{
+	return setValues( c, vr, nvr, value, NS3_FMU_REAL, toComponent( c )->set_real );
+}
+
+
+FMI3_Export fmi3Status fmi3SetInt32( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Int32 value[], size_t )
+{
+	return setValues( c, vr, nvr, value, NS3_FMU_INTEGER, toComponent( c )->set_integer );
+}
+
+
+FMI3_Export fmi3Status fmi3SetBoolean( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Boolean value[], size_t )
+{
+	InProcessComponent* component = toComponent( c );
+	for ( size_t i = 0; i < nvr; ++i ) {
+		const VariableRef* var = findVariable( component, vr[i], NS3_FMU_BOOLEAN );
+		if ( ( 0 == var ) || ( false == isSettable( component, *var ) ) ) return fmi3Error;
+		if ( 0 != component->set_boolean( component->instance, var->index, ( fmi3True == value[i] ) ? 1 : 0 ) ) return fmi3Error;
+	}
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3SetString( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3String value[], size_t )
+{
+	return setValues( c, vr, nvr, value, NS3_FMU_STRING, toComponent( c )->set_string );
+}
+
+
+FMI3_Export fmi3Status fmi3SetBinary( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const size_t valueSizes[], const fmi3Binary value[], size_t )
+{
+	InProcessComponent* component = toComponent( c );
+	for ( size_t i = 0; i < nvr; ++i ) {
+		const VariableRef* var = findVariable( component, vr[i], NS3_FMU_STRING, true );
+		if ( ( 0 == var ) || ( false == isSettable( component, *var ) ) ) return fmi3Error;
+		if ( 0 != component->set_binary( component->instance, var->index, value[i], valueSizes[i] ) ) return fmi3Error;
+	}
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3SetClock( fmi3Instance c, const fmi3ValueReference vr[], size_t nvr, const fmi3Clock value[] )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( MODE_EVENT != component->mode ) return fmi3Error;
+
+	for ( size_t i = 0; i < nvr; ++i ) {
+		const VariableRef* var = findVariable( component, vr[i], TYPE_CLOCK );
+		if ( ( 0 == var ) || ( false == component->clocks[var->index].input ) ) return fmi3Error;
+		component->clocks[var->index].active = ( fmi3ClockActive == value[i] );
+	}
+	return fmi3OK;
+}
+
+
+// Variable types not used by ns-3 FMUs.
+
+FMI3_Export fmi3Status fmi3GetFloat32( fmi3Instance, const fmi3ValueReference[], size_t, fmi3Float32[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetInt8( fmi3Instance, const fmi3ValueReference[], size_t, fmi3Int8[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetUInt8( fmi3Instance, const fmi3ValueReference[], size_t, fmi3UInt8[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetInt16( fmi3Instance, const fmi3ValueReference[], size_t, fmi3Int16[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetUInt16( fmi3Instance, const fmi3ValueReference[], size_t, fmi3UInt16[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetUInt32( fmi3Instance, const fmi3ValueReference[], size_t, fmi3UInt32[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetInt64( fmi3Instance, const fmi3ValueReference[], size_t, fmi3Int64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetUInt64( fmi3Instance, const fmi3ValueReference[], size_t, fmi3UInt64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetFloat32( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3Float32[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetInt8( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3Int8[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetUInt8( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3UInt8[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetInt16( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3Int16[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetUInt16( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3UInt16[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetUInt32( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3UInt32[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetInt64( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3Int64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetUInt64( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3UInt64[], size_t ) { return fmi3Error; }
+
+
+FMI3_Export fmi3Status fmi3GetNumberOfVariableDependencies( fmi3Instance, fmi3ValueReference, size_t* )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3GetVariableDependencies( fmi3Instance, fmi3ValueReference, size_t[], fmi3ValueReference[],
+	size_t[], fmi3DependencyKind[], size_t )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3GetFMUState( fmi3Instance, fmi3FMUState* )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3SetFMUState( fmi3Instance, fmi3FMUState )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3FreeFMUState( fmi3Instance, fmi3FMUState* )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3SerializedFMUStateSize( fmi3Instance, fmi3FMUState, size_t* )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3SerializeFMUState( fmi3Instance, fmi3FMUState, fmi3Byte[], size_t )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3DeserializeFMUState( fmi3Instance, const fmi3Byte[], size_t, fmi3FMUState* )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3GetDirectionalDerivative( fmi3Instance, const fmi3ValueReference[], size_t,
+	const fmi3ValueReference[], size_t, const fmi3Float64[], size_t, fmi3Float64[], size_t )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3GetAdjointDerivative( fmi3Instance, const fmi3ValueReference[], size_t,
+	const fmi3ValueReference[], size_t, const fmi3Float64[], size_t, fmi3Float64[], size_t )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3EnterConfigurationMode( fmi3Instance )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3ExitConfigurationMode( fmi3Instance )
+{
+	return fmi3Error;
+}
+
+
+// Clocks of ns-3 FMUs are triggered clocks, i.e., they have neither intervals nor shifts.
+
+FMI3_Export fmi3Status fmi3GetIntervalDecimal( fmi3Instance, const fmi3ValueReference[], size_t, fmi3Float64[], fmi3IntervalQualifier[] ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetIntervalFraction( fmi3Instance, const fmi3ValueReference[], size_t, fmi3UInt64[], fmi3UInt64[], fmi3IntervalQualifier[] ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetShiftDecimal( fmi3Instance, const fmi3ValueReference[], size_t, fmi3Float64[] ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetShiftFraction( fmi3Instance, const fmi3ValueReference[], size_t, fmi3UInt64[], fmi3UInt64[] ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetIntervalDecimal( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3Float64[] ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetIntervalFraction( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3UInt64[], const fmi3UInt64[] ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetShiftDecimal( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3Float64[] ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetShiftFraction( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3UInt64[], const fmi3UInt64[] ) { return fmi3Error; }
+
+
+FMI3_Export fmi3Status fmi3EvaluateDiscreteStates( fmi3Instance )
+{
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3UpdateDiscreteStates( fmi3Instance c, fmi3Boolean* discreteStatesNeedUpdate, fmi3Boolean* terminateSimulation,
+	fmi3Boolean* nominalsOfContinuousStatesChanged, fmi3Boolean* valuesOfContinuousStatesChanged, fmi3Boolean* nextEventTimeDefined,
+	fmi3Float64* nextEventTime )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( MODE_EVENT != component->mode ) return fmi3Error;
+
+	// Send the messages of the active input clocks and deliver messages postponed to this time (if any).
+	bool messages = false;
+	for ( size_t i = 0; i < component->clocks.size(); ++i ) {
+		if ( true == component->clocks[i].input ) messages = messages || component->clocks[i].active;
+	}
+
+	int ticks = 0;
+	if ( ( true == messages ) || ( component->time >= getNextEventTime( component ) ) ) ticks = iterate( component );
+
+	deactivateClocks( component, true );
+
+	if ( 0 > ticks ) {
+		logMessage( component, fmi3Error, "logStatusError", "backend failed to handle event" );
+		return fmi3Error;
+	}
+
+	// Another iteration is needed if there are more messages to be delivered at this time.
+	fmi3Float64 next = getNextEventTime( component );
+	*discreteStatesNeedUpdate = ( ( 0 < ticks ) || ( component->time >= next ) ) ? fmi3True : fmi3False;
+	*terminateSimulation = fmi3False;
+	*nominalsOfContinuousStatesChanged = fmi3False;
+	*valuesOfContinuousStatesChanged = fmi3False;
+	*nextEventTimeDefined = fmi3True;
+	*nextEventTime = next;
+	return fmi3OK;
+}
+
+
+// Model exchange is not supported.
+
+FMI3_Export fmi3Status fmi3EnterContinuousTimeMode( fmi3Instance ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3CompletedIntegratorStep( fmi3Instance, fmi3Boolean, fmi3Boolean*, fmi3Boolean* ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetTime( fmi3Instance, fmi3Float64 ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3SetContinuousStates( fmi3Instance, const fmi3Float64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetContinuousStateDerivatives( fmi3Instance, fmi3Float64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetEventIndicators( fmi3Instance, fmi3Float64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetContinuousStates( fmi3Instance, fmi3Float64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetNominalsOfContinuousStates( fmi3Instance, fmi3Float64[], size_t ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetNumberOfEventIndicators( fmi3Instance, size_t* ) { return fmi3Error; }
+FMI3_Export fmi3Status fmi3GetNumberOfContinuousStates( fmi3Instance, size_t* ) { return fmi3Error; }
+
+
+FMI3_Export fmi3Status fmi3EnterStepMode( fmi3Instance c )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( MODE_EVENT != component->mode ) return fmi3Error;
+
+	deactivateClocks( component, true );
+	deactivateClocks( component, false );
+	component->mode = MODE_STEP;
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3GetOutputDerivatives( fmi3Instance, const fmi3ValueReference[], size_t, const fmi3Int32[], fmi3Float64[], size_t )
+{
+	return fmi3Error;
+}
+
+
+FMI3_Export fmi3Status fmi3DoStep( fmi3Instance c, fmi3Float64 currentCommunicationPoint, fmi3Float64 communicationStepSize,
+	fmi3Boolean, fmi3Boolean* eventHandlingNeeded, fmi3Boolean* terminateSimulation, fmi3Boolean* earlyReturn, fmi3Float64* lastSuccessfulTime )
+{
+	InProcessComponent* component = toComponent( c );
+	if ( MODE_STEP != component->mode ) return fmi3Error;
+
+	*eventHandlingNeeded = fmi3False;
+	*terminateSimulation = fmi3False;
+	*earlyReturn = fmi3False;
+	*lastSuccessfulTime = currentCommunicationPoint;
+
+	component->time = currentCommunicationPoint;
+
+	// Without event mode, events are handled at the beginning of the step (new messages and messages
+	// postponed to the current time) and at its end. The step returns right away in case messages have
+	// been delivered at the beginning, otherwise these messages would not be visible to the master.
+	if ( ( false == component->eventModeUsed ) &&
+	     ( ( true == component->pendingMessages ) || ( component->time >= getNextEventTime( component ) ) ) ) {
+		int ticks = iterate( component );
+		if ( 0 > ticks ) {
+			logMessage( component, fmi3Error, "logStatusError", "backend failed to handle event" );
+			return fmi3Error;
+		} else if ( 0 < ticks ) {
+			*earlyReturn = fmi3True;
+			return ( true == component->earlyReturnAllowed ) ? fmi3OK : fmi3Discard;
+		}
+	}
+
+	// Output clocks only tick in event mode.
+	deactivateClocks( component, false );
+
+	fmi3Float64 end_time = currentCommunicationPoint;
+	int status = component->do_step( component->instance, currentCommunicationPoint, communicationStepSize, &end_time );
+
+	if ( ( NS3_FMU_DISCARD != status ) && ( 0 != status ) ) {
+		logMessage( component, fmi3Error, "logStatusError", "backend failed to do step" );
+		return fmi3Error;
+	}
+
+	component->time = end_time;
+	*lastSuccessfulTime = end_time;
+
+	if ( component->time >= getNextEventTime( component ) ) {
+		// The step has reached the time of the next event.
+		if ( true == component->eventModeUsed ) {
+			*eventHandlingNeeded = fmi3True;
+		} else if ( 0 > iterate( component ) ) {
+			logMessage( component, fmi3Error, "logStatusError", "backend failed to handle event" );
+			return fmi3Error;
+		}
+	}
+
+	if ( NS3_FMU_DISCARD == status ) {
+		// The step has returned early at the time of the next event.
+		*earlyReturn = fmi3True;
+		return ( true == component->earlyReturnAllowed ) ? fmi3OK : fmi3Discard;
+	}
+
+	return fmi3OK;
+}
+
+
+FMI3_Export fmi3Status fmi3ActivateModelPartition( fmi3Instance, fmi3ValueReference, fmi3Float64 )
+{
+	return fmi3Error;
+}
+
+
+}
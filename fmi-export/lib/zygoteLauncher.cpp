@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+// Launcher for backends forked from a zygote (see 'backend-zygote.h'). The FMU frontend starts this
+// launcher instead of the backend executable:
+//
+//   ns3_fmu_launcher [--shared] <backend-executable> [arguments ...]
+//
+// The launcher connects to the zygote of the backend executable (which is started in case it is not
+// yet running) and asks it to fork a new backend instance. The instance takes over the launcher's
+// command line arguments, working directory, environment and standard streams. The launcher waits
+// for the instance to finish (forwarding signals to it) and exits with the same status. In case
+// no zygote is available, the launcher simply executes the backend executable.
+//
+// With option '--shared', the zygote hosts the backend instances in threads of a single process instead
+// of forking them. When the launcher is terminated, the zygote cancels the according backend instance.
+//
+// The zygote's socket is identified by the content of the backend executable, hence the zygote can be
+// re-used by FMU instances extracted to different directories. The socket is located in a directory
+// that only the user can access ($XDG_RUNTIME_DIR or /tmp/ns3-fmu-zygote-<uid>), and both the launcher
+// and the zygote check that the peer of a connection belongs to the same user. Environment
+// variable NS3_FMU_ZYGOTE_IDLE_TIME sets the number of seconds the zygote is kept warm after the
+// last request (default: 600).
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "backend-zygote.h"
+
+
+extern char** environ;
+
+
+namespace {
+
+	// How long to wait for a newly started zygote (in milliseconds).
+	const int ZYGOTE_STARTUP_TIMEOUT = 10000;
+
+	volatile sig_atomic_t instance_pid = 0;
+
+
+	void forwardSignal( int sig )
+	{
+		if ( 0 < instance_pid ) kill( instance_pid, sig );
+	}
+
+
+	bool writeAll( int fd, const void* data, size_t size )
+	{
+		const char* p = static_cast<const char*>( data );
+		while ( 0 < size ) {
+			ssize_t n = write( fd, p, size );
+			if ( ( 0 > n ) && ( EINTR == errno ) ) continue;
+			if ( 0 >= n ) return false;
+			p += n;
+			size -= n;
+		}
+		return true;
+	}
+
+
+	bool readAll( int fd, void* data, size_t size )
+	{
+		char* p = static_cast<char*>( data );
+		while ( 0 < size ) {
+			ssize_t n = read( fd, p, size );
+			if ( ( 0 > n ) && ( EINTR == errno ) ) continue;
+			if ( 0 >= n ) return false;
+			p += n;
+			size -= n;
+		}
+		return true;
+	}
+
+
+	// Resolve the backend executable (relative paths are relative to the launcher's directory).
+	std::string resolveExecutable( const std::string& name )
+	{
+		if ( '/' == name[0] ) return name;
+
+		char self[4096];
+		ssize_t n = readlink( "/proc/self/exe", self, sizeof( self ) - 1 );
+		if ( 0 >= n ) return name;
+		self[n] = 0;
+
+		std::string dir( self );
+		return dir.substr( 0, dir.find_last_of( '/' ) + 1 ) + name;
+	}
+
+
+	// Check that the directory exists, is no symbolic link, belongs to the user and cannot be accessed by others.
+	bool isPrivateDirectory( const std::string& dir )
+	{
+		struct stat info;
+		if ( 0 != lstat( dir.c_str(), &info ) ) return false;
+		return ( S_ISDIR( info.st_mode ) ) && ( getuid() == info.st_uid ) && ( 0 == ( info.st_mode & 077 ) );
+	}
+
+
+	// Directory for the sockets of the user's zygotes (empty in case there is no private directory).
+	std::string socketDirectory()
+	{
+		const char* runtime_dir = std::getenv( "XDG_RUNTIME_DIR" );
+		if ( ( 0 != runtime_dir ) && ( 0 != *runtime_dir ) && ( true == isPrivateDirectory( runtime_dir ) ) ) return runtime_dir;
+
+		char dir[64];
+		std::snprintf( dir, sizeof( dir ), "/tmp/ns3-fmu-zygote-%u", static_cast<unsigned>( getuid() ) );
+		if ( ( 0 != mkdir( dir, 0700 ) ) && ( EEXIST != errno ) ) return std::string();
+		return ( true == isPrivateDirectory( dir ) ) ? dir : std::string();
+	}
+
+
+	// Socket path of the zygote, derived from the content of the executable (FNV-1a). Returns an empty
+	// string in case there is no private directory for the socket.
+	std::string socketPath( const std::string& executable, bool shared )
+	{
+		std::string dir = socketDirectory();
+		if ( true == dir.empty() ) return dir;
+
+		uint64_t hash = 14695981039346656037ULL;
+
+		std::ifstream file( executable.c_str(), std::ios::binary );
+		char buffer[65536];
+		while ( file.read( buffer, sizeof( buffer ) ) || ( 0 < file.gcount() ) ) {
+			for ( std::streamsize i = 0; i < file.gcount(); ++i ) {
+				hash ^= static_cast<unsigned char>( buffer[i] );
+				hash *= 1099511628211ULL;
+			}
+		}
+
+		char name[64];
+		std::snprintf( name, sizeof( name ), "/ns3-fmu-zygote-%016llx%s",
+			static_cast<unsigned long long>( hash ), ( true == shared ) ? "-shared" : "" );
+		return dir + name;
+	}
+
+
+	// Check that the peer of the connection belongs to the same user.
+	bool isPeerUser( int fd )
+	{
+#ifdef SO_PEERCRED
+		ucred cred;
+		socklen_t size = sizeof( cred );
+		return ( 0 == getsockopt( fd, SOL_SOCKET, SO_PEERCRED, &cred, &size ) ) && ( getuid() == cred.uid );
+#else
+		return false;
+#endif
+	}
+
+
+	// Connect to the zygote (only if it runs as the same user).
+	int connectTo( const std::string& path )
+	{
+		sockaddr_un addr;
+		std::memset( &addr, 0, sizeof( addr ) );
+		addr.sun_family = AF_UNIX;
+		if ( ( true == path.empty() ) || ( path.size() >= sizeof( addr.sun_path ) ) ) return -1;
+		std::strncpy( addr.sun_path, path.c_str(), sizeof( addr.sun_path ) - 1 );
+
+		int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+		if ( 0 > fd ) return -1;
+
+		if ( ( 0 != connect( fd, reinterpret_cast<sockaddr*>( &addr ), sizeof( addr ) ) ) || ( false == isPeerUser( fd ) ) ) {
+			close( fd );
+			return -1;
+		}
+
+		return fd;
+	}
+
+
+	// Start the zygote as daemon (detached from the launcher's session and standard streams).
+	void startZygote( const std::string& executable, const std::string& path, bool shared )
+	{
+		const char* idle_time = std::getenv( "NS3_FMU_ZYGOTE_IDLE_TIME" );
+		std::string zygote_arg = "--zygote=" + path;
+		std::string idle_arg = std::string( "--zygote-idle-time=" ) + ( ( 0 != idle_time ) ? idle_time : "600" );
+
+		pid_t pid = fork();
+		if ( 0 == pid ) {
+			setsid();
+			if ( 0 == fork() ) {
+				int null_fd = open( "/dev/null", O_RDWR );
+				for ( int i = 0; i < 3; ++i ) dup2( null_fd, i );
+				if ( 2 < null_fd ) close( null_fd );
+
+				unsetenv( NS3_FMU_BACKEND_PID_ENV );
+				const char* args[] = { executable.c_str(), zygote_arg.c_str(), idle_arg.c_str(), ( true == shared ) ? "--zygote-shared" : 0, 0 };
+				execv( executable.c_str(), const_cast<char* const*>( args ) );
+			}
+			_exit( 0 );
+		}
+
+		if ( 0 < pid ) waitpid( pid, 0, 0 );
+	}
+
+
+	// Send the request (including the standard streams) to the zygote.
+	bool sendRequest( int fd, const std::string& executable, int argc, char* argv[], int first_arg )
+	{
+		char cwd[4096];
+		if ( 0 == getcwd( cwd, sizeof( cwd ) ) ) return false;
+
+		std::string payload( cwd, std::strlen( cwd ) + 1 );
+
+		payload.append( executable.c_str(), executable.size() + 1 );
+		for ( int i = first_arg + 1; i < argc; ++i ) payload.append( argv[i], std::strlen( argv[i] ) + 1 );
+
+		uint32_t n_env = 0;
+		for ( char** env = environ; 0 != *env; ++env, ++n_env ) payload.append( *env, std::strlen( *env ) + 1 );
+
+		BackEndZygote::Request request;
+		request.magic = BackEndZygote::REQUEST_MAGIC;
+		request.launcher_pid = static_cast<int32_t>( getpid() );
+		request.n_args = static_cast<uint32_t>( argc - first_arg );
+		request.n_env = n_env;
+		request.payload_size = static_cast<uint32_t>( payload.size() );
+
+		int streams[3] = { 0, 1, 2 };
+		char control[CMSG_SPACE( sizeof( streams ) )];
+		std::memset( control, 0, sizeof( control ) );
+
+		iovec iov;
+		iov.iov_base = &request;
+		iov.iov_len = sizeof( request );
+
+		msghdr msg;
+		std::memset( &msg, 0, sizeof( msg ) );
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof( control );
+
+		cmsghdr* cmsg = CMSG_FIRSTHDR( &msg );
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN( sizeof( streams ) );
+		std::memcpy( CMSG_DATA( cmsg ), streams, sizeof( streams ) );
+
+		ssize_t n;
+		do { n = sendmsg( fd, &msg, 0 ); } while ( ( 0 > n ) && ( EINTR == errno ) );
+		if ( static_cast<ssize_t>( sizeof( request ) ) != n ) return false;
+
+		return writeAll( fd, payload.data(), payload.size() );
+	}
+}
+
+
+int main( int argc, char* argv[] )
+{
+	bool shared = ( 1 < argc ) && ( 0 == std::strcmp( argv[1], "--shared" ) );
+	int first_arg = ( true == shared ) ? 2 : 1; // Index of the backend executable.
+
+	if ( first_arg >= argc ) {
+		std::fprintf( stderr, "usage: %s [--shared] <backend-executable> [arguments ...]\n", argv[0] );
+		return 2;
+	}
+
+	std::string executable = resolveExecutable( argv[first_arg] );
+	std::string path = socketPath( executable, shared );
+
+	int fd = connectTo( path );
+	if ( ( 0 > fd ) && ( false == path.empty() ) ) {
+		startZygote( executable, path, shared );
+		for ( int waited = 0; ( 0 > fd ) && ( waited < ZYGOTE_STARTUP_TIMEOUT ); waited += 5 ) {
+			usleep( 5000 );
+			fd = connectTo( path );
+		}
+	}
+
+	int32_t pid = 0;
+	if ( ( 0 > fd ) || ( false == sendRequest( fd, executable, argc, argv, first_arg ) ) || ( false == readAll( fd, &pid, sizeof( pid ) ) ) || ( 0 >= pid ) ) {
+		// No zygote available, execute the backend directly.
+		if ( 0 <= fd ) close( fd );
+		argv[first_arg] = const_cast<char*>( executable.c_str() );
+		execv( executable.c_str(), argv + first_arg );
+		std::perror( executable.c_str() );
+		return 127;
+	}
+
+	// Forward signals (e.g., when the frontend terminates the backend) to the instance. A hosted instance
+	// reports the launcher's own process ID, it is cancelled by the zygote when the launcher terminates.
+	if ( getpid() != pid ) {
+		instance_pid = pid;
+		signal( SIGTERM, forwardSignal );
+		signal( SIGINT, forwardSignal );
+		signal( SIGHUP, forwardSignal );
+	}
+
+	int32_t status = 0;
+	if ( false == readAll( fd, &status, sizeof( status ) ) ) return 1;
+
+	if ( WIFSIGNALED( status ) ) return 128 + WTERMSIG( status );
+	return WEXITSTATUS( status );
+}
@@ -0,0 +1,619 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include "backend-zygote.h"
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+
+extern char** environ;
+
+// Set the process ID used by the calling thread to identify itself to the FMU frontend (see 'lib/backEndProcessId.cpp').
+extern "C" void fmippex_set_backend_pid( pid_t pid );
+
+
+namespace {
+
+	const char* ZYGOTE_OPTION = "--zygote=";
+	const char* IDLE_TIME_OPTION = "--zygote-idle-time=";
+	const char* SHARED_OPTION = "--zygote-shared";
+	const int DEFAULT_IDLE_TIME = 600; // Seconds.
+
+	// Command line arguments and environment of the forked backend instance.
+	std::vector<std::string> instance_strings;
+	std::vector<const char*> instance_argv;
+	std::vector<char*> instance_env;
+
+	// Backend instance hosted by a shared process.
+	struct HostedInstance {
+		BackEndZygote::BackEndMain backend_main;
+		int conn;
+		int32_t launcher_pid;
+		std::string cwd;
+		std::vector<std::string> args;
+		pthread_t thread;
+		bool finished; // Guarded by 'hosted_mutex'.
+		bool cancelled;
+	};
+
+	bool shared_process = false;
+	std::mutex hosted_mutex;
+	int wake_up_pipe[2] = { -1, -1 };
+
+	// Self-pipe of a monitor process, written to when the backend instance exits.
+	int child_exit_pipe[2] = { -1, -1 };
+
+
+	bool writeAll( int fd, const void* data, size_t size )
+	{
+		const char* p = static_cast<const char*>( data );
+		while ( 0 < size ) {
+			ssize_t n = write( fd, p, size );
+			if ( ( 0 > n ) && ( EINTR == errno ) ) continue;
+			if ( 0 >= n ) return false;
+			p += n;
+			size -= n;
+		}
+		return true;
+	}
+
+
+	bool readAll( int fd, void* data, size_t size )
+	{
+		char* p = static_cast<char*>( data );
+		while ( 0 < size ) {
+			ssize_t n = read( fd, p, size );
+			if ( ( 0 > n ) && ( EINTR == errno ) ) continue;
+			if ( 0 >= n ) return false;
+			p += n;
+			size -= n;
+		}
+		return true;
+	}
+
+
+	// Check that the peer of the connection belongs to the same user.
+	bool isPeerUser( int fd )
+	{
+#ifdef SO_PEERCRED
+		ucred cred;
+		socklen_t size = sizeof( cred );
+		return ( 0 == getsockopt( fd, SOL_SOCKET, SO_PEERCRED, &cred, &size ) ) && ( getuid() == cred.uid );
+#else
+		return false;
+#endif
+	}
+
+
+	// Accept a connection (only from the same user).
+	int acceptFrom( int listen_fd )
+	{
+		int conn = accept( listen_fd, 0, 0 );
+		if ( ( 0 <= conn ) && ( false == isPeerUser( conn ) ) ) {
+			close( conn );
+			return -1;
+		}
+		return conn;
+	}
+
+
+	// Receive the request header together with the launcher's standard streams.
+	bool receiveHeader( int fd, BackEndZygote::Request& request, int streams[3] )
+	{
+		char control[CMSG_SPACE( 3 * sizeof( int ) )];
+		std::memset( control, 0, sizeof( control ) );
+
+		iovec iov;
+		iov.iov_base = &request;
+		iov.iov_len = sizeof( request );
+
+		msghdr msg;
+		std::memset( &msg, 0, sizeof( msg ) );
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof( control );
+
+		ssize_t n;
+		do { n = recvmsg( fd, &msg, 0 ); } while ( ( 0 > n ) && ( EINTR == errno ) );
+
+		cmsghdr* cmsg = CMSG_FIRSTHDR( &msg );
+		if ( ( 0 == cmsg ) || ( SCM_RIGHTS != cmsg->cmsg_type ) || ( CMSG_LEN( 3 * sizeof( int ) ) != cmsg->cmsg_len ) ) return false;
+		std::memcpy( streams, CMSG_DATA( cmsg ), 3 * sizeof( int ) );
+
+		// The header may have been split (which does not happen in practice for such a small message).
+		if ( 0 >= n ) return false;
+		if ( ( static_cast<size_t>( n ) < sizeof( request ) ) &&
+		     ( false == readAll( fd, reinterpret_cast<char*>( &request ) + n, sizeof( request ) - n ) ) ) return false;
+
+		return ( BackEndZygote::REQUEST_MAGIC == request.magic );
+	}
+
+
+	// Parse the payload of a request (working directory, command line arguments, environment).
+	bool parsePayload( const std::vector<char>& payload, const BackEndZygote::Request& request, std::string& cwd )
+	{
+		std::vector<std::string> strings;
+		size_t pos = 0;
+		while ( pos < payload.size() ) {
+			const char* s = &payload[pos];
+			size_t len = strnlen( s, payload.size() - pos );
+			if ( pos + len == payload.size() ) return false; // Not null-terminated.
+			strings.push_back( std::string( s, len ) );
+			pos += len + 1;
+		}
+
+		if ( strings.size() != 1 + request.n_args + request.n_env ) return false;
+
+		cwd = strings[0];
+		instance_strings.assign( strings.begin() + 1, strings.end() );
+
+		for ( uint32_t i = 0; i < request.n_args; ++i ) instance_argv.push_back( instance_strings[i].c_str() );
+		instance_argv.push_back( 0 );
+
+		for ( uint32_t i = 0; i < request.n_env; ++i ) instance_env.push_back( const_cast<char*>( instance_strings[request.n_args + i].c_str() ) );
+		instance_env.push_back( 0 );
+
+		return ( 0 < request.n_args );
+	}
+
+
+	// Create the socket of the zygote. In case another zygote already serves the same socket, return -1.
+	int listenOn( const std::string& path )
+	{
+		sockaddr_un addr;
+		std::memset( &addr, 0, sizeof( addr ) );
+		addr.sun_family = AF_UNIX;
+		if ( path.size() >= sizeof( addr.sun_path ) ) return -1;
+		std::strncpy( addr.sun_path, path.c_str(), sizeof( addr.sun_path ) - 1 );
+
+		int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+		if ( 0 > fd ) return -1;
+
+		mode_t mask = umask( 0077 ); // Only the user may connect.
+		int result = bind( fd, reinterpret_cast<sockaddr*>( &addr ), sizeof( addr ) );
+		if ( ( 0 != result ) && ( EADDRINUSE == errno ) ) {
+			// Check if the socket is stale.
+			int probe = socket( AF_UNIX, SOCK_STREAM, 0 );
+			bool alive = ( 0 == connect( probe, reinterpret_cast<sockaddr*>( &addr ), sizeof( addr ) ) );
+			close( probe );
+			if ( false == alive ) {
+				unlink( path.c_str() );
+				result = bind( fd, reinterpret_cast<sockaddr*>( &addr ), sizeof( addr ) );
+			}
+		}
+		umask( mask );
+
+		if ( ( 0 != result ) || ( 0 != listen( fd, 64 ) ) ) {
+			close( fd );
+			return -1;
+		}
+
+		return fd;
+	}
+
+
+	// Set up the process of the forked backend instance.
+	void setUpInstance( int conn, const int streams[3], const std::string& cwd, int32_t launcher_pid )
+	{
+		close( conn );
+
+		signal( SIGCHLD, SIG_DFL );
+		close( child_exit_pipe[0] );
+		close( child_exit_pipe[1] );
+
+		for ( int i = 0; i < 3; ++i ) {
+			dup2( streams[i], i );
+			if ( 2 < streams[i] ) close( streams[i] );
+		}
+
+		if ( 0 != chdir( cwd.c_str() ) ) _exit( 127 );
+
+		environ = &instance_env[0];
+		setenv( NS3_FMU_BACKEND_PID_ENV, std::to_string( launcher_pid ).c_str(), 1 );
+	}
+
+
+	void notifyChildExit( int )
+	{
+		int saved_errno = errno;
+		char c = 0;
+		ssize_t n = write( child_exit_pipe[1], &c, 1 );
+		(void) n;
+		errno = saved_errno;
+	}
+
+
+	// Wait for the backend instance forked by a monitor process. In case the launcher exits before (e.g., it
+	// has been killed by the FMU frontend), the instance is killed. Returns the instance's exit status.
+	int waitForInstance( pid_t instance, int conn )
+	{
+		int status = 0;
+		while ( true )
+		{
+			pid_t result = waitpid( instance, &status, WNOHANG );
+			if ( instance == result ) return status;
+			if ( ( 0 > result ) && ( EINTR != errno ) ) return 0;
+
+			// The launcher does not send anything after the request, i.e., the connection only becomes
+			// readable when the launcher has exited.
+			pollfd pfds[2];
+			pfds[0].fd = child_exit_pipe[0];
+			pfds[1].fd = conn;
+			for ( int i = 0; i < 2; ++i ) {
+				pfds[i].events = POLLIN;
+				pfds[i].revents = 0;
+			}
+
+			if ( 0 > poll( pfds, 2, -1 ) ) continue;
+
+			if ( 0 != pfds[0].revents ) {
+				char buffer[64];
+				ssize_t n = read( child_exit_pipe[0], buffer, sizeof( buffer ) );
+				(void) n;
+			}
+
+			if ( 0 != pfds[1].revents ) {
+				kill( instance, SIGKILL );
+				while ( ( 0 > waitpid( instance, &status, 0 ) ) && ( EINTR == errno ) ) {}
+				return status;
+			}
+		}
+	}
+
+
+	// Mark a hosted backend instance as finished (also when the thread has been cancelled) and wake up the zygote.
+	class FinishHostedInstance
+	{
+	public:
+
+		explicit FinishHostedInstance( HostedInstance* instance ) : instance_( instance ) {}
+
+		~FinishHostedInstance()
+		{
+			{
+				std::lock_guard<std::mutex> lock( hosted_mutex );
+				instance_->finished = true;
+			}
+			char c = 0;
+			writeAll( wake_up_pipe[1], &c, 1 );
+		}
+
+	private:
+
+		HostedInstance* instance_;
+	};
+
+
+	// Give the calling thread its own working directory (only supported on Linux).
+	bool unshareWorkingDirectory()
+	{
+#ifdef __linux__
+		return ( 0 == unshare( CLONE_FS ) );
+#else
+		return false;
+#endif
+	}
+
+
+	// Thread of a hosted backend instance.
+	void* runHostedInstance( void* data )
+	{
+		// Cancellation is only enabled while waiting for the FMU frontend (see class 'ThreadCancellation').
+		pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, 0 );
+
+		HostedInstance* instance = static_cast<HostedInstance*>( data );
+		FinishHostedInstance finish( instance );
+
+		// The thread gets its own working directory, the FMU frontend identifies it by the launcher's process ID.
+		int exit_code = 127;
+		if ( ( true == unshareWorkingDirectory() ) && ( 0 == chdir( instance->cwd.c_str() ) ) ) {
+			fmippex_set_backend_pid( instance->launcher_pid );
+
+			std::vector<const char*> argv;
+			for ( size_t i = 0; i < instance->args.size(); ++i ) argv.push_back( instance->args[i].c_str() );
+			argv.push_back( 0 );
+
+			exit_code = instance->backend_main( static_cast<int>( instance->args.size() ), &argv[0] );
+		}
+
+		// Report the exit status to the launcher (encoded like the status returned by 'waitpid').
+		int32_t status = ( exit_code & 0xff ) << 8;
+		writeAll( instance->conn, &status, sizeof( status ) );
+
+		return 0;
+	}
+
+
+	// Host a new backend instance in its own thread.
+	HostedInstance* startHostedInstance( int conn, const BackEndZygote::Request& request,
+		const std::string& cwd, BackEndZygote::BackEndMain backend_main )
+	{
+		HostedInstance* instance = new HostedInstance;
+		instance->backend_main = backend_main;
+		instance->conn = conn;
+		instance->launcher_pid = request.launcher_pid;
+		instance->cwd = cwd;
+		instance->args.assign( instance_strings.begin(), instance_strings.begin() + request.n_args );
+		instance->finished = false;
+		instance->cancelled = false;
+
+		// The launcher's process ID tells it that the instance is hosted (instead of the process ID of a forked instance).
+		int32_t pid = request.launcher_pid;
+		if ( ( false == writeAll( conn, &pid, sizeof( pid ) ) ) ||
+		     ( 0 != pthread_create( &instance->thread, 0, runHostedInstance, instance ) ) ) {
+			delete instance;
+			return 0;
+		}
+
+		return instance;
+	}
+
+
+	// Serve requests by hosting the backend instances in threads of this process.
+	void serveShared( int listen_fd, int idle_time, BackEndZygote::BackEndMain backend_main )
+	{
+		if ( 0 != pipe( wake_up_pipe ) ) return;
+
+		shared_process = true;
+
+		std::vector<HostedInstance*> instances;
+
+		while ( true )
+		{
+			// Wait for new requests, finished instances and launchers that have exited.
+			std::vector<pollfd> pfds( 2 + instances.size() );
+			pfds[0].fd = listen_fd;
+			pfds[1].fd = wake_up_pipe[0];
+			for ( size_t i = 0; i < instances.size(); ++i ) pfds[2 + i].fd = ( true == instances[i]->cancelled ) ? -1 : instances[i]->conn;
+			for ( size_t i = 0; i < pfds.size(); ++i ) {
+				pfds[i].events = POLLIN;
+				pfds[i].revents = 0;
+			}
+
+			int timeout = ( ( 0 < idle_time ) && ( true == instances.empty() ) ) ? idle_time * 1000 : -1;
+			int ready = poll( &pfds[0], pfds.size(), timeout );
+			if ( ( 0 > ready ) && ( EINTR == errno ) ) continue;
+			if ( 0 >= ready ) break; // Idle for too long (or error).
+
+			if ( 0 != pfds[1].revents ) {
+				char buffer[64];
+				ssize_t n = read( wake_up_pipe[0], buffer, sizeof( buffer ) );
+				(void) n;
+			}
+
+			// The launcher of a running instance has exited (e.g., the FMU frontend has killed it).
+			// The instance is cancelled the next time it waits for the frontend.
+			for ( size_t i = 0; i < instances.size(); ++i ) {
+				if ( 0 == pfds[2 + i].revents ) continue;
+				std::lock_guard<std::mutex> lock( hosted_mutex );
+				if ( false == instances[i]->finished ) pthread_cancel( instances[i]->thread );
+				instances[i]->cancelled = true;
+			}
+
+			// Clean up finished instances.
+			for ( size_t i = 0; i < instances.size(); ) {
+				bool finished;
+				{
+					std::lock_guard<std::mutex> lock( hosted_mutex );
+					finished = instances[i]->finished;
+				}
+				if ( false == finished ) {
+					++i;
+					continue;
+				}
+				pthread_join( instances[i]->thread, 0 );
+				close( instances[i]->conn );
+				delete instances[i];
+				instances.erase( instances.begin() + i );
+			}
+
+			if ( 0 == pfds[0].revents ) continue;
+
+			int conn = acceptFrom( listen_fd );
+			if ( 0 > conn ) continue;
+
+			BackEndZygote::Request request;
+			int streams[3] = { -1, -1, -1 };
+			std::vector<char> payload;
+			std::string cwd;
+
+			bool ok = receiveHeader( conn, request, streams );
+			if ( true == ok ) {
+				payload.resize( request.payload_size );
+				ok = readAll( conn, payload.data(), payload.size() ) && parsePayload( payload, request, cwd );
+			}
+
+			// The standard streams of the launcher are not used (they are shared by all threads).
+			for ( int i = 0; i < 3; ++i ) {
+				if ( 0 <= streams[i] ) close( streams[i] );
+			}
+
+			HostedInstance* instance = ( true == ok ) ? startHostedInstance( conn, request, cwd, backend_main ) : 0;
+			if ( 0 != instance ) {
+				instances.push_back( instance );
+			} else {
+				close( conn );
+			}
+
+			instance_strings.clear();
+			instance_argv.clear();
+			instance_env.clear();
+		}
+	}
+}
+
+
+bool
+BackEndZygote::isZygote( int argc, const char* argv[] )
+{
+	for ( int i = 1; i < argc; ++i ) {
+		if ( 0 == std::strncmp( argv[i], ZYGOTE_OPTION, std::strlen( ZYGOTE_OPTION ) ) ) return true;
+	}
+	return false;
+}
+
+
+bool
+BackEndZygote::run( int& argc, const char**& argv, BackEndMain backend_main )
+{
+	std::string path;
+	int idle_time = DEFAULT_IDLE_TIME;
+	bool shared = false;
+	for ( int i = 1; i < argc; ++i ) {
+		if ( 0 == std::strncmp( argv[i], ZYGOTE_OPTION, std::strlen( ZYGOTE_OPTION ) ) ) {
+			path = argv[i] + std::strlen( ZYGOTE_OPTION );
+		} else if ( 0 == std::strncmp( argv[i], IDLE_TIME_OPTION, std::strlen( IDLE_TIME_OPTION ) ) ) {
+			idle_time = std::atoi( argv[i] + std::strlen( IDLE_TIME_OPTION ) );
+		} else if ( 0 == std::strcmp( argv[i], SHARED_OPTION ) ) {
+			shared = true;
+		}
+	}
+
+	int listen_fd = listenOn( path );
+	if ( 0 > listen_fd ) return false;
+
+	if ( true == shared ) {
+		serveShared( listen_fd, idle_time, backend_main );
+		close( listen_fd );
+		unlink( path.c_str() );
+		return false;
+	}
+
+	// Monitor processes are reaped automatically.
+	signal( SIGCHLD, SIG_IGN );
+
+	while ( true )
+	{
+		pollfd pfd;
+		pfd.fd = listen_fd;
+		pfd.events = POLLIN;
+		int ready = poll( &pfd, 1, ( 0 < idle_time ) ? idle_time * 1000 : -1 );
+		if ( ( 0 > ready ) && ( EINTR == errno ) ) continue;
+		if ( 0 >= ready ) break; // Idle for too long (or error).
+
+		int conn = acceptFrom( listen_fd );
+		if ( 0 > conn ) continue;
+
+		Request request;
+		int streams[3] = { -1, -1, -1 };
+		std::vector<char> payload;
+		std::string cwd;
+
+		bool ok = receiveHeader( conn, request, streams );
+		if ( true == ok ) {
+			payload.resize( request.payload_size );
+			ok = readAll( conn, payload.data(), payload.size() ) && parsePayload( payload, request, cwd );
+		}
+
+		pid_t monitor = ( true == ok ) ? fork() : -1;
+
+		if ( 0 == monitor ) {
+			// Monitor process: fork the backend instance, report its process ID and exit status to the launcher
+			// (or kill the instance in case the launcher exits before).
+			close( listen_fd );
+			if ( 0 != pipe( child_exit_pipe ) ) _exit( 1 );
+			signal( SIGCHLD, notifyChildExit );
+
+			pid_t instance = fork();
+			if ( 0 == instance ) {
+				setUpInstance( conn, streams, cwd, request.launcher_pid );
+				argc = static_cast<int>( request.n_args );
+				argv = &instance_argv[0];
+				return true;
+			}
+
+			for ( int i = 0; i < 3; ++i ) close( streams[i] );
+
+			int32_t pid = static_cast<int32_t>( instance );
+			writeAll( conn, &pid, sizeof( pid ) );
+
+			int status = ( 0 < instance ) ? waitForInstance( instance, conn ) : 0;
+
+			int32_t result = static_cast<int32_t>( status );
+			writeAll( conn, &result, sizeof( result ) );
+			_exit( 0 );
+		}
+
+		// Zygote: clean up and wait for the next request.
+		for ( int i = 0; i < 3; ++i ) {
+			if ( 0 <= streams[i] ) close( streams[i] );
+		}
+		close( conn );
+
+		instance_strings.clear();
+		instance_argv.clear();
+		instance_env.clear();
+	}
+
+	close( listen_fd );
+	unlink( path.c_str() );
+	return false;
+}
+
+
+bool
+BackEndZygote::isSharedProcess()
+{
+	return shared_process;
+}
+
+
+std::recursive_mutex SharedProcessLock::mutex_;
+
+
+SharedProcessLock::SharedProcessLock()
+{
+	mutex_.lock();
+	pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, &cancel_state_ );
+}
+
+
+SharedProcessLock::~SharedProcessLock()
+{
+	pthread_setcancelstate( cancel_state_, 0 );
+	mutex_.unlock();
+}
+
+
+ThreadCancellation::ThreadCancellation( bool enabled )
+{
+	pthread_setcancelstate( ( true == enabled ) ? PTHREAD_CANCEL_ENABLE : PTHREAD_CANCEL_DISABLE, &cancel_state_ );
+}
+
+
+ThreadCancellation::~ThreadCancellation()
+{
+	pthread_setcancelstate( cancel_state_, 0 );
+}
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_BACKEND_ZYGOTE
+#define _NS3_FMU_BACKEND_ZYGOTE
+
+
+#include <stdint.h>
+#include <mutex>
+
+
+// Name of the environment variable that holds the process ID of the launcher, which a backend instance
+// uses instead of its own process ID to identify itself to the FMU frontend (see 'lib/backEndProcessId.cpp').
+#define NS3_FMU_BACKEND_PID_ENV "NS3_FMU_BACKEND_PID"
+
+
+// Pre-forked backend processes. Starting a backend executable is expensive, because all ns-3 libraries
+// have to be loaded and initialized (e.g., registration of all TypeIds). When started as zygote (command
+// line option '--zygote=<socket>'), the executable does this only once and then waits for requests from
+// the launcher (see 'lib/zygoteLauncher.cpp'), which the FMU frontend starts instead of the backend.
+// For every request, a new backend instance is forked, which takes over the launcher's command line
+// arguments, working directory, environment and standard streams. The instance is killed in case the
+// launcher exits before it. Only requests from launchers of the same user are served.
+//
+// The zygote exits after it has been idle for a while (command line option '--zygote-idle-time=<seconds>',
+// default 600 s, 0 means to keep it running forever).
+//
+// With command line option '--zygote-shared', the zygote does not fork but hosts all backend instances
+// itself, each one running in its own thread (with its own working directory). Since the ns-3 simulator
+// is a singleton, the instances run their simulations one at a time (see class 'SharedProcessLock').
+// The standard streams and the environment of the launcher are not taken over in this case. When the
+// launcher exits, the thread of the instance is cancelled, which only takes effect while the instance
+// waits for the FMU frontend (see class 'ThreadCancellation'). The backend is then destroyed while
+// holding the lock (see class 'LockedBackEnd').
+class BackEndZygote
+{
+public:
+
+	// Main function of a backend instance.
+	typedef int (*BackEndMain)( int argc, const char* argv[] );
+
+	// Header of a request sent by the launcher (followed by the payload, i.e., the working directory,
+	// the command line arguments and the environment variables as null-terminated strings). The
+	// launcher's standard streams are sent along with the header.
+	struct Request {
+		uint32_t magic;
+		int32_t launcher_pid;
+		uint32_t n_args;
+		uint32_t n_env;
+		uint32_t payload_size;
+	};
+
+	static const uint32_t REQUEST_MAGIC = 0x4e53335a; // "NS3Z"
+
+	// Check if the executable has been started as zygote.
+	static bool isZygote( int argc, const char* argv[] );
+
+	// Serve requests. Returns true in a newly forked backend instance, whose command line arguments
+	// are returned via argc/argv. Returns false in the zygote itself when it exits. Backend instances
+	// hosted by a shared process are run by calling function backend_main.
+	static bool run( int& argc, const char**& argv, BackEndMain backend_main );
+
+	// Check if the calling backend instance is hosted by a shared process.
+	static bool isSharedProcess();
+};
+
+
+// Backend instances hosted by the same process must not use the ns-3 simulator (or any other global
+// state of ns-3) at the same time. Hold this lock while doing so (the lock is recursive and cheap when
+// not contended, hence it is used regardless of whether the process is shared or not). A hosted backend
+// instance is never cancelled while it holds the lock.
+class SharedProcessLock
+{
+public:
+
+	SharedProcessLock();
+	~SharedProcessLock();
+
+private:
+
+	int cancel_state_;
+
+	static std::recursive_mutex mutex_;
+};
+
+
+// Enable or disable the cancellation of the calling thread within the scope of an instance of this class.
+// Hosted backend instances run with cancellation disabled, it is only enabled while waiting for the FMU
+// frontend (see macro 'CREATE_NS3_FMU_BACKEND'). Hence, the stack of a cancelled instance is always unwound
+// from there, and never from within a destructor (which would terminate the whole process).
+class ThreadCancellation
+{
+public:
+
+	explicit ThreadCancellation( bool enabled );
+	~ThreadCancellation();
+
+private:
+
+	int cancel_state_;
+};
+
+
+// Owner of a backend, which is constructed and destroyed while holding the 'SharedProcessLock' (also
+// when the stack is unwound because a hosted backend instance has been cancelled).
+template<typename T>
+class LockedBackEnd
+{
+public:
+
+	LockedBackEnd()
+	{
+		SharedProcessLock lock;
+		backend_ = new T;
+	}
+
+	~LockedBackEnd()
+	{
+		SharedProcessLock lock;
+		delete backend_;
+	}
+
+	T& get() { return *backend_; }
+
+private:
+
+	LockedBackEnd( const LockedBackEnd& );
+	LockedBackEnd& operator=( const LockedBackEnd& );
+
+	T* backend_;
+};
+
+
+#endif // _NS3_FMU_BACKEND_ZYGOTE
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+#include "checkpoint.h"
+
+
+namespace {
+
+	const char MAGIC[8] = { 'N', 'S', '3', 'F', 'M', 'U', 'C', 'P' };
+	const uint32_t VERSION = 2;
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+		uint64_t size; // Size of the serialized state.
+		uint64_t checksum; // FNV-1a hash of the serialized state.
+	};
+
+	uint64_t checksum( const char* data, size_t size )
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for ( size_t i = 0; i < size; ++i ) {
+			hash ^= static_cast<unsigned char>( data[i] );
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+}
+
+
+CheckpointWriter&
+CheckpointWriter::write( const std::string& val )
+{
+	write( static_cast<uint64_t>( val.size() ) );
+	buffer_.append( val );
+	return *this;
+}
+
+
+bool
+CheckpointWriter::save( const std::string& file_name ) const
+{
+	Header header;
+	std::memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+	header.version = VERSION;
+	header.reserved = 0;
+	header.size = buffer_.size();
+	header.checksum = checksum( buffer_.data(), buffer_.size() );
+
+	std::string tmp_file_name = file_name + ".tmp";
+	{
+		std::ofstream output( tmp_file_name.c_str(), std::ios::binary | std::ios::trunc );
+		output.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+		output.write( buffer_.data(), buffer_.size() );
+		output.close();
+
+		if ( false == output.good() ) {
+			std::remove( tmp_file_name.c_str() );
+			return false;
+		}
+	}
+
+	// Replace the previous checkpoint.
+	return ( 0 == std::rename( tmp_file_name.c_str(), file_name.c_str() ) );
+}
+
+
+bool
+CheckpointReader::load( const std::string& file_name )
+{
+	buffer_.clear();
+	pos_ = 0;
+	good_ = false;
+
+	std::ifstream input( file_name.c_str(), std::ios::binary );
+	if ( false == input.good() ) return false;
+
+	Header header;
+	if ( false == input.read( reinterpret_cast<char*>( &header ), sizeof( header ) ).good() ) return false;
+
+	if ( ( 0 != std::memcmp( header.magic, MAGIC, sizeof( MAGIC ) ) ) || ( VERSION != header.version ) ) return false;
+
+	buffer_.assign( std::istreambuf_iterator<char>( input ), std::istreambuf_iterator<char>() );
+
+	good_ = ( header.size == buffer_.size() ) && ( header.checksum == checksum( buffer_.data(), buffer_.size() ) );
+	return good_;
+}
+
+
+bool
+CheckpointReader::read( std::string& val )
+{
+	uint64_t size = 0;
+	if ( ( false == read( size ) ) || ( size > buffer_.size() - pos_ ) ) return good_ = false;
+
+	val.assign( buffer_.data() + pos_, size );
+	pos_ += size;
+	return true;
+}
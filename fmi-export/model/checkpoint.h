@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_CHECKPOINT
+#define _NS3_FMU_CHECKPOINT
+
+
+#include <string>
+#include <cstring>
+#include <type_traits>
+#include <stdint.h>
+
+
+// Compact binary checkpoints of a backend's state. The state is serialized into a memory buffer, which is
+// written to a temporary file that replaces the checkpoint file afterwards. Hence, a crash while writing
+// never leaves a corrupt checkpoint behind. Values are stored as raw bytes, i.e., checkpoints can only be
+// read on machines with the same architecture.
+class CheckpointWriter
+{
+public:
+
+	// Start a new checkpoint (the memory of the buffer is kept).
+	void clear() { buffer_.clear(); }
+
+	// Append a value (plain data types only, e.g., numbers).
+	template<typename T>
+	CheckpointWriter& write( const T& val )
+	{
+		static_assert( std::is_pod<T>::value, "only plain data types can be written to checkpoints" );
+		buffer_.append( reinterpret_cast<const char*>( &val ), sizeof( T ) );
+		return *this;
+	}
+
+	// Append a string (length and raw bytes).
+	CheckpointWriter& write( const std::string& val );
+
+	// Write the checkpoint to file. Returns false in case the file could not be written.
+	bool save( const std::string& file_name ) const;
+
+	size_t size() const { return buffer_.size(); }
+
+private:
+
+	std::string buffer_;
+};
+
+
+// Read a checkpoint written by class 'CheckpointWriter'.
+class CheckpointReader
+{
+public:
+
+	CheckpointReader() : pos_( 0 ), good_( false ) {}
+
+	// Load a checkpoint file. Returns false in case the file cannot be read or is corrupt.
+	bool load( const std::string& file_name );
+
+	// Read a value (in the same order as written). Returns false in case the checkpoint has no more
+	// data, all subsequent reads fail as well.
+	template<typename T>
+	bool read( T& val )
+	{
+		static_assert( std::is_pod<T>::value, "only plain data types can be read from checkpoints" );
+		if ( ( false == good_ ) || ( sizeof( T ) > buffer_.size() - pos_ ) ) return good_ = false;
+		std::memcpy( &val, buffer_.data() + pos_, sizeof( T ) );
+		pos_ += sizeof( T );
+		return true;
+	}
+
+	// Read a string.
+	bool read( std::string& val );
+
+	// Check if all reads have succeeded so far.
+	bool good() const { return good_; }
+
+private:
+
+	std::string buffer_;
+	size_t pos_;
+	bool good_;
+};
+
+
+#endif // _NS3_FMU_CHECKPOINT
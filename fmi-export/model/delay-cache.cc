@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include "delay-cache.h"
+
+
+DelayCacheKey&
+DelayCacheKey::add( const fmippInteger& val )
+{
+	bytes_.append( reinterpret_cast<const char*>( &val ), sizeof( val ) );
+	return *this;
+}
+
+
+DelayCacheKey&
+DelayCacheKey::add( const fmippReal& val )
+{
+	bytes_.append( reinterpret_cast<const char*>( &val ), sizeof( val ) );
+	return *this;
+}
+
+
+DelayCacheKey&
+DelayCacheKey::add( const fmippBoolean& val )
+{
+	bytes_.push_back( ( true == val ) ? 1 : 0 );
+	return *this;
+}
+
+
+DelayCacheKey&
+DelayCacheKey::add( const std::string& val )
+{
+	// Prepend the length, otherwise different sequences of strings could result in the same key.
+	uint32_t length = static_cast<uint32_t>( val.size() );
+	bytes_.append( reinterpret_cast<const char*>( &length ), sizeof( length ) );
+	bytes_.append( val );
+	return *this;
+}
+
+
+DelayCache::DelayCache() : file_( 0 ) {}
+
+
+DelayCache::~DelayCache()
+{
+	if ( 0 != file_ ) delete file_;
+}
+
+
+// Each entry of the file consists of the length of the key (32 bit), the key
+// itself and the delay (64 bit). Incomplete entries at the end are ignored.
+bool
+DelayCache::open( const std::string& file_name )
+{
+	std::ifstream input( file_name.c_str(), std::ios::binary );
+	if ( true == input.good() )
+	{
+		uint32_t length;
+		std::string key;
+		int64_t delay;
+
+		while ( input.read( reinterpret_cast<char*>( &length ), sizeof( length ) ) )
+		{
+			key.resize( length );
+			if ( 0 < length && !input.read( &key[0], length ) ) break;
+			if ( !input.read( reinterpret_cast<char*>( &delay ), sizeof( delay ) ) ) break;
+			delays_[key] = delay;
+		}
+	}
+
+	if ( 0 != file_ ) delete file_;
+	file_ = new std::ofstream( file_name.c_str(), std::ios::binary | std::ios::app );
+
+	return file_->good();
+}
+
+
+bool
+DelayCache::lookup( const DelayCacheKey& key, int64_t& delay ) const
+{
+	std::unordered_map<std::string, int64_t>::const_iterator it = delays_.find( key.bytes() );
+	if ( delays_.end() == it ) return false;
+
+	delay = it->second;
+	return true;
+}
+
+
+void
+DelayCache::insert( const DelayCacheKey& key, const int64_t& delay )
+{
+	delays_[key.bytes()] = delay;
+
+	if ( 0 != file_ )
+	{
+		uint32_t length = static_cast<uint32_t>( key.bytes().size() );
+		file_->write( reinterpret_cast<const char*>( &length ), sizeof( length ) );
+		file_->write( key.bytes().data(), length );
+		file_->write( reinterpret_cast<const char*>( &delay ), sizeof( delay ) );
+		file_->flush();
+	}
+}
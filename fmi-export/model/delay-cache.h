@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_DELAY_CACHE
+#define _NS3_FMU_DELAY_CACHE
+
+
+#include <string>
+#include <fstream>
+#include <unordered_map>
+#include <stdint.h>
+
+
+// FMI++ includes.
+#include "export/include/BackEndApplicationBase.h"
+
+
+// Key for the delay cache. A key is composed of all inputs that determine the outcome of a
+// simulation (e.g., sender, receiver, packet size, parameters). Components are appended as
+// raw bytes, hence keys can be compared exactly and written to file.
+class DelayCacheKey
+{
+public:
+
+	DelayCacheKey& add( const fmippInteger& val );
+	DelayCacheKey& add( const fmippReal& val );
+	DelayCacheKey& add( const fmippBoolean& val );
+	DelayCacheKey& add( const std::string& val );
+	DelayCacheKey& add( const char* val ) { return add( std::string( val ) ); }
+
+	const std::string& bytes() const { return bytes_; }
+
+private:
+
+	std::string bytes_;
+};
+
+
+// Cache for message delays of deterministic simulations. The cache is kept in memory and can
+// optionally be backed by a file. Entries of an existing file are loaded when the file is opened,
+// new entries are appended to the file.
+class DelayCache
+{
+public:
+
+	DelayCache();
+	~DelayCache();
+
+	// Open a cache file (created if it does not exist). Returns false in case the file could not be opened.
+	bool open( const std::string& file_name );
+
+	// Look up the delay for a key (in nanoseconds). Returns false in case there is no entry.
+	bool lookup( const DelayCacheKey& key, int64_t& delay ) const;
+
+	// Add the delay for a key (in nanoseconds).
+	void insert( const DelayCacheKey& key, const int64_t& delay );
+
+	size_t size() const { return delays_.size(); }
+
+private:
+
+	// The cache is not copyable.
+	DelayCache( const DelayCache& );
+	DelayCache& operator=( const DelayCache& );
+
+	std::unordered_map<std::string, int64_t> delays_;
+
+	// Output file stream for appending new entries (0 if no file is used).
+	std::ofstream* file_;
+};
+
+
+#endif // _NS3_FMU_DELAY_CACHE
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_DELAY_STATISTICS
+#define _NS3_FMU_DELAY_STATISTICS
+
+
+// FMI++ includes.
+#include "export/include/BackEndApplicationBase.h"
+
+
+// Summary of the end-to-end delays of a flow (or a set of flows), which can be published as FMI
+// real outputs. Delays are given in seconds, counts as number of packets.
+struct DelayStatistics
+{
+	DelayStatistics() :
+		count( 0. ), lost( 0. ), min( 0. ), mean( 0. ), p50( 0. ), p99( 0. ), max( 0. ) {}
+
+	// Set all statistics from a delay histogram (e.g., class DelayHistogram in module fmu-examples),
+	// which has to provide GetCount(), GetMin(), GetMean(), GetPercentile(q) and GetMax().
+	template<typename Histogram>
+	void update( const Histogram& delays, unsigned int n_lost )
+	{
+		count = delays.GetCount();
+		lost = n_lost;
+		min = delays.GetMin().GetSeconds();
+		mean = delays.GetMean().GetSeconds();
+		p50 = delays.GetPercentile( 0.5 ).GetSeconds();
+		p99 = delays.GetPercentile( 0.99 ).GetSeconds();
+		max = delays.GetMax().GetSeconds();
+	}
+
+	// Set all statistics to zero.
+	void reset() { *this = DelayStatistics(); }
+
+	fmippReal count; // Number of received packets.
+	fmippReal lost; // Number of lost packets.
+	fmippReal min; // Minimum delay.
+	fmippReal mean; // Mean delay.
+	fmippReal p50; // Median delay.
+	fmippReal p99; // 99th percentile of the delay.
+	fmippReal max; // Maximum delay.
+};
+
+
+// Define all members of a delay statistics variable as FMI real outputs (call from 'initializeSimulation').
+// The names of the outputs are derived from the name of the variable, e.g., 'stats.mean' and 'stats.p99'.
+#define addDelayStatisticsOutputs( stats ) { \
+	addRealOutput( stats.count ); \
+	addRealOutput( stats.lost ); \
+	addRealOutput( stats.min ); \
+	addRealOutput( stats.mean ); \
+	addRealOutput( stats.p50 ); \
+	addRealOutput( stats.p99 ); \
+	addRealOutput( stats.max ); \
+	}
+
+
+#endif // _NS3_FMU_DELAY_STATISTICS
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include <chrono>
+#include <algorithm>
+
+#include "event-trace.h"
+
+
+namespace {
+
+	// File header: magic string, format version and record size.
+	const char TRACE_MAGIC[8] = { 'N', 'S', '3', 'T', 'R', 'A', 'C', 'E' };
+	const uint32_t TRACE_VERSION = 1;
+
+	// Time the background thread sleeps when the buffer is empty.
+	const std::chrono::milliseconds TRACE_POLL_INTERVAL( 1 );
+}
+
+
+EventTrace::EventTrace() :
+	buffer_( CAPACITY ), head_( 0 ), tail_( 0 ), dropped_( 0 ), reported_dropped_( 0 ), running_( false ), file_( 0 )
+{}
+
+
+EventTrace::~EventTrace()
+{
+	close();
+}
+
+
+bool
+EventTrace::open( const std::string& file_name, bool append )
+{
+	close();
+
+	file_ = std::fopen( file_name.c_str(), ( true == append ) ? "ab" : "wb" );
+	if ( 0 == file_ ) return false;
+
+	// Write the file header (unless appending to an existing trace).
+	std::fseek( file_, 0, SEEK_END );
+	if ( 0 == std::ftell( file_ ) ) {
+		uint32_t record_size = sizeof( EventTraceRecord );
+		std::fwrite( TRACE_MAGIC, sizeof( TRACE_MAGIC ), 1, file_ );
+		std::fwrite( &TRACE_VERSION, sizeof( TRACE_VERSION ), 1, file_ );
+		std::fwrite( &record_size, sizeof( record_size ), 1, file_ );
+	}
+
+	running_.store( true );
+	thread_ = std::thread( &EventTrace::run, this );
+
+	return true;
+}
+
+
+void
+EventTrace::close()
+{
+	if ( true == thread_.joinable() ) {
+		running_.store( false );
+		thread_.join();
+	}
+
+	if ( 0 != file_ ) {
+		drain();
+		std::fclose( file_ );
+		file_ = 0;
+	}
+}
+
+
+void
+EventTrace::run()
+{
+	while ( true == running_.load() ) {
+		if ( 0 == drain() ) std::this_thread::sleep_for( TRACE_POLL_INTERVAL );
+	}
+}
+
+
+uint64_t
+EventTrace::drain()
+{
+	uint64_t tail = tail_.load( std::memory_order_relaxed );
+	uint64_t head = head_.load( std::memory_order_acquire );
+	uint64_t n = head - tail;
+
+	// Write the records in at most two chunks (the buffer may wrap around).
+	while ( tail != head ) {
+		uint64_t begin = tail & ( CAPACITY - 1 );
+		uint64_t count = std::min( head - tail, CAPACITY - begin );
+		std::fwrite( &buffer_[begin], sizeof( EventTraceRecord ), count, file_ );
+		tail += count;
+		tail_.store( tail, std::memory_order_release );
+	}
+
+	// Report dropped records.
+	uint64_t dropped = dropped_.load( std::memory_order_relaxed );
+	if ( dropped != reported_dropped_ ) {
+		EventTraceRecord record = { TRACE_RECORDS_DROPPED, 0, 0, static_cast<int64_t>( dropped - reported_dropped_ ) };
+		std::fwrite( &record, sizeof( record ), 1, file_ );
+		reported_dropped_ = dropped;
+	}
+
+	if ( 0 != n ) std::fflush( file_ );
+
+	return n;
+}
@@ -0,0 +1,143 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_EVENT_TRACE
+#define _NS3_FMU_EVENT_TRACE
+
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <stdint.h>
+
+
+// Types of trace records. The numbers are part of the file format (see script 'ns3_trace_decode.py'),
+// new types must only be appended.
+enum EventTraceType {
+	TRACE_DOSTEP = 1, // time: synchronization time
+	TRACE_COINCIDES_WITH_EVENT = 2, // time: event time
+	TRACE_NEXT_DEFAULT_EVENT = 3, // time: next default event
+	TRACE_DELIVER_MESSAGE = 4, // msg_id: delivered message
+	TRACE_POSTPONE_MESSAGE = 5, // msg_id: postponed message
+	TRACE_NEXT_EVENT_TIME = 6, // time: next event time
+	TRACE_ADD_EVENT = 7, // time: receive time, msg_id: message
+	TRACE_SET_NEXT_EVENT = 8, // time: next event time
+	TRACE_ADD_EVENTS = 9, // value: number of new events
+	TRACE_LOST_MESSAGE = 10, // msg_id: lost message
+	TRACE_DELAY_CACHE_LOADED = 11, // value: number of cached delays
+	TRACE_SURROGATE_TABLE = 12, // value: 1 if the table is used, 0 if not available
+	TRACE_WORKER_START_FAILED = 13,
+	TRACE_WORKER_FAILED = 14, // value: index of the message group
+	TRACE_SIMULATION_AHEAD = 15, // time: ns-3 simulation time, value: synchronization time
+	TRACE_MESSAGES_IN_FLIGHT = 16, // value: number of messages in flight
+	TRACE_MESSAGES_NOT_RECEIVED = 17, // value: number of messages not received
+	TRACE_RECORDS_DROPPED = 18, // value: number of records dropped because the buffer was full
+	TRACE_EARLY_RETURN = 19, // time: time reached (next event time), value: requested synchronization time
+	TRACE_STATE_SAVED = 20, // value: ID of the snapshot (0 if saving failed)
+	TRACE_STATE_RESTORED = 21, // value: ID of the snapshot
+	TRACE_STATE_RESTORE_FAILED = 22, // value: ID of the snapshot
+	TRACE_STATE_RELEASED = 23, // value: ID of the snapshot
+	TRACE_STATE_RELEASE_FAILED = 24, // value: ID of the snapshot
+	TRACE_CHECKPOINT_WRITTEN = 25, // time: time of the checkpoint, value: size in bytes (0 if writing failed)
+	TRACE_CHECKPOINT_RESUMED = 26, // time: time of the checkpoint
+	TRACE_CHECKPOINT_INVALID = 27
+};
+
+
+// Fixed-size binary trace record (all times in nanoseconds).
+struct EventTraceRecord
+{
+	uint32_t type;
+	int32_t msg_id;
+	int64_t time;
+	int64_t value;
+};
+
+
+// Trace for debugging the event handling of the FMU backend. Records are written to a lock-free
+// ring buffer (single producer, single consumer), a background thread writes them to a binary file.
+// Writing a record never blocks and never formats text, in case the buffer is full the record is
+// dropped (the number of dropped records is written to the file). Use script 'ns3_trace_decode.py'
+// to turn the file into text.
+class EventTrace
+{
+public:
+
+	EventTrace();
+	~EventTrace();
+
+	// Open the trace file and start the background thread. In append mode, the records are appended
+	// to an existing trace file (e.g., after the backend process has been forked).
+	bool open( const std::string& file_name, bool append = false );
+
+	// Write all remaining records, stop the background thread and close the file.
+	void close();
+
+	// Append a record (to be called from a single thread only).
+	void write( EventTraceType type, int64_t time, int32_t msg_id = 0, int64_t value = 0 )
+	{
+		uint64_t head = head_.load( std::memory_order_relaxed );
+		if ( head - tail_.load( std::memory_order_acquire ) >= CAPACITY ) {
+			dropped_.fetch_add( 1, std::memory_order_relaxed );
+			return;
+		}
+
+		EventTraceRecord& record = buffer_[head & ( CAPACITY - 1 )];
+		record.type = type;
+		record.msg_id = msg_id;
+		record.time = time;
+		record.value = value;
+
+		head_.store( head + 1, std::memory_order_release );
+	}
+
+private:
+
+	EventTrace( const EventTrace& );
+	EventTrace& operator=( const EventTrace& );
+
+	// Capacity of the ring buffer (number of records, power of two).
+	static const uint64_t CAPACITY = 1 << 14;
+
+	// Main loop of the background thread.
+	void run();
+
+	// Write all records currently in the buffer to the file, returns the number of written records.
+	uint64_t drain();
+
+	std::vector<EventTraceRecord> buffer_;
+
+	// Positions of the producer and the consumer (padded, so they do not share a cache line).
+	std::atomic<uint64_t> head_;
+	char head_padding_[64];
+	std::atomic<uint64_t> tail_;
+	char tail_padding_[64];
+
+	std::atomic<uint64_t> dropped_;
+	uint64_t reported_dropped_;
+
+	std::atomic<bool> running_;
+	std::thread thread_;
+	std::FILE* file_;
+};
+
+
+#endif // _NS3_FMU_EVENT_TRACE
@@ -6,12 +6,24 @@
 namespace ns3 {
 
 
+// Define the main function of the backend executable and the entry point for loading the
+// scenario as shared library in-process (see 'in-process-api.h'). When started as zygote, the
+// backend instances are forked from the main function or run in threads (see 'backend-zygote.h').
+// Threads of hosted backend instances can only be cancelled while waiting for the FMU frontend.
 #define CREATE_NS3_FMU_BACKEND( BACKENDTYPE ) \
+static int ns3_fmu_backend_main( int argc, const char* argv[] ) { \
+	LockedBackEnd<BACKENDTYPE> locked_backend; \
+	BACKENDTYPE& backend = locked_backend.get(); \
+	if ( true == SimpleEventQueueFMUBase::isVariableNamesExport( argc, argv ) ) { return backend.writeVariableNames( argc, argv ); } \
+	if ( true == SimpleEventQueueFMUBase::isSurrogateTableGeneration( argc, argv ) ) { return backend.generateSurrogateTable( argc, argv ); } \
+	{ ThreadCancellation cancellation_point( true ); if ( 0 != backend.initializeBase( argc, argv ) ) { return -1; } } \
+	while ( true == backend.readyToLoop() ) { ThreadCancellation cancellation_point( true ); if ( 0 != backend.doStepBase() ) return -1; } \
+	return 0; } \
 int main( int argc, const char* argv[] ) { \
-	BACKENDTYPE backend; \
-	if ( 0 != backend.initializeBase( argc, argv ) ) { return -1; } \
-	while ( true == backend.readyToLoop() ) { if ( 0 != backend.doStepBase() ) return -1; } \
-	return 0; }
+	if ( ( true == BackEndZygote::isZygote( argc, argv ) ) && ( false == BackEndZygote::run( argc, argv, ns3_fmu_backend_main ) ) ) { return 0; } \
+	return ns3_fmu_backend_main( argc, argv ); } \
+extern "C" void* ns3_fmu_create_backend() { \
+	return static_cast<SimpleEventQueueFMUBase*>( new BACKENDTYPE ); }
 
 
 }
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include <algorithm>
+
+#include "fmu-event-queue.h"
+
+
+using namespace Ns3FMUBackendEventQueue;
+
+
+EventPool::EventPool() {}
+
+
+EventPool::~EventPool()
+{
+	std::vector<Event*>::iterator it = blocks_.begin();
+	std::vector<Event*>::iterator end = blocks_.end();
+	for ( ; it != end; ++it ) delete [] *it;
+}
+
+
+Event*
+EventPool::acquire( TimeStamp t )
+{
+	if ( true == free_.empty() ) grow();
+
+	Event* evt = free_.back();
+	free_.pop_back();
+
+	evt->time_stamp = t;
+	return evt;
+}
+
+
+void
+EventPool::release( Event* evt )
+{
+	evt->deliveries.clear();
+	free_.push_back( evt );
+}
+
+
+void
+EventPool::grow()
+{
+	Event* block = new Event[BLOCK_SIZE];
+	blocks_.push_back( block );
+
+	free_.reserve( capacity() );
+	for ( size_t i = BLOCK_SIZE; i > 0; --i ) free_.push_back( block + i - 1 );
+}
+
+
+EventQueue::EventQueue() : n_deliveries_( 0 ) {}
+
+
+EventQueue::~EventQueue()
+{
+	// All events belong to the pool, which frees them.
+	heap_.clear();
+	index_.clear();
+}
+
+
+void
+EventQueue::insert( TimeStamp t, MessageID m, Receiver r )
+{
+	bool created;
+	Event* evt = bucket( t, created );
+	evt->deliveries.push_back( Delivery( m, r ) );
+	++n_deliveries_;
+
+	if ( true == created ) std::push_heap( heap_.begin(), heap_.end(), EventOrder() );
+}
+
+
+void
+EventQueue::insert( const std::vector<Message>& messages )
+{
+	size_t old_size = heap_.size();
+
+	bool created;
+	std::vector<Message>::const_iterator it = messages.begin();
+	std::vector<Message>::const_iterator end = messages.end();
+	for ( ; it != end; ++it ) {
+		Event* evt = bucket( it->time_stamp, created );
+		evt->deliveries.push_back( Delivery( it->msg_id, it->receiver ) );
+	}
+
+	n_deliveries_ += messages.size();
+
+	size_t new_events = heap_.size() - old_size;
+	if ( new_events > old_size / 2 ) {
+		// Many new events compared to the current queue size: rebuild the heap in linear time.
+		std::make_heap( heap_.begin(), heap_.end(), EventOrder() );
+	} else {
+		// Only a few new events: sift them up one by one.
+		for ( size_t i = old_size + 1; i <= heap_.size(); ++i )
+			std::push_heap( heap_.begin(), heap_.begin() + i, EventOrder() );
+	}
+}
+
+
+void
+EventQueue::pop()
+{
+	index_.erase( heap_.front()->time_stamp );
+	n_deliveries_ -= heap_.front()->deliveries.size();
+
+	std::pop_heap( heap_.begin(), heap_.end(), EventOrder() );
+	pool_.release( heap_.back() );
+	heap_.pop_back();
+}
+
+
+// The n earliest events are retrieved without modifying the heap: starting from the root,
+// candidates are kept in a small heap of their own (ordered by timestamp). Whenever the
+// earliest candidate is taken, its children in the event heap become new candidates.
+void
+EventQueue::peek( size_t n, std::vector<const Event*>& events ) const
+{
+	events.clear();
+	if ( true == heap_.empty() ) return;
+
+	struct CandidateOrder {
+		const std::vector<Event*>& heap;
+		CandidateOrder( const std::vector<Event*>& h ) : heap( h ) {}
+		bool operator() ( size_t i1, size_t i2 ) const { return heap[i1]->time_stamp > heap[i2]->time_stamp; }
+	} order( heap_ );
+
+	candidates_.clear();
+	candidates_.push_back( 0 );
+
+	while ( ( events.size() < n ) && ( false == candidates_.empty() ) )
+	{
+		std::pop_heap( candidates_.begin(), candidates_.end(), order );
+		size_t i = candidates_.back();
+		candidates_.pop_back();
+
+		events.push_back( heap_[i] );
+
+		for ( size_t child = 2*i + 1; ( child <= 2*i + 2 ) && ( child < heap_.size() ); ++child ) {
+			candidates_.push_back( child );
+			std::push_heap( candidates_.begin(), candidates_.end(), order );
+		}
+	}
+}
+
+
+Event*
+EventQueue::bucket( TimeStamp t, bool& created )
+{
+	std::unordered_map<TimeStamp, Event*>::iterator it = index_.find( t );
+	if ( it != index_.end() ) {
+		created = false;
+		return it->second;
+	}
+
+	Event* evt = pool_.acquire( t );
+	heap_.push_back( evt );
+	index_[t] = evt;
+
+	created = true;
+	return evt;
+}
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_EVENT_QUEUE
+#define _NS3_FMU_EVENT_QUEUE
+
+
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <stdint.h>
+
+
+// FMI++ includes.
+#include "export/include/BackEndApplicationBase.h"
+
+
+namespace Ns3FMUBackendEventQueue
+{
+	// Internally, time is represented as integer number of ticks (nanoseconds), which is the
+	// same as ns-3's default time resolution. Conversions from/to floating point numbers
+	// (seconds) are only done at the FMI interface.
+	typedef int64_t TimeStamp;
+	typedef fmippInteger MessageID;
+	typedef fmippInteger* Receiver;
+
+	// Number of ticks per second.
+	const TimeStamp TICKS_PER_SECOND = 1000000000;
+
+	// Timestamp representing an infinitely distant point in time.
+	const TimeStamp TIME_STAMP_MAX = std::numeric_limits<TimeStamp>::max();
+
+	// Convert a time in seconds to a timestamp (rounded to the nearest tick).
+	inline TimeStamp toTimeStamp( const fmippReal& t ) {
+		if ( t >= static_cast<fmippReal>( TIME_STAMP_MAX / TICKS_PER_SECOND ) ) return TIME_STAMP_MAX;
+		return static_cast<TimeStamp>( std::llround( t * TICKS_PER_SECOND ) );
+	}
+
+	// Convert a timestamp to a time in seconds.
+	inline fmippReal toSeconds( const TimeStamp& t ) {
+		if ( TIME_STAMP_MAX == t ) return std::numeric_limits<fmippReal>::max();
+		return static_cast<fmippReal>( t / TICKS_PER_SECOND ) + static_cast<fmippReal>( t % TICKS_PER_SECOND ) / TICKS_PER_SECOND;
+	}
+
+	// Add two timestamps (saturates at TIME_STAMP_MAX instead of overflowing).
+	inline TimeStamp addTimeStamps( const TimeStamp& t1, const TimeStamp& t2 ) {
+		return ( t2 > 0 && t1 > TIME_STAMP_MAX - t2 ) ? TIME_STAMP_MAX : t1 + t2;
+	}
+
+	// A message delivery, i.e., a message ID and the output variable it is associated to.
+	struct Delivery {
+
+		MessageID msg_id; // Message ID (can be 0).
+		Receiver receiver; // Output variable associated to the message (can be 0).
+
+		// Struct constructor.
+		Delivery( MessageID m, Receiver r ) : msg_id( m ), receiver( r ) {}
+	};
+
+	// A group of messages that can be simulated independently of other messages.
+	typedef std::vector<Delivery> MessageGroup;
+
+	// An event is a bucket holding all messages delivered at a certain point in time.
+	// Default events are not stored in the queue, they are generated by class DefaultEventTimer.
+	struct Event {
+
+		TimeStamp time_stamp; // Each event is associated with a timestamp.
+		std::vector<Delivery> deliveries; // All messages delivered at this point in time.
+
+		// Struct constructor.
+		Event() : time_stamp( 0 ) {}
+	};
+
+	// A message that has to be delivered to a receiver at a given time (used for inserting many events at once).
+	struct Message {
+
+		TimeStamp time_stamp; // Time at which the message is received.
+		MessageID msg_id; // Message ID.
+		Receiver receiver; // Output variable associated to the message.
+
+		// Struct constructor.
+		Message( TimeStamp t, MessageID m, Receiver r ) : time_stamp( t ), msg_id( m ), receiver( r ) {}
+	};
+
+	// This functor defines the order of events in the event queue. The queue
+	// is a heap that keeps the event with the earliest timestamp on top.
+	struct EventOrder {
+		bool operator() ( const Event* e1, const Event* e2 ) const {
+			return e1->time_stamp > e2->time_stamp;
+		}
+	};
+
+
+	// Pool of pre-allocated events. Events are allocated in blocks and recycled
+	// via a free list, hence the memory footprint only depends on the maximum
+	// number of events that are pending at the same time.
+	class EventPool
+	{
+	public:
+
+		EventPool();
+		~EventPool();
+
+		// Get an empty event from the pool (allocates a new block if the pool is exhausted).
+		Event* acquire( TimeStamp t );
+
+		// Return an event to the pool. Recycled events keep the memory allocated for their deliveries.
+		void release( Event* evt );
+
+		// Total number of events allocated by the pool.
+		size_t capacity() const { return blocks_.size() * BLOCK_SIZE; }
+
+	private:
+
+		// Number of events allocated at once.
+		static const size_t BLOCK_SIZE = 256;
+
+		// Allocate a new block of events and add them to the free list.
+		void grow();
+
+		// The pool is not copyable.
+		EventPool( const EventPool& );
+		EventPool& operator=( const EventPool& );
+
+		std::vector<Event*> blocks_;
+		std::vector<Event*> free_;
+	};
+
+
+	// This is the definition of the event queue: a binary heap of events taken
+	// from an event pool. There is at most one event per timestamp, which holds
+	// all messages delivered at that time. Consumed events are returned to the pool.
+	class EventQueue
+	{
+	public:
+
+		EventQueue();
+		~EventQueue();
+
+		// Add a message delivery to the event at the given time.
+		void insert( TimeStamp t, MessageID m, Receiver r );
+
+		// Add many message deliveries at once.
+		void insert( const std::vector<Message>& messages );
+
+		// Access the earliest event in the queue (the queue must not be empty).
+		const Event* top() const { return heap_.front(); }
+
+		// Remove the earliest event from the queue and recycle it.
+		void pop();
+
+		// Retrieve (up to) the n earliest events in the queue, sorted by their timestamps.
+		void peek( size_t n, std::vector<const Event*>& events ) const;
+
+		bool empty() const { return heap_.empty(); }
+		size_t size() const { return heap_.size(); }
+
+		// Total number of message deliveries in the queue.
+		size_t deliveries() const { return n_deliveries_; }
+
+	private:
+
+		// Retrieve the event for the given time. If there is no such event yet, a new
+		// one is created and appended to the heap (without restoring the heap property).
+		Event* bucket( TimeStamp t, bool& created );
+
+		// The queue is not copyable.
+		EventQueue( const EventQueue& );
+		EventQueue& operator=( const EventQueue& );
+
+		EventPool pool_;
+		std::vector<Event*> heap_;
+
+		// Index of all events in the heap according to their timestamps.
+		std::unordered_map<TimeStamp, Event*> index_;
+
+		// Total number of message deliveries in the queue.
+		size_t n_deliveries_;
+
+		// Auxiliary container for peeking into the heap (kept as member to avoid reallocations).
+		mutable std::vector<size_t> candidates_;
+	};
+
+
+	// The FMU schedules 'default events' at regular time intervals. Instead of inserting
+	// them into the event queue, the next default event is computed arithmetically (like
+	// a virtual timer) and merged with the event queue when the next event time is retrieved.
+	class DefaultEventTimer
+	{
+	public:
+
+		DefaultEventTimer() : next_( TIME_STAMP_MAX ), step_( TIME_STAMP_MAX ) {}
+
+		// Start the timer: the first default event is at the given time. A step size of
+		// TIME_STAMP_MAX (or a step size that is not positive) means that only the first
+		// default event is generated.
+		void start( TimeStamp t, TimeStamp step ) { next_ = t; step_ = ( 0 < step ) ? step : TIME_STAMP_MAX; }
+
+		// Time of the next default event (TIME_STAMP_MAX if there is none).
+		TimeStamp next() const { return next_; }
+
+		// Step size between default events.
+		TimeStamp step() const { return step_; }
+
+		// Advance the timer past the given time (call this when a default event has been processed).
+		void advance( TimeStamp t ) {
+			if ( t < next_ ) return;
+			if ( ( TIME_STAMP_MAX == step_ ) || ( 0 >= step_ ) ) { next_ = TIME_STAMP_MAX; return; }
+			TimeStamp n = ( t - next_ ) / step_ + 1; // Number of steps to skip.
+			next_ = ( n > ( TIME_STAMP_MAX - next_ ) / step_ ) ? TIME_STAMP_MAX : next_ + n * step_;
+		}
+
+	private:
+
+		TimeStamp next_;
+		TimeStamp step_;
+	};
+}
+
+
+#endif // _NS3_FMU_EVENT_QUEUE
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_IN_PROCESS_API
+#define _NS3_FMU_IN_PROCESS_API
+
+
+#include <stddef.h>
+
+
+// Plain C interface between an FMU DLL and an ns-3 scenario that has been compiled as shared library
+// (in-process mode). The FMU DLL loads the scenario library and retrieves these functions by name,
+// hence the FMU DLL does not depend on ns-3 (or on the compiler used for ns-3).
+//
+// The scenario library provides function 'ns3_fmu_create_backend' (defined by macro
+// 'CREATE_NS3_FMU_BACKEND'), all other functions are provided by the fmi-export module.
+// Unless stated otherwise, functions return 0 on success.
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+// Types of scalar variables.
+#define NS3_FMU_REAL 0
+#define NS3_FMU_INTEGER 1
+#define NS3_FMU_BOOLEAN 2
+#define NS3_FMU_STRING 3
+
+// Return value of 'ns3_fmu_do_step' in case the step has returned early (at the time of an event).
+#define NS3_FMU_DISCARD 2
+
+// Create a new instance of the scenario's backend (to be passed to 'ns3_fmu_instantiate').
+typedef void* (*ns3_fmu_create_backend_t)();
+
+// Instantiate the FMU, i.e., define all inputs, outputs and parameters of the backend.
+typedef void* (*ns3_fmu_instantiate_t)( void* backend, int logging_on );
+
+// Look up a scalar variable by name, returns its index (or -1 if the variable does not exist).
+typedef int (*ns3_fmu_lookup_t)( void* instance, const char* name, int* type );
+
+// Set and get the values of scalar variables (referenced by index).
+typedef int (*ns3_fmu_set_real_t)( void* instance, int index, double value );
+typedef int (*ns3_fmu_get_real_t)( void* instance, int index, double* value );
+typedef int (*ns3_fmu_set_integer_t)( void* instance, int index, int value );
+typedef int (*ns3_fmu_get_integer_t)( void* instance, int index, int* value );
+typedef int (*ns3_fmu_set_boolean_t)( void* instance, int index, int value );
+typedef int (*ns3_fmu_get_boolean_t)( void* instance, int index, int* value );
+typedef int (*ns3_fmu_set_string_t)( void* instance, int index, const char* value );
+typedef int (*ns3_fmu_get_string_t)( void* instance, int index, const char** value ); // Valid until the variable changes.
+
+// Set and get string variables as raw bytes, which may contain null characters (e.g., binary payloads).
+typedef int (*ns3_fmu_set_binary_t)( void* instance, int index, const unsigned char* value, size_t size );
+typedef int (*ns3_fmu_get_binary_t)( void* instance, int index, const unsigned char** value, size_t* size ); // Valid until the variable changes.
+
+// Switch logging (i.e., the debug trace of the backend) on or off.
+typedef int (*ns3_fmu_set_logging_t)( void* instance, int logging_on );
+
+// Initialize the backend (after the parameters have been set).
+typedef int (*ns3_fmu_initialize_t)( void* instance, double start_time, double stop_time, int stop_time_defined );
+
+// Advance the backend from the communication point by the step size (0 for an FMU iteration). The time
+// reached is returned via end_time, which is before the end of the step in case of NS3_FMU_DISCARD.
+typedef int (*ns3_fmu_do_step_t)( void* instance, double com_point, double step_size, double* end_time );
+
+// Delete the instance (including the backend).
+typedef void (*ns3_fmu_free_t)( void* instance );
+
+
+void* ns3_fmu_instantiate( void* backend, int logging_on );
+int ns3_fmu_lookup( void* instance, const char* name, int* type );
+int ns3_fmu_set_real( void* instance, int index, double value );
+int ns3_fmu_get_real( void* instance, int index, double* value );
+int ns3_fmu_set_integer( void* instance, int index, int value );
+int ns3_fmu_get_integer( void* instance, int index, int* value );
+int ns3_fmu_set_boolean( void* instance, int index, int value );
+int ns3_fmu_get_boolean( void* instance, int index, int* value );
+int ns3_fmu_set_string( void* instance, int index, const char* value );
+int ns3_fmu_get_string( void* instance, int index, const char** value );
+int ns3_fmu_set_binary( void* instance, int index, const unsigned char* value, size_t size );
+int ns3_fmu_get_binary( void* instance, int index, const unsigned char** value, size_t* size );
+int ns3_fmu_set_logging( void* instance, int logging_on );
+int ns3_fmu_initialize( void* instance, double start_time, double stop_time, int stop_time_defined );
+int ns3_fmu_do_step( void* instance, double com_point, double step_size, double* end_time );
+void ns3_fmu_free( void* instance );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // _NS3_FMU_IN_PROCESS_API
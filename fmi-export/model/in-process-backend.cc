@@ -0,0 +1,284 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include "in-process-backend.h"
+
+
+InProcessBackEnd::InProcessBackEnd( SimpleEventQueueFMUBase* backend, bool logging_on ) :
+	backend_( backend ),
+	initialized_( false )
+{
+	settings_.start_time = 0.;
+	settings_.stop_time = 0.;
+	settings_.stop_time_defined = false;
+	settings_.logging_on = logging_on;
+
+	backend_->in_process_ = &settings_;
+
+	// Define inputs/outputs/parameters.
+	backend_->initializeScalarVariables();
+
+	addVariables( backend_->realParameterNames_, backend_->realParameters_, NS3_FMU_REAL );
+	addVariables( backend_->integerParameterNames_, backend_->integerParameters_, NS3_FMU_INTEGER );
+	addVariables( backend_->booleanParameterNames_, backend_->booleanParameters_, NS3_FMU_BOOLEAN );
+	addVariables( backend_->stringParameterNames_, backend_->stringParameters_, NS3_FMU_STRING );
+	addVariables( backend_->realInputNames_, backend_->realInputs_, NS3_FMU_REAL );
+	addVariables( backend_->integerInputNames_, backend_->integerInputs_, NS3_FMU_INTEGER );
+	addVariables( backend_->booleanInputNames_, backend_->booleanInputs_, NS3_FMU_BOOLEAN );
+	addVariables( backend_->stringInputNames_, backend_->stringInputs_, NS3_FMU_STRING );
+	addVariables( backend_->realOutputNames_, backend_->realOutputs_, NS3_FMU_REAL );
+	addVariables( backend_->integerOutputNames_, backend_->integerOutputs_, NS3_FMU_INTEGER );
+	addVariables( backend_->booleanOutputNames_, backend_->booleanOutputs_, NS3_FMU_BOOLEAN );
+	addVariables( backend_->stringOutputNames_, backend_->stringOutputs_, NS3_FMU_STRING );
+}
+
+
+InProcessBackEnd::~InProcessBackEnd()
+{
+	delete backend_;
+}
+
+
+int
+InProcessBackEnd::lookup( const std::string& name, int& type ) const
+{
+	for ( size_t i = 0; i < variables_.size(); ++i ) {
+		if ( name != variables_[i].name ) continue;
+		type = variables_[i].type;
+		return static_cast<int>( i );
+	}
+
+	return -1;
+}
+
+
+void
+InProcessBackEnd::setLogging( bool logging_on )
+{
+	settings_.logging_on = logging_on;
+
+	// Records written so far are kept.
+	if ( true == initialized_ ) backend_->updateTrace( true );
+}
+
+
+int
+InProcessBackEnd::initialize( const fmippReal& start_time, const fmippReal& stop_time, bool stop_time_defined )
+{
+	settings_.start_time = start_time;
+	settings_.stop_time = stop_time;
+	settings_.stop_time_defined = stop_time_defined;
+
+	backend_->initializeParameterValues();
+
+	initialized_ = true;
+
+	const char* argv[] = { "ns3-fmu-in-process" };
+	return backend_->initializeBackEnd( 1, argv );
+}
+
+
+int
+InProcessBackEnd::doStep( const fmippReal& com_point, const fmippReal& step_size, fmippReal& end_time )
+{
+	int status = backend_->doStep( com_point + step_size, com_point );
+	end_time = backend_->last_successful_time;
+
+	if ( ( 0 == status ) && ( true == backend_->step_discarded_ ) ) return NS3_FMU_DISCARD;
+	return status;
+}
+
+
+template<typename T>
+void
+InProcessBackEnd::addVariables( const std::vector<std::string>& names, const std::vector<T*>& values, int type )
+{
+	for ( size_t i = 0; i < names.size(); ++i ) {
+		Variable var = { names[i], type, values[i] };
+		variables_.push_back( var );
+	}
+}
+
+
+//
+// Implementation of the C interface (see 'in-process-api.h').
+//
+
+namespace {
+
+	InProcessBackEnd* toBackEnd( void* instance ) {
+		return static_cast<InProcessBackEnd*>( instance );
+	}
+}
+
+
+void*
+ns3_fmu_instantiate( void* backend, int logging_on )
+{
+	if ( 0 == backend ) return 0;
+	return new InProcessBackEnd( static_cast<SimpleEventQueueFMUBase*>( backend ), 0 != logging_on );
+}
+
+
+int
+ns3_fmu_lookup( void* instance, const char* name, int* type )
+{
+	return toBackEnd( instance )->lookup( name, *type );
+}
+
+
+int
+ns3_fmu_set_real( void* instance, int index, double value )
+{
+	fmippReal* var = toBackEnd( instance )->value<fmippReal>( index, NS3_FMU_REAL );
+	if ( 0 == var ) return 1;
+
+	*var = value;
+	return 0;
+}
+
+
+int
+ns3_fmu_get_real( void* instance, int index, double* value )
+{
+	fmippReal* var = toBackEnd( instance )->value<fmippReal>( index, NS3_FMU_REAL );
+	if ( 0 == var ) return 1;
+
+	*value = *var;
+	return 0;
+}
+
+
+int
+ns3_fmu_set_integer( void* instance, int index, int value )
+{
+	fmippInteger* var = toBackEnd( instance )->value<fmippInteger>( index, NS3_FMU_INTEGER );
+	if ( 0 == var ) return 1;
+
+	*var = value;
+	return 0;
+}
+
+
+int
+ns3_fmu_get_integer( void* instance, int index, int* value )
+{
+	fmippInteger* var = toBackEnd( instance )->value<fmippInteger>( index, NS3_FMU_INTEGER );
+	if ( 0 == var ) return 1;
+
+	*value = *var;
+	return 0;
+}
+
+
+int
+ns3_fmu_set_boolean( void* instance, int index, int value )
+{
+	fmippBoolean* var = toBackEnd( instance )->value<fmippBoolean>( index, NS3_FMU_BOOLEAN );
+	if ( 0 == var ) return 1;
+
+	*var = ( 0 != value );
+	return 0;
+}
+
+
+int
+ns3_fmu_get_boolean( void* instance, int index, int* value )
+{
+	fmippBoolean* var = toBackEnd( instance )->value<fmippBoolean>( index, NS3_FMU_BOOLEAN );
+	if ( 0 == var ) return 1;
+
+	*value = ( *var ) ? 1 : 0;
+	return 0;
+}
+
+
+int
+ns3_fmu_set_string( void* instance, int index, const char* value )
+{
+	fmippString* var = toBackEnd( instance )->value<fmippString>( index, NS3_FMU_STRING );
+	if ( 0 == var ) return 1;
+
+	*var = ( 0 != value ) ? value : "";
+	return 0;
+}
+
+
+int
+ns3_fmu_get_string( void* instance, int index, const char** value )
+{
+	fmippString* var = toBackEnd( instance )->value<fmippString>( index, NS3_FMU_STRING );
+	if ( 0 == var ) return 1;
+
+	*value = var->c_str();
+	return 0;
+}
+
+
+int
+ns3_fmu_set_binary( void* instance, int index, const unsigned char* value, size_t size )
+{
+	fmippString* var = toBackEnd( instance )->value<fmippString>( index, NS3_FMU_STRING );
+	if ( 0 == var ) return 1;
+
+	if ( 0 != value ) var->assign( reinterpret_cast<const char*>( value ), size );
+	else var->clear();
+	return 0;
+}
+
+
+int
+ns3_fmu_get_binary( void* instance, int index, const unsigned char** value, size_t* size )
+{
+	fmippString* var = toBackEnd( instance )->value<fmippString>( index, NS3_FMU_STRING );
+	if ( 0 == var ) return 1;
+
+	*value = reinterpret_cast<const unsigned char*>( var->data() );
+	*size = var->size();
+	return 0;
+}
+
+
+int
+ns3_fmu_set_logging( void* instance, int logging_on )
+{
+	toBackEnd( instance )->setLogging( 0 != logging_on );
+	return 0;
+}
+
+
+int
+ns3_fmu_initialize( void* instance, double start_time, double stop_time, int stop_time_defined )
+{
+	return toBackEnd( instance )->initialize( start_time, stop_time, 0 != stop_time_defined );
+}
+
+
+int
+ns3_fmu_do_step( void* instance, double com_point, double step_size, double* end_time )
+{
+	return toBackEnd( instance )->doStep( com_point, step_size, *end_time );
+}
+
+
+void
+ns3_fmu_free( void* instance )
+{
+	delete toBackEnd( instance );
+}
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_IN_PROCESS_BACKEND
+#define _NS3_FMU_IN_PROCESS_BACKEND
+
+
+#include <string>
+#include <vector>
+
+#include "simple-event-queue-fmu-base.h"
+#include "in-process-api.h"
+
+
+// Drives a backend directly, i.e., without the FMI++ backend component and the IPC to the FMU frontend.
+// This allows to load an ns-3 scenario compiled as shared library into the FMU DLL (see 'in-process-api.h'),
+// such that the backend runs in the same process as the co-simulation master.
+//
+// Since the ns-3 simulator is a singleton, only one backend can run in-process at a time.
+class InProcessBackEnd
+{
+public:
+
+	// Takes ownership of the backend and defines its inputs, outputs and parameters.
+	InProcessBackEnd( SimpleEventQueueFMUBase* backend, bool logging_on );
+
+	~InProcessBackEnd();
+
+	// Look up a scalar variable by name, returns its index (or -1 if the variable does not exist).
+	int lookup( const std::string& name, int& type ) const;
+
+	// Pointer to the value of a scalar variable (0 if the index or the type do not match).
+	template<typename T>
+	T* value( int index, int type ) const {
+		if ( ( 0 > index ) || ( static_cast<size_t>( index ) >= variables_.size() ) ) return 0;
+		return ( type == variables_[index].type ) ? static_cast<T*>( variables_[index].value ) : 0;
+	}
+
+	// Switch logging on or off (the debug trace is opened or closed right away in case the backend
+	// has already been initialized, otherwise the setting is applied when initializing the backend).
+	void setLogging( bool logging_on );
+
+	// Initialize the backend (after the parameters have been set).
+	int initialize( const fmippReal& start_time, const fmippReal& stop_time, bool stop_time_defined );
+
+	// Advance the backend from the communication point by the step size (0 for an FMU iteration).
+	// Returns NS3_FMU_DISCARD in case the step has returned early at end_time (at the time of an event).
+	int doStep( const fmippReal& com_point, const fmippReal& step_size, fmippReal& end_time );
+
+private:
+
+	struct Variable {
+		std::string name;
+		int type;
+		void* value;
+	};
+
+	template<typename T>
+	void addVariables( const std::vector<std::string>& names, const std::vector<T*>& values, int type );
+
+	SimpleEventQueueFMUBase* backend_;
+
+	SimpleEventQueueFMUBase::InProcessSettings settings_;
+
+	bool initialized_;
+
+	// All inputs, outputs and parameters of the backend.
+	std::vector<Variable> variables_;
+};
+
+
+#endif // _NS3_FMU_IN_PROCESS_BACKEND
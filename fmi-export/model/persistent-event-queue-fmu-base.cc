@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+
+// ns-3 includes.
+#include "ns3/core-module.h"
+
+#include "persistent-event-queue-fmu-base.h"
+#include "backend-zygote.h"
+
+
+using namespace ns3;
+using namespace Ns3FMUBackendEventQueue;
+
+
+// Delivery horizon used in case no (positive) value has been specified.
+static const double DEFAULT_DELIVERY_HORIZON = 10.;
+
+
+PersistentEventQueueFMUBase::PersistentEventQueueFMUBase() :
+	delivery_horizon( DEFAULT_DELIVERY_HORIZON ),
+	start_time_stamp_( 0 ),
+	messages_in_flight_( 0 ),
+	running_ahead_( false ),
+	topology_initialized_( false )
+{}
+
+
+PersistentEventQueueFMUBase::~PersistentEventQueueFMUBase()
+{
+	if ( true == topology_initialized_ ) Simulator::Destroy();
+}
+
+
+void
+PersistentEventQueueFMUBase::initializeScalarVariables()
+{
+	SimpleEventQueueFMUBase::initializeScalarVariables();
+
+	// Delivery horizon (parameter).
+	addRealParameter( delivery_horizon );
+}
+
+
+int
+PersistentEventQueueFMUBase::initializeBackEnd( int argc, const char* argv[] )
+{
+	// The ns-3 simulation is kept alive between steps, which is not possible when other backend
+	// instances are hosted by the same process.
+	if ( true == BackEndZygote::isSharedProcess() ) return 1;
+
+	int status = SimpleEventQueueFMUBase::initializeBackEnd( argc, argv );
+	if ( 0 != status ) return status;
+
+	if ( 0. >= delivery_horizon ) delivery_horizon = DEFAULT_DELIVERY_HORIZON;
+
+	// The FMU start time corresponds to ns-3 simulation time zero.
+	start_time_stamp_ = toTimeStamp( getStartTime() );
+
+	return 0;
+}
+
+
+void
+PersistentEventQueueFMUBase::runSimulation( const double& sync_time )
+{
+	// Set up the topology (only once, when the first simulation is run).
+	if ( false == topology_initialized_ )
+	{
+		initializeTopology();
+		topology_initialized_ = true;
+	}
+
+	// Advance the ns-3 simulation to the current synchronization time. In case the ns-3 simulation
+	// is already ahead (because it waited for the reception of messages), it is not advanced.
+	Time sim_sync_time = getSyncTimeAsSimulationTime();
+	if ( sim_sync_time > Simulator::Now() )
+	{
+		Simulator::Stop( sim_sync_time - Simulator::Now() );
+		Simulator::Run();
+	}
+	else if ( sim_sync_time < Simulator::Now() )
+	{
+		trace( TRACE_SIMULATION_AHEAD, addTimeStamps( start_time_stamp_, Simulator::Now().GetNanoSeconds() ), 0, getSyncTimeStamp() );
+	}
+
+	// Send new messages.
+	sendMessages();
+
+	// Run the ns-3 simulation until all messages have been received (or until the delivery horizon has been reached).
+	if ( 0 < messages_in_flight_ )
+	{
+		trace( TRACE_MESSAGES_IN_FLIGHT, getSyncTimeStamp(), 0, messages_in_flight_ );
+
+		EventId horizon = Simulator::Schedule( Seconds( delivery_horizon ), &PersistentEventQueueFMUBase::stopSimulation );
+
+		running_ahead_ = true;
+		Simulator::Run();
+		running_ahead_ = false;
+
+		Simulator::Cancel( horizon );
+
+		// Messages that have not been received within the delivery horizon are considered lost.
+		if ( 0 < messages_in_flight_ ) trace( TRACE_MESSAGES_NOT_RECEIVED, getSyncTimeStamp(), 0, messages_in_flight_ );
+		messages_in_flight_ = 0;
+	}
+}
+
+
+void
+PersistentEventQueueFMUBase::notifyMessageSent()
+{
+	++messages_in_flight_;
+}
+
+
+void
+PersistentEventQueueFMUBase::notifyMessageReceived( const MessageID& msg_id, const Receiver& receiver )
+{
+	// Messages received before the current synchronization time (i.e., messages that have not been
+	// received within the delivery horizon) are ignored, compare 'addNewEventForMessageWithDelay(...)'.
+	addNewEventForMessageWithDelay( Simulator::Now() - getSyncTimeAsSimulationTime(), msg_id, receiver );
+
+	if ( 0 < messages_in_flight_ ) --messages_in_flight_;
+
+	// Stop the ns-3 simulation as soon as all messages have been received.
+	if ( ( true == running_ahead_ ) && ( 0 == messages_in_flight_ ) ) Simulator::Stop();
+}
+
+
+Time
+PersistentEventQueueFMUBase::getSyncTimeAsSimulationTime() const
+{
+	return NanoSeconds( getSyncTimeStamp() - start_time_stamp_ );
+}
+
+
+void
+PersistentEventQueueFMUBase::stopSimulation()
+{
+	Simulator::Stop();
+}
@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_PERSISTENT_BACKEND_BASE
+#define _NS3_FMU_PERSISTENT_BACKEND_BASE
+
+
+// ns-3 includes.
+#include "ns3/nstime.h"
+
+#include "simple-event-queue-fmu-base.h"
+
+
+// In contrast to class 'SimpleEventQueueFMUBase', where a new ns-3 simulation is set up and run
+// for every message, this class keeps a single ns-3 simulation alive for the entire co-simulation.
+// The topology is built only once and the ns-3 simulator is advanced incrementally to the FMU's
+// synchronization points. Hence, the state of the network (e.g., queues, congestion) is preserved
+// between messages.
+//
+// When messages are sent, the ns-3 simulation runs ahead until all messages have been received
+// (or until the delivery horizon has been reached). Messages sent while the ns-3 simulation is
+// ahead of the FMU's synchronization time are sent at the current ns-3 simulation time instead.
+class PersistentEventQueueFMUBase : public SimpleEventQueueFMUBase
+{
+public:
+
+	PersistentEventQueueFMUBase();
+	virtual ~PersistentEventQueueFMUBase();
+
+	virtual void initializeScalarVariables();
+	virtual int initializeBackEnd( int argc, const char* argv[] );
+
+	// This function sets up the topology of the ns-3 simulation (to be implemented by inheriting
+	// application). It is called only once, right before the first simulation is run.
+	virtual void initializeTopology() = 0;
+
+	// This function sends new messages according to the current inputs (to be implemented by inheriting
+	// application). When it is called, the ns-3 simulation has been advanced to the current synchronization
+	// time, i.e., messages can be sent immediately. Each message has to be announced via 'notifyMessageSent()'.
+	virtual void sendMessages() = 0;
+
+	// Advance the ns-3 simulation and send new messages (called by the base class).
+	virtual void runSimulation( const double& sync_time );
+
+protected:
+
+	// Announce that a message has been sent.
+	void notifyMessageSent();
+
+	// Announce that a message has been received at the current ns-3 simulation time. A new event is added
+	// to the event queue (in case the message has not been received before the current synchronization time).
+	void notifyMessageReceived( const Ns3FMUBackendEventQueue::MessageID& msg_id,
+		const Ns3FMUBackendEventQueue::Receiver& receiver );
+
+	// Current synchronization time as ns-3 simulation time.
+	ns3::Time getSyncTimeAsSimulationTime() const;
+
+private:
+
+	// Stop the ns-3 simulation (scheduled as event).
+	static void stopSimulation();
+
+	// Maximum time the ns-3 simulation runs ahead to wait for the reception of messages (parameter).
+	fmippReal delivery_horizon;
+
+	// FMU start time (corresponds to ns-3 simulation time zero).
+	Ns3FMUBackendEventQueue::TimeStamp start_time_stamp_;
+
+	// Number of messages that have been sent but not yet received.
+	size_t messages_in_flight_;
+
+	// Flag indicating that the ns-3 simulation runs ahead to wait for the reception of messages.
+	bool running_ahead_;
+
+	// Flag indicating that the topology has been set up.
+	bool topology_initialized_;
+};
+
+
+#endif // _NS3_FMU_PERSISTENT_BACKEND_BASE
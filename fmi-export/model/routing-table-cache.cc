@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+// ns-3 includes.
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+
+#include "routing-table-cache.h"
+
+
+namespace {
+
+	// FNV-1a hash.
+	const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	const uint64_t FNV_PRIME = 1099511628211ULL;
+
+	void hashBytes( uint64_t& hash, const void* data, size_t size ) {
+		const unsigned char* bytes = static_cast<const unsigned char*>( data );
+		for ( size_t i = 0; i < size; ++i ) {
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+	}
+
+	void hashValue( uint64_t& hash, uint32_t val ) { hashBytes( hash, &val, sizeof( val ) ); }
+
+	void hashValue( uint64_t& hash, const std::string& val ) {
+		hashValue( hash, static_cast<uint32_t>( val.size() ) );
+		hashBytes( hash, val.data(), val.size() );
+	}
+
+	// Retrieve the global routing protocol of a node (0 if not available).
+	ns3::Ptr<ns3::Ipv4GlobalRouting> getGlobalRouting( ns3::Ptr<ns3::Ipv4> ipv4 ) {
+		ns3::Ptr<ns3::Ipv4RoutingProtocol> protocol = ipv4->GetRoutingProtocol();
+
+		ns3::Ptr<ns3::Ipv4GlobalRouting> global = ns3::DynamicCast<ns3::Ipv4GlobalRouting>( protocol );
+		if ( 0 != global ) return global;
+
+		ns3::Ptr<ns3::Ipv4ListRouting> list = ns3::DynamicCast<ns3::Ipv4ListRouting>( protocol );
+		if ( 0 == list ) return 0;
+
+		int16_t priority;
+		for ( uint32_t i = 0; i < list->GetNRoutingProtocols(); ++i ) {
+			global = ns3::DynamicCast<ns3::Ipv4GlobalRouting>( list->GetRoutingProtocol( i, priority ) );
+			if ( 0 != global ) return global;
+		}
+
+		return 0;
+	}
+}
+
+
+RoutingTableCache::RoutingTableCache() : file_( 0 ) {}
+
+
+RoutingTableCache::~RoutingTableCache()
+{
+	if ( 0 != file_ ) delete file_;
+}
+
+
+// Each entry of the file consists of the topology hash (64 bit), the number of routes (32 bit)
+// and the routes themselves. Incomplete entries at the end are ignored.
+bool
+RoutingTableCache::open( const std::string& file_name )
+{
+	std::ifstream input( file_name.c_str(), std::ios::binary );
+	if ( true == input.good() )
+	{
+		uint64_t hash;
+		uint32_t n_routes;
+		RoutingTables routes;
+
+		while ( input.read( reinterpret_cast<char*>( &hash ), sizeof( hash ) ) )
+		{
+			if ( !input.read( reinterpret_cast<char*>( &n_routes ), sizeof( n_routes ) ) ) break;
+			routes.resize( n_routes );
+			if ( 0 < n_routes && !input.read( reinterpret_cast<char*>( &routes[0] ), n_routes * sizeof( Route ) ) ) break;
+			routes_[hash] = routes;
+		}
+	}
+
+	if ( 0 != file_ ) delete file_;
+	file_ = new std::ofstream( file_name.c_str(), std::ios::binary | std::ios::app );
+
+	return file_->good();
+}
+
+
+bool
+RoutingTableCache::populateRoutingTables()
+{
+	uint64_t hash = computeTopologyHash();
+
+	std::unordered_map<uint64_t, RoutingTables>::const_iterator it = routes_.find( hash );
+	if ( ( routes_.end() != it ) && ( true == installStaticRoutes( it->second ) ) ) return true;
+
+	// Compute the routes and add them to the cache.
+	ns3::Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+
+	// The routing tables are populated, but the routes cannot be added to the cache.
+	RoutingTables routes;
+	if ( false == retrieveGlobalRoutes( routes ) ) return false;
+
+	routes_[hash] = routes;
+
+	if ( 0 != file_ )
+	{
+		uint32_t n_routes = static_cast<uint32_t>( routes.size() );
+		file_->write( reinterpret_cast<const char*>( &hash ), sizeof( hash ) );
+		file_->write( reinterpret_cast<const char*>( &n_routes ), sizeof( n_routes ) );
+		if ( 0 < n_routes ) file_->write( reinterpret_cast<const char*>( &routes[0] ), n_routes * sizeof( Route ) );
+		file_->flush();
+	}
+
+	return true;
+}
+
+
+uint64_t
+RoutingTableCache::computeTopologyHash()
+{
+	uint64_t hash = FNV_OFFSET_BASIS;
+
+	hashValue( hash, ns3::NodeList::GetNNodes() );
+
+	for ( ns3::NodeList::Iterator it_node = ns3::NodeList::Begin(); it_node != ns3::NodeList::End(); ++it_node )
+	{
+		ns3::Ptr<ns3::Node> node = *it_node;
+		hashValue( hash, node->GetId() );
+
+		// Devices and the channels they are attached to.
+		hashValue( hash, node->GetNDevices() );
+		for ( uint32_t i = 0; i < node->GetNDevices(); ++i )
+		{
+			ns3::Ptr<ns3::NetDevice> device = node->GetDevice( i );
+			hashValue( hash, device->GetInstanceTypeId().GetName() );
+
+			ns3::Ptr<ns3::Channel> channel = device->GetChannel();
+			if ( 0 == channel ) {
+				hashValue( hash, 0u );
+				continue;
+			}
+
+			hashValue( hash, channel->GetNDevices() );
+			for ( uint32_t j = 0; j < channel->GetNDevices(); ++j ) {
+				ns3::Ptr<ns3::NetDevice> peer = channel->GetDevice( j );
+				hashValue( hash, peer->GetNode()->GetId() );
+				hashValue( hash, peer->GetIfIndex() );
+			}
+		}
+
+		// IPv4 interfaces.
+		ns3::Ptr<ns3::Ipv4> ipv4 = node->GetObject<ns3::Ipv4>();
+		if ( 0 == ipv4 ) {
+			hashValue( hash, 0u );
+			continue;
+		}
+
+		hashValue( hash, ipv4->GetNInterfaces() );
+		for ( uint32_t i = 0; i < ipv4->GetNInterfaces(); ++i )
+		{
+			hashValue( hash, ( true == ipv4->IsUp( i ) ) ? 1 : 0 );
+			hashValue( hash, ipv4->GetMetric( i ) );
+			hashValue( hash, ipv4->GetNAddresses( i ) );
+			for ( uint32_t j = 0; j < ipv4->GetNAddresses( i ); ++j ) {
+				ns3::Ipv4InterfaceAddress address = ipv4->GetAddress( i, j );
+				hashValue( hash, address.GetLocal().Get() );
+				hashValue( hash, address.GetMask().Get() );
+			}
+		}
+	}
+
+	return hash;
+}
+
+
+bool
+RoutingTableCache::retrieveGlobalRoutes( RoutingTables& routes )
+{
+	routes.clear();
+
+	for ( ns3::NodeList::Iterator it_node = ns3::NodeList::Begin(); it_node != ns3::NodeList::End(); ++it_node )
+	{
+		ns3::Ptr<ns3::Ipv4> ipv4 = ( *it_node )->GetObject<ns3::Ipv4>();
+		if ( 0 == ipv4 ) continue;
+
+		ns3::Ptr<ns3::Ipv4GlobalRouting> global = getGlobalRouting( ipv4 );
+		if ( 0 == global ) return false;
+
+		for ( uint32_t i = 0; i < global->GetNRoutes(); ++i )
+		{
+			ns3::Ipv4RoutingTableEntry* entry = global->GetRoute( i );
+
+			Route route;
+			route.node = ( *it_node )->GetId();
+			route.interface = entry->GetInterface();
+			route.dest = entry->GetDest().Get();
+			route.mask = entry->GetDestNetworkMask().Get();
+			route.gateway = ( true == entry->IsGateway() ) ? entry->GetGateway().Get() : 0;
+			routes.push_back( route );
+		}
+	}
+
+	return true;
+}
+
+
+bool
+RoutingTableCache::installStaticRoutes( const RoutingTables& routes )
+{
+	ns3::Ipv4StaticRoutingHelper helper;
+
+	// Check first that all routes can be installed, otherwise the routes would be installed only partially.
+	std::vector< ns3::Ptr<ns3::Ipv4StaticRouting> > static_routing( routes.size() );
+	for ( size_t i = 0; i < routes.size(); ++i )
+	{
+		if ( routes[i].node >= ns3::NodeList::GetNNodes() ) return false;
+
+		ns3::Ptr<ns3::Ipv4> ipv4 = ns3::NodeList::GetNode( routes[i].node )->GetObject<ns3::Ipv4>();
+		if ( ( 0 == ipv4 ) || ( routes[i].interface >= ipv4->GetNInterfaces() ) ) return false;
+
+		static_routing[i] = helper.GetStaticRouting( ipv4 );
+		if ( 0 == static_routing[i] ) return false;
+	}
+
+	for ( size_t i = 0; i < routes.size(); ++i )
+	{
+		const Route& route = routes[i];
+		if ( 0 == route.gateway ) {
+			static_routing[i]->AddNetworkRouteTo( ns3::Ipv4Address( route.dest ),
+				ns3::Ipv4Mask( route.mask ), route.interface );
+		} else {
+			static_routing[i]->AddNetworkRouteTo( ns3::Ipv4Address( route.dest ),
+				ns3::Ipv4Mask( route.mask ), ns3::Ipv4Address( route.gateway ), route.interface );
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_ROUTING_TABLE_CACHE
+#define _NS3_FMU_ROUTING_TABLE_CACHE
+
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <unordered_map>
+#include <stdint.h>
+
+
+// Cache for global routing tables. Computing global routes (via 'Ipv4GlobalRoutingHelper::PopulateRoutingTables()')
+// is expensive for large topologies. In case the topology is rebuilt for every simulation, the routes
+// are computed only once per topology. For subsequent simulations with the same topology, the cached
+// routes are installed as static routes instead.
+//
+// Topologies are identified by a hash over all nodes, devices, channels and IPv4 interfaces (addresses,
+// masks, metrics). The cache is kept in memory and can optionally be backed by a file. Entries of an
+// existing file are loaded when the file is opened, new entries are appended to the file.
+//
+// All nodes must have an IPv4 stack with static and global routing (default of 'InternetStackHelper').
+class RoutingTableCache
+{
+public:
+
+	RoutingTableCache();
+	~RoutingTableCache();
+
+	// Open a cache file (created if it does not exist). Returns false in case the file could not be opened.
+	bool open( const std::string& file_name );
+
+	// Populate the routing tables of all nodes, either from the cache or by computing global routes.
+	// Returns false in case newly computed routes could not be added to the cache (the routing tables
+	// are populated nonetheless).
+	bool populateRoutingTables();
+
+	// Compute the hash of the current topology.
+	static uint64_t computeTopologyHash();
+
+	size_t size() const { return routes_.size(); }
+
+private:
+
+	// The cache is not copyable.
+	RoutingTableCache( const RoutingTableCache& );
+	RoutingTableCache& operator=( const RoutingTableCache& );
+
+	// A route of a node (IPv4 addresses and masks in host byte order).
+	struct Route {
+		uint32_t node;
+		uint32_t interface;
+		uint32_t dest;
+		uint32_t mask;
+		uint32_t gateway;
+	};
+
+	typedef std::vector<Route> RoutingTables;
+
+	// Retrieve the routes computed by global routing.
+	static bool retrieveGlobalRoutes( RoutingTables& routes );
+
+	// Install routes as static routes.
+	static bool installStaticRoutes( const RoutingTables& routes );
+
+	std::unordered_map<uint64_t, RoutingTables> routes_;
+
+	// Output file stream for appending new entries (0 if no file is used).
+	std::ofstream* file_;
+};
+
+
+#endif // _NS3_FMU_ROUTING_TABLE_CACHE
@@ -19,16 +19,27 @@
 
 #include <string>
 #include <sstream>
+#include <fstream>
 #include <cmath>
 #include <limits>
 #include <random>
 #include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 
 
 // ns-3 includes.
 #include "ns3/core-module.h"
 
 #include "simple-event-queue-fmu-base.h"
+#include "backend-zygote.h"
+#include "state-snapshots.h"
 
 // FMI++ includes.
 #include "export/include/BackEndApplicationBase.h"
@@ -38,26 +49,102 @@ using namespace ns3;
 using namespace Ns3FMUBackendEventQueue;
 
 
+namespace {
+
+	// File name of the debug trace (in the FMU's working directory).
+	const char* TRACE_FILE_NAME = "sim_ict_exe.log";
+}
+
+
+SimpleEventQueueFMUBase::~SimpleEventQueueFMUBase()
+{
+	// Other backend instances hosted by the same process may use ns-3 meanwhile (see class 'SharedProcessLock').
+	SharedProcessLock lock;
+
+	// Write the remaining trace records.
+	delete trace_;
+
+	// The co-simulation run has not been aborted, hence the checkpoint is not needed anymore.
+	if ( true == remove_checkpoint_ ) std::remove( checkpoint_file_name_.c_str() );
+
+	// Terminate the frozen processes of the state snapshots (if any).
+	if ( true == state_snapshots_enabled_ ) StateSnapshots::finish();
+}
+
+
 // This function initializes the backend's scalar variables (parameters, inputs, outputs),
 // which have to be class member variables (or global variables).
 // Only calls to 'addRealInput(...)', 'addRealOutput(...)', etc. are allowed.
 void
 SimpleEventQueueFMUBase::initializeScalarVariables()
 {
+	// The inheriting application may already use ns-3 here (see class 'SharedProcessLock').
+	SharedProcessLock lock;
+
 	// Define FMI real output variable (used by this backend implementation
 	// to tell the timestamp of the next event in the event queue.
 	addRealOutput( next_event_time );
 
+	// Define FMI real output variable telling the time reached by the last step (see 'doStep').
+	addRealOutput( last_successful_time );
+
 	// Default step size (parameter).
 	addRealParameter( default_event_step_size );
 
 	// Random generator seed (parameter).
 	addIntegerParameter( random_seed );
 
+	// Fused step mode (parameter).
+	addIntegerParameter( fused_steps );
+
 	// Initialize the user-defined FMI inputs/outputs/parameters.
 	initializeSimulation();
+
+	// All integer inputs/outputs defined so far are associated to messages.
+	n_message_inputs_ = integerInputs_.size();
+	n_message_outputs_ = integerOutputs_.size();
+
+	// Define optional lookahead outputs (only if enabled by the inheriting application).
+	if ( 0 < lookahead_size_ ) initializeLookaheadOutputs();
+
+	// Define optional inputs/outputs for state snapshots (only if enabled by the inheriting application).
+	if ( true == state_snapshots_enabled_ ) initializeStateSnapshotVariables();
+
+	// Define optional checkpoint interval (only if enabled by the inheriting application).
+	if ( true == checkpoints_enabled_ ) {
+		addRealParameter( checkpoint_interval );
+	}
+}
+
+
+// Define FMI outputs for the next events in the event queue. Variable names are derived from
+// the names of the references, hence a local reference with an according name is defined for
+// every output.
+#define ADD_LOOKAHEAD_OUTPUTS( i ) \
+	if ( i <= lookahead_size_ ) { \
+		fmippReal& next_event_time_##i = lookahead_times_[i-1]; \
+		addRealOutput( next_event_time_##i ); \
+		fmippInteger& next_event_receiver_##i = lookahead_receivers_[i-1]; \
+		addIntegerOutput( next_event_receiver_##i ); \
+	}
+
+void
+SimpleEventQueueFMUBase::initializeLookaheadOutputs()
+{
+	ADD_LOOKAHEAD_OUTPUTS( 1 )
+	ADD_LOOKAHEAD_OUTPUTS( 2 )
+	ADD_LOOKAHEAD_OUTPUTS( 3 )
+	ADD_LOOKAHEAD_OUTPUTS( 4 )
+	ADD_LOOKAHEAD_OUTPUTS( 5 )
+	ADD_LOOKAHEAD_OUTPUTS( 6 )
+	ADD_LOOKAHEAD_OUTPUTS( 7 )
+	ADD_LOOKAHEAD_OUTPUTS( 8 )
+
+	addIntegerOutput( pending_events );
 }
 
+#undef ADD_LOOKAHEAD_OUTPUTS
+
 
 void
 SimpleEventQueueFMUBase::initializeParameterValues() {} // Nothing to be done here ...
@@ -69,25 +156,58 @@ SimpleEventQueueFMUBase::initializeParameterValues() {} // Nothing to be done he
 int
 SimpleEventQueueFMUBase::initializeBackEnd( int argc, const char* argv[] )
 {
-	// Initialize output for debug messages.
-	if ( true == loggingOn() ) debug_ = new std::ofstream( "sim_ict_exe.log" );
+	SharedProcessLock lock;
 
-	fmippReal start_time = getCurrentCommunicationPoint();
+	// Initialize the debug trace (only if logging is on, otherwise tracing does nothing).
+	updateTrace( false );
 
-	// Insert first dummy event into the event queue.
-	current_event_ = event_queue_.insert( new Event( start_time, 0, true, 0 ) ).first;
-	next_event_time = start_time;
+	TimeStamp start_time = toTimeStamp( getStartTime() );
+	last_successful_time = getStartTime();
 
 	// If default event step size is zero, set it to the largest possible value.
-	// This is equivalent to not using default events.
-	if ( 0. == default_event_step_size ) default_event_step_size = std::numeric_limits<fmippReal>::max();
+	// This is equivalent to not using default events. Positive step sizes below
+	// the resolution of the time stamps are rounded up to one tick.
+	TimeStamp default_event_step = ( 0. >= default_event_step_size ) ? TIME_STAMP_MAX : std::max<TimeStamp>( toTimeStamp( default_event_step_size ), 1 );
+
+	// The first (dummy) event is a default event at the start time.
+	default_event_timer_.start( start_time, default_event_step );
+	setNextEventTime( start_time );
+	sync_time_stamp_ = start_time;
+
+	if ( 0 < lookahead_size_ ) updateLookaheadOutputs();
 
 	// Radom generator seed has to be a positive non-zero integer.
 	if ( 1 > random_seed ) random_seed = 1;
 
+	// Load delays from cache file.
+	if ( ( true == delay_cache_enabled_ ) && ( false == delay_cache_file_name_.empty() ) ) {
+		if ( false == delay_cache_.open( delay_cache_file_name_ ) ) return 1;
+
+		trace( TRACE_DELAY_CACHE_LOADED, start_time, 0, delay_cache_.size() );
+	}
+
 	// Set ns-3 random generator seed.
 	RngSeedManager::SetSeed( random_seed );
 
+	// Open the surrogate delay table.
+	if ( false == surrogate_table_file_name_.empty() ) {
+		if ( true == surrogate_table_.open( surrogate_table_file_name_ ) ) {
+			surrogate_rng_.seed( random_seed );
+			trace( TRACE_SURROGATE_TABLE, start_time, 0, 1 );
+		} else {
+			trace( TRACE_SURROGATE_TABLE, start_time, 0, 0 );
+		}
+	}
+
+	// Resume from the checkpoint (if enabled and available).
+	if ( true == checkpoints_enabled_ ) {
+		if ( false == resumeFromCheckpoint() ) {
+			trace( TRACE_CHECKPOINT_INVALID, start_time );
+			return 1;
+		}
+		remove_checkpoint_ = true;
+	}
+
 	return 0;
 }
 
@@ -98,141 +218,1261 @@ SimpleEventQueueFMUBase::initializeBackEnd( int argc, const char* argv[] )
 int
 SimpleEventQueueFMUBase::doStep( const fmippReal& syncTime, const fmippReal& lastSyncTime )
 {
-	std::stringstream debug_msg;
-	debug_msg << "DOSTEP: t = " << syncTime << std::endl;
+	// The thread of a hosted backend instance must not be cancelled while stepping (see class 'ThreadCancellation').
+	ThreadCancellation no_cancellation( false );
 
-	if ( fabs( syncTime - lastSyncTime ) > 1e-9 ) // syncTime != lastSyncTime -> This is a time advance.
+	// State snapshot commands are applied before anything else (the process is forked, hence no lock must be held).
+	if ( ( true == state_snapshots_enabled_ ) && ( true == applyStateCommands( syncTime, lastSyncTime ) ) ) return 0;
+
+	// Other backend instances hosted by the same process have to wait until this step is done.
+	SharedProcessLock lock;
+
+	TimeStamp sync_time = toTimeStamp( syncTime );
+	TimeStamp last_sync_time = toTimeStamp( lastSyncTime );
+	fmippReal sync_time_seconds = syncTime;
+
+	trace( TRACE_DOSTEP, sync_time );
+
+	step_discarded_ = false;
+
+	if ( sync_time != last_sync_time ) // This is a time advance.
 	{
-		if ( syncTime > next_event_time ) return 1; // This synchronization step omitted at least one event. -> Abort!
+		// This synchronization step would omit at least one event. -> Return early at the time of the next event.
+		if ( sync_time > next_event_time_stamp_ ) {
+			discardStep( sync_time );
+			sync_time = next_event_time_stamp_;
+			sync_time_seconds = toSeconds( sync_time );
+		}
 
-		// Reset in- and outputs.
-		resetIntegerInputs();
+		// Reset outputs.
 		resetIntegerOutputs();
+		resetPayloadOutputs();
+
+		// The synchronization time is advanced in any case (e.g., it is stored in checkpoints).
+		sync_time_stamp_ = sync_time;
+
+		if ( 0 == fused_steps ) {
+			// Reset inputs, new messages are only accepted with the subsequent event iteration.
+			resetIntegerInputs();
+		} else if ( ( sync_time == next_event_time_stamp_ ) || ( true == hasNewMessages() ) ) {
+			// Fused step: inputs set before this step are sent at the new synchronization time and the
+			// event iteration is done right away, i.e., without a separate FMU iteration.
+			iterate( sync_time, sync_time_seconds );
+		}
 	}
 	else // syncTime == lastSyncTime: This is an event iteration! Check for new inputs and set ouputs.
 	{
-		if ( fabs( syncTime - next_event_time ) < 1e-9 ) // This synchronization coincides with an event in the queue.
+		iterate( sync_time, syncTime );
+	}
+
+	last_successful_time = sync_time_seconds;
+
+	// Write a checkpoint after time advances (at the earliest when the checkpoint interval has elapsed).
+	if ( ( sync_time != last_sync_time ) && ( sync_time >= next_checkpoint_time_stamp_ ) ) writeCheckpointFile( sync_time );
+
+	trace( TRACE_NEXT_EVENT_TIME, next_event_time_stamp_ );
+
+	return 0; // No errors, return value 0.
+}
+
+
+// Event iteration: deliver the messages of the current event (if any) and simulate new messages.
+void
+SimpleEventQueueFMUBase::iterate( const TimeStamp& sync_time, const fmippReal& syncTime )
+{
+	sync_time_stamp_ = sync_time;
+
+	if ( sync_time == next_event_time_stamp_ ) // This synchronization coincides with an event in the queue.
+	{
+		trace( TRACE_COINCIDES_WITH_EVENT, next_event_time_stamp_ );
+
+		if ( sync_time == default_event_timer_.next() ) { // This is a default event. -> Advance to the next default event.
+			default_event_timer_.advance( sync_time );
+
+			trace( TRACE_NEXT_DEFAULT_EVENT, default_event_timer_.next() );
+		}
+
+		if ( false == event_queue_.empty() && sync_time == event_queue_.top()->time_stamp ) // Messages are delivered.
 		{
-			debug_msg << "DOSTEP: coincides with event at t = " << next_event_time << std::endl;
-			debug_msg << "DOSTEP: event has msg_id = " << (*current_event_)->msg_id << std::endl;
+			const Event* current_event = event_queue_.top();
 
-			if ( true == (*current_event_)->default_event ) { // This event is a default event. -> Add the next default event.
-				fmippReal next_default_event_time = (*current_event_)->time_stamp + default_event_step_size;
-				event_queue_.insert( current_event_, new Event( next_default_event_time, 0, true, 0 ) );
+			// Set outputs according to all messages of this event (in case receivers have been defined).
+			// An output can only hold one message ID per event iteration, hence messages for receivers
+			// that have already been set are postponed to the next event iteration at the same time.
+			written_receivers_.clear();
+			postponed_deliveries_.clear();
 
-				//std::stringstream debug_msg;
-				debug_msg << "add new default event at t = " << next_default_event_time << std::endl;
-				//debug( debug_msg.str() );
-			}
+			std::vector<Delivery>::const_iterator it = current_event->deliveries.begin();
+			std::vector<Delivery>::const_iterator end = current_event->deliveries.end();
+			for ( ; it != end; ++it ) {
+				trace( TRACE_DELIVER_MESSAGE, sync_time, it->msg_id );
+
+				if ( 0 == it->receiver ) {
+					if ( false == payloads_.empty() ) deliverPayload( it->msg_id, it->receiver );
+					continue;
+				}
 
-			// Set output according to event (in case receiver has been defined).
-			if ( 0 != (*current_event_)->receiver ) *(*current_event_)->receiver = (*current_event_)->msg_id;
-
-			runSimulation( syncTime );
-
-			// Get time of next scheduled event.
-			if ( current_event_ != std::prev( event_queue_.end() ) ) {
-				// There is a next event in the schedule --> increment current event and set time of this event as next event time.
-				++current_event_;
-				next_event_time = (*current_event_)->time_stamp;
-				debug_msg << "DOSTEP: set next event time to t = " << next_event_time << std::endl;
-			} else {
-				// There is NO next event in the schedule --> set stop time as next event time.
-				if ( true == getStopTimeDefined() ) {
-					next_event_time = getStopTime(); // Retrieve stop time.
-				} else {
-					next_event_time = std::numeric_limits<fmippReal>::max(); // No stop time defined, use other value.
+				if ( written_receivers_.end() != std::find( written_receivers_.begin(), written_receivers_.end(), it->receiver ) ) {
+					postponed_deliveries_.push_back( *it );
+					continue;
 				}
+
+				*it->receiver = it->msg_id;
+				written_receivers_.push_back( it->receiver );
+
+				if ( false == payloads_.empty() ) deliverPayload( it->msg_id, it->receiver );
 			}
 
-		}
-		else // This synchronization does not coincide with an event in the queue.
-		{
-			// Most likely the FMU is being synchronized because new inputs are available.
-			// Reset outputs and run a new ns-3 simulation.
-			resetIntegerOutputs();
+			// Remove the current event from the queue, its slot is recycled immediately.
+			event_queue_.pop();
+
+			// Re-insert postponed messages, they will be delivered with the next event iteration.
+			for ( it = postponed_deliveries_.begin(); it != postponed_deliveries_.end(); ++it ) {
+				event_queue_.insert( sync_time, it->msg_id, it->receiver );
 
-			runSimulation( syncTime );
+				trace( TRACE_POSTPONE_MESSAGE, sync_time, it->msg_id );
+			}
 		}
 
-		// Reset inputs.
-		resetIntegerInputs();
+		simulate( syncTime );
+	}
+	else // This synchronization does not coincide with an event in the queue.
+	{
+		// Most likely the FMU is being synchronized because new inputs are available.
+		// Reset outputs and run a new ns-3 simulation.
+		resetIntegerOutputs();
+		resetPayloadOutputs();
+
+		simulate( syncTime );
 	}
 
-	debug_msg << "DOSTEP: next event time = " << next_event_time << std::endl;
-	//debug_msg << "DOSTEP: current event time stamp = " << (*current_event_)->time_stamp << std::endl;
-	debug( debug_msg.str() );
+	// Get time of next scheduled event.
+	updateNextEventTime();
 
-	return 0; // No errors, return value 0.
+	// Update lookahead outputs (if enabled).
+	if ( 0 < lookahead_size_ ) updateLookaheadOutputs();
+
+	// Reset inputs.
+	resetIntegerInputs();
+}
+
+
+// Check if any message has been sent, i.e., if any integer input is set.
+bool
+SimpleEventQueueFMUBase::hasNewMessages() const
+{
+	std::vector<fmippInteger*>::const_iterator it = integerInputs_.begin();
+	std::vector<fmippInteger*>::const_iterator end = integerInputs_.begin() + n_message_inputs_;
+	for ( ; it != end; ++it ) if ( 0 != **it ) return true;
+
+	return false;
 }
 
 
 void
 SimpleEventQueueFMUBase::addNewEventForMessage(
+	const fmippReal& msg_receive_time,
+	const MessageID& msg_id,
+	const Receiver& receiver )
+{
+	addNewEvent( toTimeStamp( msg_receive_time ), msg_id, receiver );
+}
+
+
+void
+SimpleEventQueueFMUBase::addNewEventForMessageWithDelay(
+	const Time& delay,
+	const MessageID& msg_id,
+	const Receiver& receiver )
+{
+	// A negative delay indicates that the message has not been received (e.g., the packet has been lost).
+	if ( delay.IsNegative() ) {
+		trace( TRACE_LOST_MESSAGE, sync_time_stamp_, msg_id );
+		return;
+	}
+
+	addNewEvent( addTimeStamps( sync_time_stamp_, delay.GetNanoSeconds() ), msg_id, receiver );
+}
+
+
+void
+SimpleEventQueueFMUBase::addNewEventsForMessages( const std::vector<Message>& messages )
+{
+	if ( true == messages.empty() ) return;
+
+	if ( true == capturing_ ) {
+		std::vector<Message>::const_iterator it;
+		for ( it = messages.begin(); it != messages.end(); ++it ) captureMessage( it->time_stamp, it->msg_id, it->receiver );
+		return;
+	}
+
+	event_queue_.insert( messages );
+
+	// Keep the payloads of the messages until they have been delivered.
+	if ( false == sent_payloads_.empty() ) {
+		std::vector<Message>::const_iterator it;
+		for ( it = messages.begin(); it != messages.end(); ++it ) keepPayload( it->msg_id, it->receiver );
+	}
+
+	trace( TRACE_ADD_EVENTS, sync_time_stamp_, 0, messages.size() );
+
+	if ( event_queue_.top()->time_stamp < next_event_time_stamp_ )
+	{
+		setNextEventTime( event_queue_.top()->time_stamp );
+		trace( TRACE_SET_NEXT_EVENT, next_event_time_stamp_ );
+	}
+}
+
+
+void
+SimpleEventQueueFMUBase::addNewEvent(
 	const TimeStamp& msg_receive_time,
 	const MessageID& msg_id,
 	const Receiver& receiver )
 {
-	bool valid_event = false;
-	Event* evt = 0;
+	if ( true == captureMessage( msg_receive_time, msg_id, receiver ) ) return;
+
+	trace( TRACE_ADD_EVENT, msg_receive_time, msg_id );
+
+	// Insert event into queue. Messages with the same timestamp are delivered with the same event.
+	event_queue_.insert( msg_receive_time, msg_id, receiver );
+
+	// Keep the payload of the message until it has been delivered.
+	if ( false == sent_payloads_.empty() ) keepPayload( msg_id, receiver );
+
+	if ( msg_receive_time < next_event_time_stamp_ )
+	{
+		setNextEventTime( msg_receive_time );
+		trace( TRACE_SET_NEXT_EVENT, msg_receive_time );
+	}
+}
+
+
+// Enable outputs for the next events in the event queue.
+void
+SimpleEventQueueFMUBase::enableLookaheadOutputs( const size_t& n )
+{
+	lookahead_size_ = n;
+	if ( lookahead_size_ > MAX_LOOKAHEAD_SIZE ) lookahead_size_ = MAX_LOOKAHEAD_SIZE;
+}
+
+
+// Enable state snapshots.
+void
+SimpleEventQueueFMUBase::enableStateSnapshots()
+{
+	state_snapshots_enabled_ = true;
+}
+
 
-	std::stringstream debug_msg;
+// There is no default implementation, messages must not be dropped silently.
+void
+SimpleEventQueueFMUBase::simulateMessageGroup( const size_t& group_index,
+	const MessageGroup& group, std::vector<Time>& delays )
+{
+	NS_FATAL_ERROR( "function simulateMessageGroup has to be implemented when using evaluateMessageGroups" );
+}
 
-	do {
-		// Create new event.
-		evt = new Event( msg_receive_time, msg_id, false, receiver );
 
-		debug_msg << "add new evt at t = " << msg_receive_time << " - id = " << msg_id << std::endl;
+namespace {
 
-		// Insert event into queue.
-		std::pair<EventQueue::iterator ,bool> insert_result = event_queue_.insert( evt );
-		valid_event = insert_result.second;
+	// A forked worker process and the pipe it sends its results through.
+	struct Worker {
+		pid_t pid;
+		int fd;
+		size_t group_index;
+	};
 
-		// Delete the event, because it has not been inserted successfully (another event with the same timestamp alreay exists).
-		if ( false == valid_event ) {
-			debug_msg << "veto for event at t = " << msg_receive_time << std::endl;
+	// Write a buffer to a pipe (handles partial writes).
+	bool writeAll( int fd, const char* buffer, size_t size ) {
+		while ( 0 < size ) {
+			ssize_t n = write( fd, buffer, size );
+			if ( 0 >= n ) return false;
+			buffer += n; size -= n;
+		}
+		return true;
+	}
 
-			delete evt;
+	// Read a buffer from a pipe (handles partial reads).
+	bool readAll( int fd, char* buffer, size_t size ) {
+		while ( 0 < size ) {
+			ssize_t n = read( fd, buffer, size );
+			if ( 0 >= n ) return false;
+			buffer += n; size -= n;
 		}
-		else if ( msg_receive_time < next_event_time )
+		return true;
+	}
+}
+
+
+void
+SimpleEventQueueFMUBase::evaluateMessageGroups( const std::vector<MessageGroup>& groups, size_t max_workers )
+{
+	if ( 0 == max_workers ) {
+		long n_cpus = sysconf( _SC_NPROCESSORS_ONLN );
+		max_workers = ( 0 < n_cpus ) ? static_cast<size_t>( n_cpus ) : 1;
+	}
+
+	std::vector<Worker> workers;
+	std::vector<int64_t> delays_ns;
+	size_t next_group = 0;
+
+	while ( ( next_group < groups.size() ) || ( false == workers.empty() ) )
+	{
+		// Start new workers.
+		while ( ( next_group < groups.size() ) && ( workers.size() < max_workers ) )
 		{
-			debug_msg << "set new event as next event at t = " << msg_receive_time << std::endl;
+			int fds[2];
+			if ( 0 != pipe( fds ) ) break;
+
+			pid_t pid = fork();
+
+			if ( 0 == pid ) // This is the worker process.
+			{
+				close( fds[0] );
+
+				std::vector<Time> delays;
+				simulateMessageGroup( next_group, groups[next_group], delays );
+
+				std::vector<int64_t> result( delays.size() );
+				for ( size_t i = 0; i < delays.size(); ++i ) result[i] = delays[i].GetNanoSeconds();
+
+				uint64_t n = result.size();
+				bool ok = writeAll( fds[1], reinterpret_cast<const char*>( &n ), sizeof( n ) ) &&
+					writeAll( fds[1], reinterpret_cast<const char*>( result.data() ), n * sizeof( int64_t ) );
+
+				// Terminate immediately, i.e., without calling destructors or flushing buffers of the parent process.
+				_exit( ( true == ok ) ? 0 : 1 );
+			}
+
+			close( fds[1] );
+
+			if ( 0 > pid ) { // Forking failed.
+				close( fds[0] );
+				break;
+			}
+
+			Worker worker = { pid, fds[0], next_group };
+			workers.push_back( worker );
+			++next_group;
+		}
+
+		if ( true == workers.empty() ) {
+			// No worker could be started (e.g., too many processes).
+			trace( TRACE_WORKER_START_FAILED, sync_time_stamp_ );
+			NS_FATAL_ERROR( "unable to start worker process for message group " << next_group );
+		}
+
+		// Collect the results of the oldest worker.
+		Worker worker = workers.front();
+		workers.erase( workers.begin() );
+
+		const MessageGroup& group = groups[worker.group_index];
+
+		uint64_t n = 0;
+		delays_ns.clear();
+		if ( true == readAll( worker.fd, reinterpret_cast<char*>( &n ), sizeof( n ) ) && ( group.size() == n ) ) {
+			delays_ns.resize( n );
+			if ( false == readAll( worker.fd, reinterpret_cast<char*>( delays_ns.data() ), n * sizeof( int64_t ) ) ) delays_ns.clear();
+		}
+
+		close( worker.fd );
+		waitpid( worker.pid, 0, 0 );
 
-			current_event_ = insert_result.first;
-			next_event_time = msg_receive_time;
+		if ( delays_ns.size() != group.size() ) {
+			trace( TRACE_WORKER_FAILED, sync_time_stamp_, 0, worker.group_index );
+			NS_FATAL_ERROR( "worker process for message group " << worker.group_index << " failed" );
 		}
+
+		for ( size_t i = 0; i < group.size(); ++i )
+			addNewEventForMessageWithDelay( NanoSeconds( delays_ns[i] ), group[i].msg_id, group[i].receiver );
 	}
-	while ( false == valid_event );
+}
+
+
+// Enable the surrogate delay table.
+void
+SimpleEventQueueFMUBase::enableSurrogateTable( const std::string& file_name, const fmippInteger& default_message_size )
+{
+	surrogate_table_file_name_ = file_name;
+	surrogate_default_message_size_ = default_message_size;
+}
+
 
-	debug_msg << "after adding new event: next event time = " << next_event_time << std::endl;
-	//debug_msg << "after adding new event: current event time stamp = " << (*current_event_)->time_stamp << std::endl;
-	debug( debug_msg.str() );
+fmippInteger
+SimpleEventQueueFMUBase::getMessageSize( const fmippInteger& default_size ) const
+{
+	return ( 0 < message_size_ ) ? message_size_ : default_size;
+}
+
+
+fmippInteger
+SimpleEventQueueFMUBase::getMessageSize( const MessageID& msg_id, const fmippInteger& default_size ) const
+{
+	fmippInteger size = getMessageSize( default_size );
+
+	std::unordered_map<MessageID, Payload>::const_iterator it = sent_payloads_.find( msg_id );
+	if ( sent_payloads_.end() == it ) return size;
+
+	if ( true == it->second.has_real ) size += sizeof( fmippReal );
+	if ( true == it->second.has_bytes ) size += static_cast<fmippInteger>( it->second.bytes.size() );
+
+	return size;
+}
+
+
+SimpleEventQueueFMUBase::PayloadBinding&
+SimpleEventQueueFMUBase::getPayloadBinding( std::vector<PayloadBinding>& bindings, fmippInteger& message )
+{
+	std::vector<PayloadBinding>::iterator it;
+	for ( it = bindings.begin(); it != bindings.end(); ++it )
+		if ( &message == it->message ) return *it;
+
+	PayloadBinding binding = { &message, 0, 0 };
+	bindings.push_back( binding );
+	return bindings.back();
 }
 
 
-// Send debug message.
 void
-SimpleEventQueueFMUBase::debug( const std::string& msg ) const
+SimpleEventQueueFMUBase::addPayloadInput( fmippInteger& msg_input, fmippReal& payload_input )
 {
-	if ( true == loggingOn() ) (*debug_) << msg << std::endl;
+	getPayloadBinding( payload_inputs_, msg_input ).real = &payload_input;
 }
 
 
-// This function resets all integer inputs (i.e., input messages).
 void
-SimpleEventQueueFMUBase::resetIntegerInputs()
+SimpleEventQueueFMUBase::addPayloadInput( fmippInteger& msg_input, std::string& payload_input )
 {
-	std::vector<fmippInteger*>::iterator it = integerInputs_.begin();
-	std::vector<fmippInteger*>::iterator end = integerInputs_.end();
-	for ( ; it != end; ++it ) **it = 0;
+	getPayloadBinding( payload_inputs_, msg_input ).bytes = &payload_input;
 }
 
 
-// This function resets all integer outputs (i.e., output messages).
 void
-SimpleEventQueueFMUBase::resetIntegerOutputs()
+SimpleEventQueueFMUBase::addPayloadOutput( fmippInteger& msg_output, fmippReal& payload_output )
 {
-	std::vector<fmippInteger*>::iterator it = integerOutputs_.begin();
-	std::vector<fmippInteger*>::iterator end = integerOutputs_.end();
-	for ( ; it != end; ++it ) **it = 0;
+	getPayloadBinding( payload_outputs_, msg_output ).real = &payload_output;
+}
+
+
+void
+SimpleEventQueueFMUBase::addPayloadOutput( fmippInteger& msg_output, std::string& payload_output )
+{
+	getPayloadBinding( payload_outputs_, msg_output ).bytes = &payload_output;
+}
+
+
+// Messages sent at the same time are identified by their ID, i.e., message IDs sent at the same time
+// are expected to be unique. Messages in flight are identified by their ID and receiver.
+void
+SimpleEventQueueFMUBase::attachPayloads()
+{
+	std::vector<PayloadBinding>::const_iterator it;
+	for ( it = payload_inputs_.begin(); it != payload_inputs_.end(); ++it )
+	{
+		MessageID msg_id = *it->message;
+		if ( 0 == msg_id ) continue;
+
+		Payload& payload = sent_payloads_[msg_id];
+		payload.has_real = ( 0 != it->real );
+		payload.real = ( 0 != it->real ) ? *it->real : 0.;
+		payload.has_bytes = ( 0 != it->bytes );
+		if ( 0 != it->bytes ) payload.bytes = *it->bytes; else payload.bytes.clear();
+		payload.pending = 0;
+	}
+}
+
+
+void
+SimpleEventQueueFMUBase::keepPayload( const MessageID& msg_id, const Receiver& receiver )
+{
+	std::unordered_map<MessageID, Payload>::const_iterator it_sent = sent_payloads_.find( msg_id );
+	if ( sent_payloads_.end() == it_sent ) return;
+
+	// In case a message with the same ID is already in flight to this receiver, both deliveries receive the new payload.
+	Payload& payload = payloads_[PayloadKey( receiver, msg_id )];
+	size_t pending = payload.pending;
+	payload = it_sent->second;
+	payload.pending = pending + 1;
+}
+
+
+void
+SimpleEventQueueFMUBase::releasePayloads()
+{
+	sent_payloads_.clear();
+}
+
+
+void
+SimpleEventQueueFMUBase::deliverPayload( const MessageID& msg_id, const Receiver& receiver )
+{
+	std::map<PayloadKey, Payload>::iterator it_payload = payloads_.find( PayloadKey( receiver, msg_id ) );
+	if ( payloads_.end() == it_payload ) return;
+
+	Payload& payload = it_payload->second;
+
+	std::vector<PayloadBinding>::const_iterator it;
+	for ( it = payload_outputs_.begin(); it != payload_outputs_.end(); ++it )
+	{
+		if ( receiver != it->message ) continue;
+
+		if ( ( 0 != it->real ) && ( true == payload.has_real ) ) *it->real = payload.real;
+		if ( ( 0 != it->bytes ) && ( true == payload.has_bytes ) ) *it->bytes = payload.bytes;
+		break;
+	}
+
+	// The payload is removed after its last delivery.
+	if ( 0 < payload.pending ) --payload.pending;
+	if ( 0 == payload.pending ) payloads_.erase( it_payload );
+}
+
+
+void
+SimpleEventQueueFMUBase::resetPayloadOutputs()
+{
+	std::vector<PayloadBinding>::const_iterator it;
+	for ( it = payload_outputs_.begin(); it != payload_outputs_.end(); ++it ) {
+		if ( 0 != it->real ) *it->real = 0.;
+		if ( 0 != it->bytes ) it->bytes->clear();
+	}
+}
+
+
+bool
+SimpleEventQueueFMUBase::isVariableNamesExport( int argc, const char* argv[] )
+{
+	for ( int i = 1; i < argc; ++i )
+		if ( 0 == std::strcmp( argv[i], "--only-write-variable-names-json" ) ) return true;
+	return false;
+}
+
+
+namespace {
+
+	// Write a list of variable names as JSON array.
+	void writeNames( std::ostream& json, const char* label, const std::vector<std::string>& names )
+	{
+		json << "\t\"" << label << "\": [";
+		for ( size_t i = 0; i < names.size(); ++i ) json << ( ( 0 == i ) ? " \"" : ", \"" ) << names[i] << "\"";
+		json << " ],\n";
+	}
+}
+
+
+int
+SimpleEventQueueFMUBase::writeVariableNames( int, const char* argv[] )
+{
+	// Define inputs/outputs/parameters.
+	initializeScalarVariables();
+
+	std::ofstream json( ( std::string( argv[0] ) + ".json" ).c_str() );
+
+	json << "{\n";
+	writeNames( json, "RealInputs", realInputNames_ );
+	writeNames( json, "IntegerInputs", integerInputNames_ );
+	writeNames( json, "BooleanInputs", booleanInputNames_ );
+	writeNames( json, "StringInputs", stringInputNames_ );
+	writeNames( json, "RealOutputs", realOutputNames_ );
+	writeNames( json, "IntegerOutputs", integerOutputNames_ );
+	writeNames( json, "BooleanOutputs", booleanOutputNames_ );
+	writeNames( json, "StringOutputs", stringOutputNames_ );
+	writeNames( json, "RealParameters", realParameterNames_ );
+	writeNames( json, "IntegerParameters", integerParameterNames_ );
+	writeNames( json, "BooleanParameters", booleanParameterNames_ );
+	writeNames( json, "StringParameters", stringParameterNames_ );
+	json << "\t\"MessageInputs\": " << n_message_inputs_ << ",\n";
+	json << "\t\"MessageOutputs\": " << n_message_outputs_ << "\n";
+	json << "}\n";
+
+	json.close();
+	return ( true == json.fail() ) ? -1 : 0;
+}
+
+
+bool
+SimpleEventQueueFMUBase::isSurrogateTableGeneration( int argc, const char* argv[] )
+{
+	for ( int i = 1; i < argc; ++i )
+		if ( 0 == std::strncmp( argv[i], "--generate-surrogate-table=", 27 ) ) return true;
+	return false;
+}
+
+
+namespace {
+
+	// Set the value of a parameter from a string (returns false if there is no parameter with this name).
+	template<typename T>
+	bool setParameter( const std::vector<std::string>& names, std::vector<T*>& params,
+		const std::string& name, const std::string& value )
+	{
+		for ( size_t i = 0; i < names.size(); ++i ) {
+			if ( names[i] != name ) continue;
+			std::istringstream input( value );
+			input >> std::boolalpha >> *params[i];
+			return true;
+		}
+		return false;
+	}
+
+	// Set all parameters to zero.
+	template<typename T>
+	void resetParameters( std::vector<T*>& params ) {
+		for ( size_t i = 0; i < params.size(); ++i ) *params[i] = T();
+	}
+}
+
+
+int
+SimpleEventQueueFMUBase::generateSurrogateTable( int argc, const char* argv[] )
+{
+	// Define inputs/outputs/parameters.
+	initializeScalarVariables();
+
+	resetParameters( realParameters_ );
+	resetParameters( integerParameters_ );
+	resetParameters( booleanParameters_ );
+	resetParameters( stringParameters_ );
+
+	std::string file_name;
+	unsigned int n_seeds = 10;
+	unsigned int seed_offset = 0;
+	std::vector<fmippInteger> message_sizes;
+
+	// Parse command line arguments.
+	for ( int i = 1; i < argc; ++i )
+	{
+		std::string arg( argv[i] );
+		size_t pos = arg.find( '=' );
+		if ( std::string::npos == pos ) continue;
+
+		std::string name = arg.substr( 0, pos );
+		std::string value = arg.substr( pos + 1 );
+
+		if ( "--generate-surrogate-table" == name ) {
+			file_name = value;
+		} else if ( "--surrogate-seeds" == name ) {
+			n_seeds = std::strtoul( value.c_str(), 0, 10 );
+		} else if ( "--surrogate-seed-offset" == name ) {
+			seed_offset = std::strtoul( value.c_str(), 0, 10 );
+		} else if ( "--surrogate-message-sizes" == name ) {
+			std::istringstream sizes( value );
+			std::string size;
+			while ( std::getline( sizes, size, ',' ) ) message_sizes.push_back( std::atoi( size.c_str() ) );
+		} else if ( false == setParameter( realParameterNames_, realParameters_, name, value ) &&
+			false == setParameter( integerParameterNames_, integerParameters_, name, value ) &&
+			false == setParameter( booleanParameterNames_, booleanParameters_, name, value ) &&
+			false == setParameter( stringParameterNames_, stringParameters_, name, value ) ) {
+			std::cerr << "[WARNING] unknown parameter: " << name << std::endl;
+		}
+	}
+
+	if ( 1 > random_seed ) random_seed = 1;
+	if ( true == message_sizes.empty() ) message_sizes.push_back( 0 );
+
+	SurrogateDelayTable table;
+	std::vector< std::vector<int64_t> > delays( n_message_outputs_ );
+	std::vector<bool> received( n_message_outputs_ );
+
+	// Record messages instead of adding them to the event queue.
+	capturing_ = true;
+	sync_time_stamp_ = 0;
+
+	for ( size_t sender = 0; sender < n_message_inputs_; ++sender )
+	{
+		std::vector<fmippInteger>::const_iterator it_size;
+		for ( it_size = message_sizes.begin(); it_size != message_sizes.end(); ++it_size )
+		{
+			message_size_ = *it_size;
+
+			for ( size_t r = 0; r < n_message_outputs_; ++r ) { delays[r].clear(); received[r] = false; }
+
+			for ( unsigned int seed = 0; seed < n_seeds; ++seed )
+			{
+				// Send a single message (with ID 1) from this sender.
+				resetIntegerInputs();
+				resetIntegerOutputs();
+				*integerInputs_[sender] = 1;
+
+				RngSeedManager::SetSeed( random_seed );
+				RngSeedManager::SetRun( seed_offset + seed + 1 );
+
+				captured_.clear();
+				runSimulation( 0. );
+
+				// Retrieve the delays for all receivers (negative if the message has not been received).
+				for ( size_t r = 0; r < n_message_outputs_; ++r )
+				{
+					int64_t delay = -1;
+
+					std::vector<Message>::const_iterator it;
+					for ( it = captured_.begin(); it != captured_.end(); ++it ) {
+						if ( ( integerOutputs_[r] != it->receiver ) || ( 1 != it->msg_id ) ) continue;
+						delay = it->time_stamp;
+						received[r] = true;
+						break;
+					}
+
+					delays[r].push_back( delay );
+				}
+			}
+
+			// Only receivers that received the message at least once are added to the table.
+			for ( size_t r = 0; r < n_message_outputs_; ++r ) {
+				if ( false == received[r] ) continue;
+
+				std::vector<int64_t>::const_iterator it;
+				for ( it = delays[r].begin(); it != delays[r].end(); ++it )
+					table.addSample( static_cast<int32_t>( sender ), getMessageSize( surrogate_default_message_size_ ), static_cast<int32_t>( r ), *it );
+			}
+		}
+	}
+
+	capturing_ = false;
+
+	if ( false == table.write( file_name ) ) {
+		std::cerr << "[ERROR] failed to write surrogate delay table: " << file_name << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+
+// Either run an ns-3 simulation or sample the delays from the surrogate delay table.
+void
+SimpleEventQueueFMUBase::simulate( const fmippReal& sync_time )
+{
+	if ( false == payload_inputs_.empty() ) attachPayloads();
+
+	// The random generator seed is global, other backend instances hosted by the same process may have changed it.
+	if ( true == BackEndZygote::isSharedProcess() ) RngSeedManager::SetSeed( random_seed );
+
+	if ( true == surrogate_table_.isOpen() ) {
+		sampleFromSurrogateTable();
+	} else {
+		runSimulation( sync_time );
+	}
+
+	if ( false == sent_payloads_.empty() ) releasePayloads();
+}
+
+
+void
+SimpleEventQueueFMUBase::sampleFromSurrogateTable()
+{
+	for ( size_t sender = 0; sender < n_message_inputs_; ++sender )
+	{
+		MessageID msg_id = *integerInputs_[sender];
+		if ( 0 == msg_id ) continue;
+
+		// Look up the entries for the actual size of the message (including its payload).
+		int32_t size = static_cast<int32_t>( getMessageSize( msg_id, surrogate_default_message_size_ ) );
+
+		const SurrogateDelayTable::Entry* entry = 0;
+		size_t n_entries = surrogate_table_.find( static_cast<int32_t>( sender ), size, entry );
+
+		for ( ; 0 < n_entries; --n_entries, ++entry )
+		{
+			if ( ( 0 == entry->n_samples ) || ( static_cast<size_t>( entry->receiver ) >= n_message_outputs_ ) ) continue;
+
+			// Draw a sample from the delay distribution (negative delays indicate lost messages).
+			int64_t delay = surrogate_table_.samples( *entry )[surrogate_rng_() % entry->n_samples];
+			addNewEventForMessageWithDelay( NanoSeconds( delay ), msg_id, integerOutputs_[entry->receiver] );
+		}
+	}
+}
+
+
+bool
+SimpleEventQueueFMUBase::captureMessage( const TimeStamp& msg_receive_time, const MessageID& msg_id, const Receiver& receiver )
+{
+	if ( false == capturing_ ) return false;
+
+	captured_.push_back( Message( msg_receive_time - sync_time_stamp_, msg_id, receiver ) );
+	return true;
+}
+
+
+// Enable the delay cache.
+void
+SimpleEventQueueFMUBase::enableDelayCache( const std::string& file_name )
+{
+	delay_cache_enabled_ = true;
+	delay_cache_file_name_ = file_name;
+}
+
+
+// Create a key for the delay cache, containing the values of all parameters.
+DelayCacheKey
+SimpleEventQueueFMUBase::createDelayCacheKey() const
+{
+	DelayCacheKey key;
+
+	std::vector<fmippReal*>::const_iterator it_real = realParameters_.begin();
+	for ( ; it_real != realParameters_.end(); ++it_real ) key.add( **it_real );
+
+	std::vector<fmippInteger*>::const_iterator it_int = integerParameters_.begin();
+	for ( ; it_int != integerParameters_.end(); ++it_int ) key.add( **it_int );
+
+	std::vector<fmippBoolean*>::const_iterator it_bool = booleanParameters_.begin();
+	for ( ; it_bool != booleanParameters_.end(); ++it_bool ) key.add( **it_bool );
+
+	std::vector<std::string*>::const_iterator it_str = stringParameters_.begin();
+	for ( ; it_str != stringParameters_.end(); ++it_str ) key.add( **it_str );
+
+	// Add the run number of the ns-3 random generator.
+	key.add( static_cast<fmippInteger>( RngSeedManager::GetRun() ) );
+
+	return key;
+}
+
+
+bool
+SimpleEventQueueFMUBase::lookupDelay( const DelayCacheKey& key, Time& delay ) const
+{
+	if ( false == delay_cache_enabled_ ) return false;
+
+	int64_t delay_ns;
+	if ( false == delay_cache_.lookup( key, delay_ns ) ) return false;
+
+	delay = NanoSeconds( delay_ns );
+	return true;
+}
+
+
+void
+SimpleEventQueueFMUBase::storeDelay( const DelayCacheKey& key, const Time& delay )
+{
+	if ( true == delay_cache_enabled_ ) delay_cache_.insert( key, delay.GetNanoSeconds() );
+}
+
+
+// Enable checkpoints.
+void
+SimpleEventQueueFMUBase::enableCheckpoints( const std::string& file_name )
+{
+	checkpoints_enabled_ = true;
+	checkpoint_file_name_ = file_name;
+}
+
+
+// By default, the inheriting application has no state of its own.
+void
+SimpleEventQueueFMUBase::writeCheckpoint( CheckpointWriter& checkpoint ) const {}
+
+
+bool
+SimpleEventQueueFMUBase::readCheckpoint( CheckpointReader& checkpoint ) { return true; }
+
+
+// Write the checkpoint. The layout has to match function 'resumeFromCheckpoint'.
+void
+SimpleEventQueueFMUBase::writeCheckpointFile( const TimeStamp& time )
+{
+	checkpoint_.clear();
+	checkpoint_.write( time );
+
+	// Parameters (a checkpoint is only used with the same parameter values).
+	checkpoint_.write( static_cast<uint64_t>( realParameters_.size() ) );
+	for ( size_t i = 0; i < realParameters_.size(); ++i ) checkpoint_.write( *realParameters_[i] );
+	checkpoint_.write( static_cast<uint64_t>( integerParameters_.size() ) );
+	for ( size_t i = 0; i < integerParameters_.size(); ++i ) checkpoint_.write( *integerParameters_[i] );
+	checkpoint_.write( static_cast<uint64_t>( booleanParameters_.size() ) );
+	for ( size_t i = 0; i < booleanParameters_.size(); ++i ) checkpoint_.write( *booleanParameters_[i] );
+	checkpoint_.write( static_cast<uint64_t>( stringParameters_.size() ) );
+	for ( size_t i = 0; i < stringParameters_.size(); ++i ) checkpoint_.write( *stringParameters_[i] );
+
+	// Random number generators (the state of the surrogate table's generator is only stored if it is used).
+	std::ostringstream surrogate_rng;
+	if ( true == surrogate_table_.isOpen() ) surrogate_rng << surrogate_rng_;
+	checkpoint_.write( static_cast<uint64_t>( RngSeedManager::GetRun() ) ).write( surrogate_rng.str() );
+
+	// Synchronization state and default events.
+	checkpoint_.write( sync_time_stamp_ ).write( next_event_time_stamp_ ).write( last_successful_time );
+	checkpoint_.write( default_event_timer_.next() ).write( default_event_timer_.step() );
+
+	// Pending events (receivers are identified by their index in the list of integer outputs).
+	std::vector<const Event*> events;
+	event_queue_.peek( event_queue_.size(), events );
+
+	checkpoint_.write( static_cast<uint64_t>( events.size() ) );
+	std::vector<const Event*>::const_iterator it_evt;
+	for ( it_evt = events.begin(); it_evt != events.end(); ++it_evt )
+	{
+		checkpoint_.write( (*it_evt)->time_stamp ).write( static_cast<uint64_t>( (*it_evt)->deliveries.size() ) );
+
+		std::vector<Delivery>::const_iterator it = (*it_evt)->deliveries.begin();
+		for ( ; it != (*it_evt)->deliveries.end(); ++it ) checkpoint_.write( it->msg_id ).write( getReceiverIndex( it->receiver ) );
+	}
+
+	// Message outputs (still set in fused step mode) and payloads.
+	for ( size_t i = 0; i < n_message_outputs_; ++i ) checkpoint_.write( *integerOutputs_[i] );
+
+	std::vector<PayloadBinding>::const_iterator it_out;
+	for ( it_out = payload_outputs_.begin(); it_out != payload_outputs_.end(); ++it_out ) {
+		if ( 0 != it_out->real ) checkpoint_.write( *it_out->real );
+		if ( 0 != it_out->bytes ) checkpoint_.write( *it_out->bytes );
+	}
+
+	checkpoint_.write( static_cast<uint64_t>( payloads_.size() ) );
+	std::map<PayloadKey, Payload>::const_iterator it_payload;
+	for ( it_payload = payloads_.begin(); it_payload != payloads_.end(); ++it_payload ) {
+		const Payload& payload = it_payload->second;
+		checkpoint_.write( getReceiverIndex( it_payload->first.first ) ).write( it_payload->first.second );
+		checkpoint_.write( payload.has_real ).write( payload.real );
+		checkpoint_.write( payload.has_bytes ).write( payload.bytes ).write( static_cast<uint64_t>( payload.pending ) );
+	}
+
+	// State of the inheriting application.
+	writeCheckpoint( checkpoint_ );
+
+	bool ok = checkpoint_.save( checkpoint_file_name_ );
+	trace( TRACE_CHECKPOINT_WRITTEN, time, 0, ( true == ok ) ? checkpoint_.size() : 0 );
+
+	next_checkpoint_time_stamp_ = addTimeStamps( time, toTimeStamp( checkpoint_interval ) );
+}
+
+
+// Compare a parameter value stored in a checkpoint with the current value.
+#define CHECKPOINT_READ_PARAMETERS( type, params, skip ) \
+	if ( ( false == checkpoint.read( n ) ) || ( params.size() != n ) ) return false; \
+	for ( size_t i = 0; i < n; ++i ) { \
+		type val; \
+		if ( ( false == checkpoint.read( val ) ) || ( ( skip != params[i] ) && ( *params[i] != val ) ) ) return false; \
+	}
+
+// Restore the state from the checkpoint. The layout has to match function 'writeCheckpointFile'.
+bool
+SimpleEventQueueFMUBase::resumeFromCheckpoint()
+{
+	TimeStamp start_time = toTimeStamp( getStartTime() );
+
+	if ( 0. < checkpoint_interval ) next_checkpoint_time_stamp_ = addTimeStamps( start_time, toTimeStamp( checkpoint_interval ) );
+
+	// Start from scratch if there is no checkpoint.
+	if ( 0 != access( checkpoint_file_name_.c_str(), F_OK ) ) return true;
+
+	CheckpointReader checkpoint;
+	if ( false == checkpoint.load( checkpoint_file_name_ ) ) return false;
+
+	TimeStamp time;
+	if ( ( false == checkpoint.read( time ) ) || ( time < start_time ) ) return false;
+
+	// Parameters have to match (except for the checkpoint interval).
+	uint64_t n;
+	CHECKPOINT_READ_PARAMETERS( fmippReal, realParameters_, &checkpoint_interval )
+	CHECKPOINT_READ_PARAMETERS( fmippInteger, integerParameters_, 0 )
+	CHECKPOINT_READ_PARAMETERS( fmippBoolean, booleanParameters_, 0 )
+	CHECKPOINT_READ_PARAMETERS( std::string, stringParameters_, 0 )
+
+	// Random number generators.
+	uint64_t run;
+	std::string surrogate_rng;
+	if ( ( false == checkpoint.read( run ) ) || ( false == checkpoint.read( surrogate_rng ) ) ) return false;
+
+	RngSeedManager::SetRun( run );
+	if ( false == surrogate_rng.empty() ) {
+		std::istringstream surrogate_rng_state( surrogate_rng );
+		surrogate_rng_state >> surrogate_rng_;
+	}
+
+	// Synchronization state and default events.
+	TimeStamp next_event_time_stamp;
+	TimeStamp next_default_event;
+	TimeStamp default_event_step;
+	checkpoint.read( sync_time_stamp_ );
+	checkpoint.read( next_event_time_stamp );
+	checkpoint.read( last_successful_time );
+	checkpoint.read( next_default_event );
+	checkpoint.read( default_event_step );
+
+	default_event_timer_.start( next_default_event, default_event_step );
+	setNextEventTime( next_event_time_stamp );
+
+	// Pending events.
+	std::vector<Message> messages;
+	uint64_t n_events = 0;
+	checkpoint.read( n_events );
+	for ( uint64_t e = 0; ( e < n_events ) && ( true == checkpoint.good() ); ++e )
+	{
+		TimeStamp time_stamp;
+		uint64_t n_deliveries = 0;
+		checkpoint.read( time_stamp );
+		checkpoint.read( n_deliveries );
+
+		for ( uint64_t d = 0; ( d < n_deliveries ) && ( true == checkpoint.good() ); ++d )
+		{
+			MessageID msg_id;
+			fmippInteger receiver;
+			checkpoint.read( msg_id );
+			if ( ( false == checkpoint.read( receiver ) ) || ( 0 > receiver ) || ( n_message_outputs_ < static_cast<size_t>( receiver ) ) ) return false;
+
+			messages.push_back( Message( time_stamp, msg_id, ( 0 == receiver ) ? 0 : integerOutputs_[receiver - 1] ) );
+		}
+	}
+
+	event_queue_.insert( messages );
+
+	// Message outputs and payloads.
+	for ( size_t i = 0; i < n_message_outputs_; ++i ) checkpoint.read( *integerOutputs_[i] );
+
+	std::vector<PayloadBinding>::const_iterator it_out;
+	for ( it_out = payload_outputs_.begin(); it_out != payload_outputs_.end(); ++it_out ) {
+		if ( 0 != it_out->real ) checkpoint.read( *it_out->real );
+		if ( 0 != it_out->bytes ) checkpoint.read( *it_out->bytes );
+	}
+
+	uint64_t n_payloads = 0;
+	checkpoint.read( n_payloads );
+	for ( uint64_t i = 0; ( i < n_payloads ) && ( true == checkpoint.good() ); ++i )
+	{
+		fmippInteger receiver;
+		MessageID msg_id;
+		uint64_t pending;
+		if ( ( false == checkpoint.read( receiver ) ) || ( 0 > receiver ) || ( n_message_outputs_ < static_cast<size_t>( receiver ) ) ) return false;
+		checkpoint.read( msg_id );
+
+		Payload& payload = payloads_[PayloadKey( ( 0 == receiver ) ? 0 : integerOutputs_[receiver - 1], msg_id )];
+		checkpoint.read( payload.has_real );
+		checkpoint.read( payload.real );
+		checkpoint.read( payload.has_bytes );
+		checkpoint.read( payload.bytes );
+		checkpoint.read( pending );
+		payload.pending = static_cast<size_t>( pending );
+	}
+
+	// State of the inheriting application.
+	if ( ( false == checkpoint.good() ) || ( false == readCheckpoint( checkpoint ) ) || ( false == checkpoint.good() ) ) return false;
+
+	if ( 0 < lookahead_size_ ) updateLookaheadOutputs();
+
+	if ( 0. < checkpoint_interval ) next_checkpoint_time_stamp_ = addTimeStamps( time, toTimeStamp( checkpoint_interval ) );
+
+	trace( TRACE_CHECKPOINT_RESUMED, time );
+
+	return true;
+}
+
+#undef CHECKPOINT_READ_PARAMETERS
+
+
+fmippReal
+SimpleEventQueueFMUBase::getStartTime() const
+{
+	return ( 0 != in_process_ ) ? in_process_->start_time : getCurrentCommunicationPoint();
+}
+
+
+// Returns false if no stop time is defined.
+bool
+SimpleEventQueueFMUBase::getStopTimeIfDefined( fmippReal& stop_time ) const
+{
+	if ( 0 != in_process_ ) {
+		stop_time = in_process_->stop_time;
+		return in_process_->stop_time_defined;
+	}
+
+	stop_time = getStopTime();
+	return getStopTimeDefined();
+}
+
+
+bool
+SimpleEventQueueFMUBase::isLoggingOn() const
+{
+	return ( 0 != in_process_ ) ? in_process_->logging_on : loggingOn();
+}
+
+
+void
+SimpleEventQueueFMUBase::updateTrace( bool append )
+{
+	if ( ( true == isLoggingOn() ) && ( 0 == trace_ ) ) {
+		trace_ = new EventTrace;
+		if ( false == trace_->open( TRACE_FILE_NAME, append ) ) {
+			delete trace_;
+			trace_ = 0;
+		}
+	} else if ( ( false == isLoggingOn() ) && ( 0 != trace_ ) ) {
+		delete trace_;
+		trace_ = 0;
+	}
+}
+
+
+// This function resets all integer inputs (i.e., input messages).
+void
+SimpleEventQueueFMUBase::resetIntegerInputs()
+{
+	std::vector<fmippInteger*>::iterator it = integerInputs_.begin();
+	std::vector<fmippInteger*>::iterator end = integerInputs_.end();
+	for ( ; it != end; ++it ) **it = 0;
+}
+
+
+// This function resets all integer outputs (i.e., output messages).
+void
+SimpleEventQueueFMUBase::resetIntegerOutputs()
+{
+	// Only outputs associated to messages are reset (not the lookahead outputs).
+	std::vector<fmippInteger*>::iterator it = integerOutputs_.begin();
+	std::vector<fmippInteger*>::iterator end = integerOutputs_.begin() + n_message_outputs_;
+	for ( ; it != end; ++it ) **it = 0;
+}
+
+
+// This function sets the next event time according to the event queue and the default events.
+void
+SimpleEventQueueFMUBase::updateNextEventTime()
+{
+	// Merge the next message event with the next default event.
+	TimeStamp next_event = default_event_timer_.next();
+	if ( false == event_queue_.empty() && event_queue_.top()->time_stamp < next_event ) next_event = event_queue_.top()->time_stamp;
+
+	if ( TIME_STAMP_MAX != next_event ) {
+		// There is a next event in the schedule --> set time of this event as next event time.
+		setNextEventTime( next_event );
+	} else {
+		// There is NO next event in the schedule --> set stop time as next event time.
+		fmippReal stop_time;
+		if ( true == getStopTimeIfDefined( stop_time ) ) {
+			setNextEventTime( toTimeStamp( stop_time ) ); // Retrieve stop time.
+		} else {
+			setNextEventTime( TIME_STAMP_MAX ); // No stop time defined, use other value.
+		}
+	}
+}
+
+
+// This function signals the frontend that the step has returned early at the next event time. The
+// event itself is handled by the next event iteration (or right away in fused step mode).
+void
+SimpleEventQueueFMUBase::discardStep( const TimeStamp& requested_sync_time )
+{
+	trace( TRACE_EARLY_RETURN, next_event_time_stamp_, 0, requested_sync_time );
+
+	// When running in-process, the step status is retrieved by class 'InProcessBackEnd'.
+	step_discarded_ = true;
+	if ( 0 == in_process_ ) rejectStep();
+}
+
+
+// This function sets the next event time (internal timestamp and FMI output variable).
+void
+SimpleEventQueueFMUBase::setNextEventTime( const TimeStamp& t )
+{
+	next_event_time_stamp_ = t;
+	next_event_time = toSeconds( t );
+}
+
+
+// This function sets the lookahead outputs according to the next message deliveries in the event queue.
+void
+SimpleEventQueueFMUBase::updateLookaheadOutputs()
+{
+	event_queue_.peek( lookahead_size_, lookahead_events_ );
+
+	size_t i = 0;
+	std::vector<const Event*>::const_iterator it_evt = lookahead_events_.begin();
+	for ( ; ( it_evt != lookahead_events_.end() ) && ( i < lookahead_size_ ); ++it_evt )
+	{
+		std::vector<Delivery>::const_iterator it = (*it_evt)->deliveries.begin();
+		std::vector<Delivery>::const_iterator end = (*it_evt)->deliveries.end();
+		for ( ; ( it != end ) && ( i < lookahead_size_ ); ++it, ++i )
+		{
+			lookahead_times_[i] = toSeconds( (*it_evt)->time_stamp );
+
+			lookahead_receivers_[i] = getReceiverIndex( it->receiver );
+		}
+	}
+
+	// No more pending messages.
+	for ( ; i < lookahead_size_; ++i ) {
+		lookahead_times_[i] = std::numeric_limits<fmippReal>::max();
+		lookahead_receivers_[i] = 0;
+	}
+
+	pending_events = static_cast<fmippInteger>( event_queue_.deliveries() );
+}
+
+
+// Receivers are identified by their (1-based) index in the list of integer outputs.
+fmippInteger
+SimpleEventQueueFMUBase::getReceiverIndex( const Receiver& receiver ) const
+{
+	std::vector<fmippInteger*>::const_iterator it_out =
+		std::find( integerOutputs_.begin(), integerOutputs_.begin() + n_message_outputs_, receiver );
+	return ( integerOutputs_.begin() + n_message_outputs_ == it_out ) ?
+		0 : static_cast<fmippInteger>( it_out - integerOutputs_.begin() + 1 );
+}
+
+
+void
+SimpleEventQueueFMUBase::initializeStateSnapshotVariables()
+{
+	addIntegerInput( save_state );
+	addIntegerInput( restore_state );
+	addIntegerInput( release_state );
+	addIntegerOutput( saved_state );
+}
+
+
+// Apply the state snapshot commands. Commands set with a time advance are ignored (like messages
+// sent with a time advance, unless in fused step mode).
+bool
+SimpleEventQueueFMUBase::applyStateCommands( const fmippReal& syncTime, const fmippReal& lastSyncTime )
+{
+	if ( ( 0 == save_state ) && ( 0 == restore_state ) && ( 0 == release_state ) ) return false;
+
+	TimeStamp sync_time = toTimeStamp( syncTime );
+
+	if ( sync_time != toTimeStamp( lastSyncTime ) ) {
+		save_state = restore_state = release_state = 0;
+		return false;
+	}
+
+	// Snapshots fork the backend process, which is not possible for backends sharing a process with others.
+	bool available = ( 0 == in_process_ ) && ( false == BackEndZygote::isSharedProcess() );
+
+	if ( 0 != release_state ) {
+		bool released = ( true == available ) && ( true == StateSnapshots::release( release_state ) );
+		trace( ( true == released ) ? TRACE_STATE_RELEASED : TRACE_STATE_RELEASE_FAILED, sync_time, 0, release_state );
+	}
+
+	if ( 0 != save_state ) {
+		// Only the calling thread is copied when forking, hence the background thread of the trace is stopped.
+		if ( 0 != trace_ ) trace_->close();
+
+		bool restored = false;
+		saved_state = ( true == available ) ? StateSnapshots::save( restored ) : 0;
+
+		if ( 0 != trace_ ) trace_->open( TRACE_FILE_NAME, true );
+
+		if ( true == restored ) {
+			// This is a copy of the snapshot, which replaces the process that has requested to restore it.
+			// The outputs are those of the saved state, output 'last_successful_time' tells its time.
+			trace( TRACE_STATE_RESTORED, sync_time_stamp_, 0, saved_state );
+			save_state = restore_state = release_state = 0;
+			return true;
+		}
+
+		trace( TRACE_STATE_SAVED, sync_time, 0, saved_state );
+	}
+
+	if ( 0 != restore_state ) {
+		// This function only returns in case the snapshot could not be restored (this process terminates
+		// otherwise, hence the remaining trace records are written beforehand).
+		if ( true == available ) {
+			if ( 0 != trace_ ) trace_->close();
+			StateSnapshots::restore( restore_state );
+			if ( 0 != trace_ ) trace_->open( TRACE_FILE_NAME, true );
+		}
+
+		trace( TRACE_STATE_RESTORE_FAILED, sync_time, 0, restore_state );
+		saved_state = 0;
+	}
+
+	save_state = restore_state = release_state = 0;
+	return true;
 }
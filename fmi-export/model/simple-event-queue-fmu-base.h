@@ -22,40 +22,26 @@
 
 
 #include <fstream>
-#include <set>
+#include <vector>
+#include <string>
+#include <random>
+#include <unordered_map>
+#include <map>
+#include <utility>
 
 
+// ns-3 includes.
+#include "ns3/nstime.h"
+
 // FMI++ includes.
 #include "export/include/BackEndApplicationBase.h"
 
-
-namespace Ns3FMUBackendEventQueue
-{
-	typedef fmippReal TimeStamp;
-	typedef fmippInteger MessageID;
-	typedef fmippInteger* Receiver;
-
-	struct Event {
-
-		TimeStamp time_stamp; // Each event is associated with a timestamp.
-		MessageID msg_id; // Each event is associated with a message ID (can be 0).
-		bool default_event; // The FMU schedules 'default events' at regular time intervals.
-		Receiver receiver; // Each message ID is associated to an output variable (can be 0).
-
-		// Struct constructor.
-		Event( TimeStamp t, MessageID m, bool d, Receiver r ) : time_stamp( t ), msg_id( m ), default_event( d ), receiver( r ) {}
-	};
-
-	// This functor defines that events are sorted in the event queue according to their timestamp.
-	struct EventOrder {
-		bool operator() ( const Event* e1, const Event* e2 ) const {
-			return e1->time_stamp < e2->time_stamp;
-		}
-	};
-
-	// This is the definition of the event queue.
-	typedef std::set<Event*, EventOrder> EventQueue;
-}
+#include "fmu-event-queue.h"
+#include "delay-cache.h"
+#include "delay-statistics.h"
+#include "event-trace.h"
+#include "surrogate-delay-table.h"
+#include "checkpoint.h"
 
 
 // To implement an application that uses the backend/frontend mechanism, inherit from class 'BackEndApplicationBase'.
@@ -63,6 +49,8 @@ class SimpleEventQueueFMUBase : public BackEndApplicationBase
 {
 public:
 
+	virtual ~SimpleEventQueueFMUBase();
+
 	virtual void initializeScalarVariables();
 	virtual int initializeBackEnd( int argc, const char* argv[] );
 	virtual void initializeParameterValues();
@@ -75,15 +63,149 @@ public:
 	// This function runs an ns-3 simulation (to be implemented by inheriting application).
 	virtual void runSimulation( const double& sync_time ) = 0;
 
+	// Check if the backend has been started for writing the variable names to a JSON file.
+	static bool isVariableNamesExport( int argc, const char* argv[] );
+
+	// Write the names of all inputs, outputs and parameters to a JSON file (named after the executable),
+	// together with the number of integer inputs and outputs that are associated to messages (labels
+	// 'MessageInputs' and 'MessageOutputs', the variables added by the base class come after them).
+	int writeVariableNames( int argc, const char* argv[] );
+
+	// Check if the backend has been started for generating a surrogate delay table.
+	static bool isSurrogateTableGeneration( int argc, const char* argv[] );
+
+	// Run the simulation offline for a grid of senders (integer inputs), message sizes and random seeds
+	// and write the resulting delays to a surrogate delay table. Command line arguments:
+	//   --generate-surrogate-table=<file name>
+	//   --surrogate-seeds=<number of seeds> (default: 10)
+	//   --surrogate-seed-offset=<offset of the first seed> (default: 0)
+	//   --surrogate-message-sizes=<size 1>,<size 2>,... (default: scenario's default size)
+	//   <parameter name>=<parameter value>
+	int generateSurrogateTable( int argc, const char* argv[] );
+
+	// This function simulates a single group of messages (has to be implemented by inheriting application
+	// in case function 'evaluateMessageGroups' is used, the default implementation aborts). It is called in
+	// a separate process, which holds a copy of the topology set up before. The delays of all messages of
+	// the group have to be returned in the same order as the messages (negative delays indicate lost messages).
+	virtual void simulateMessageGroup( const size_t& group_index,
+		const Ns3FMUBackendEventQueue::MessageGroup& group, std::vector<ns3::Time>& delays );
+
+	// These functions write/read the state of the inheriting application to/from a checkpoint (in case
+	// checkpoints are enabled and the application keeps state between simulations, e.g., counters).
+	// Values have to be read in the same order as written. Return false in case the state cannot be read.
+	virtual void writeCheckpoint( CheckpointWriter& checkpoint ) const;
+	virtual bool readCheckpoint( CheckpointReader& checkpoint );
+
 protected:
 
 	// This function adds new events to the event queue.
-	void addNewEventForMessage( const Ns3FMUBackendEventQueue::TimeStamp& msg_receive_time,
+	void addNewEventForMessage( const fmippReal& msg_receive_time,
+	const Ns3FMUBackendEventQueue::MessageID& msg_id,
+	const Ns3FMUBackendEventQueue::Receiver& receiver );
+
+	// This function adds new events to the event queue, the message is received after the given delay
+	// (relative to the current synchronization time). This avoids rounding errors of floating point
+	// arithmetic, hence it should be preferred when the delay is available as ns-3 time value.
+	void addNewEventForMessageWithDelay( const ns3::Time& delay,
 	const Ns3FMUBackendEventQueue::MessageID& msg_id,
 	const Ns3FMUBackendEventQueue::Receiver& receiver );
 
-	// Send debug message.
-	void debug( const std::string& msg ) const;
+	// This function adds new events for many messages at once (e.g., all messages
+	// resulting from a single call to 'runSimulation').
+	void addNewEventsForMessages( const std::vector<Ns3FMUBackendEventQueue::Message>& messages );
+
+	// Maximum number of events that can be announced via lookahead outputs.
+	static const size_t MAX_LOOKAHEAD_SIZE = 8;
+
+	// Enable outputs for the next n message deliveries in the event queue (call from 'initializeSimulation').
+	// For i = 1..n, output 'next_event_time_i' is the time of the i-th next message delivery and output
+	// 'next_event_receiver_i' the (1-based) index of the associated integer output (0 if there is none).
+	// Output 'pending_events' is the total number of pending message deliveries.
+	void enableLookaheadOutputs( const size_t& n );
+
+	// Enable the delay cache (call from 'initializeSimulation'). Optionally, the cache is backed by
+	// a file, which allows to re-use the cached delays in subsequent co-simulation runs.
+	void enableDelayCache( const std::string& file_name = std::string() );
+
+	// Create a key for the delay cache. The key already contains the values of all parameters
+	// (including the random seed). Further inputs that determine the outcome of the simulation
+	// (e.g., sender, receiver, packet size) have to be added by the inheriting application.
+	DelayCacheKey createDelayCacheKey() const;
+
+	// Look up a delay in the delay cache. Returns false if the delay cache is not enabled or
+	// no delay has been stored for this key.
+	bool lookupDelay( const DelayCacheKey& key, ns3::Time& delay ) const;
+
+	// Store a delay in the delay cache (if enabled).
+	void storeDelay( const DelayCacheKey& key, const ns3::Time& delay );
+
+	// Simulate independent groups of messages in parallel. Call this function from within 'runSimulation'
+	// after setting up the topology. For each group, a worker process is forked that calls function
+	// 'simulateMessageGroup'. The resulting delays are added as new events to the event queue. At most
+	// max_workers processes run at the same time (0 means the number of available processors). In case a
+	// worker fails, the simulation is aborted (i.e., messages are never dropped silently).
+	void evaluateMessageGroups( const std::vector<Ns3FMUBackendEventQueue::MessageGroup>& groups,
+		size_t max_workers = 0 );
+
+	// Use a surrogate delay table instead of running ns-3 simulations (call from 'initializeSimulation').
+	// In case the table cannot be opened at runtime, ns-3 simulations are run as usual. The default message
+	// size is the size passed to 'getMessageSize( default_size )' by the inheriting application.
+	void enableSurrogateTable( const std::string& file_name = "surrogate-delays.bin",
+		const fmippInteger& default_message_size = 0 );
+
+	// Size of the messages to be simulated. Returns the default size, unless a specific message size
+	// has been requested (e.g., when generating a surrogate delay table).
+	fmippInteger getMessageSize( const fmippInteger& default_size ) const;
+
+	// Attach a payload to the messages sent via an integer input (call from 'initializeSimulation', after
+	// defining both variables as inputs). Whenever a message is sent, the current value of the payload input
+	// is attached to it. String payloads are treated as raw bytes.
+	void addPayloadInput( fmippInteger& msg_input, fmippReal& payload_input );
+	void addPayloadInput( fmippInteger& msg_input, std::string& payload_input );
+
+	// Deliver the payloads of the messages received via an integer output (call from 'initializeSimulation',
+	// after defining both variables as outputs). The payload output is set in the same event iteration as
+	// the integer output, i.e., at the simulated arrival time of the message.
+	void addPayloadOutput( fmippInteger& msg_output, fmippReal& payload_output );
+	void addPayloadOutput( fmippInteger& msg_output, std::string& payload_output );
+
+	// Size of a message, i.e., the size returned by 'getMessageSize( default_size )' plus the size of
+	// the payload attached to the message (if any). Use this size for the packets sent in 'runSimulation'.
+	fmippInteger getMessageSize( const Ns3FMUBackendEventQueue::MessageID& msg_id, const fmippInteger& default_size ) const;
+
+	// Enable checkpoints (call from 'initializeSimulation'). This adds the real parameter 'checkpoint_interval':
+	// whenever the simulated time has advanced by this interval (in seconds), the state of the backend is written
+	// to the checkpoint file (0 means that no checkpoints are written). In case the checkpoint file exists when
+	// the backend is initialized, the backend resumes from the checkpoint. The file is removed when the backend
+	// terminates regularly, i.e., it is only kept in case the co-simulation run has been aborted.
+	void enableCheckpoints( const std::string& file_name = "checkpoint.bin" );
+
+	// Enable state snapshots (call from 'initializeSimulation'), see class 'StateSnapshots'. This adds the integer
+	// inputs 'save_state', 'restore_state' and 'release_state' (commands applied with the next FMU iteration) and
+	// the integer output 'saved_state' (ID of the snapshot saved or restored by the last command, 0 on failure).
+	// Not available for backends hosted by a shared process or running in-process.
+	void enableStateSnapshots();
+
+	// Current synchronization time (as internal timestamp).
+	const Ns3FMUBackendEventQueue::TimeStamp& getSyncTimeStamp() const { return sync_time_stamp_; }
+
+	// Start time, stop time and logging flag of the FMU instance. Use these functions instead of the according
+	// functions of class 'BackEndApplicationBase', they also work when the backend runs in-process.
+	fmippReal getStartTime() const;
+	bool getStopTimeIfDefined( fmippReal& stop_time ) const;
+	bool isLoggingOn() const;
+
+	// This function opens or closes the debug trace according to the current logging setting (the
+	// setting can only change in in-process mode).
+	void updateTrace( bool append );
+
+	// Write a record to the debug trace. This does nothing unless logging is on, i.e., the arguments
+	// are only stored (no text formatting), see class 'EventTrace'.
+	void trace( EventTraceType type, const Ns3FMUBackendEventQueue::TimeStamp& time,
+		const Ns3FMUBackendEventQueue::MessageID& msg_id = 0, int64_t value = 0 ) const
+	{
+		if ( 0 != trace_ ) trace_->write( type, time, msg_id, value );
+	}
 
 private:
 
@@ -93,6 +215,100 @@ private:
 	// This function resets all integer outputs (i.e., output messages).
 	void resetIntegerOutputs();
 
+	// Payload variables associated to an integer input or output.
+	struct PayloadBinding {
+		fmippInteger* message;
+		fmippReal* real;
+		std::string* bytes;
+	};
+
+	// Payload attached to a message, kept for every receiver until all its deliveries have been made.
+	struct Payload {
+		bool has_real;
+		fmippReal real;
+		bool has_bytes;
+		std::string bytes;
+		size_t pending;
+	};
+
+	// This function retrieves the payload binding for an integer variable (created if it does not exist).
+	static PayloadBinding& getPayloadBinding( std::vector<PayloadBinding>& bindings, fmippInteger& message );
+
+	// Payloads of messages in flight are identified by the receiver and the message ID.
+	typedef std::pair<Ns3FMUBackendEventQueue::Receiver, Ns3FMUBackendEventQueue::MessageID> PayloadKey;
+
+	// This function attaches the current payload inputs to all messages sent.
+	void attachPayloads();
+
+	// This function keeps the payload of a sent message until it has been delivered to the receiver.
+	void keepPayload( const Ns3FMUBackendEventQueue::MessageID& msg_id,
+		const Ns3FMUBackendEventQueue::Receiver& receiver );
+
+	// This function removes the payloads of sent messages (the payloads of messages in flight are kept).
+	void releasePayloads();
+
+	// This function sets the payload outputs for a message delivered to a receiver.
+	void deliverPayload( const Ns3FMUBackendEventQueue::MessageID& msg_id,
+	const Ns3FMUBackendEventQueue::Receiver& receiver );
+
+	// This function resets all payload outputs.
+	void resetPayloadOutputs();
+
+	// This function defines the lookahead outputs.
+	void initializeLookaheadOutputs();
+
+	// This function sets the lookahead outputs according to the event queue.
+	void updateLookaheadOutputs();
+
+	// This function retrieves the (1-based) index of a receiver in the list of integer outputs (0 if there is none).
+	fmippInteger getReceiverIndex( const Ns3FMUBackendEventQueue::Receiver& receiver ) const;
+
+	// This function either runs an ns-3 simulation or samples delays from the surrogate delay table.
+	void simulate( const fmippReal& sync_time );
+
+	// This function samples delays for all messages sent from the surrogate delay table.
+	void sampleFromSurrogateTable();
+
+	// This function records a message instead of adding it to the event queue (when generating a
+	// surrogate delay table). Returns false in case messages are not recorded.
+	bool captureMessage( const Ns3FMUBackendEventQueue::TimeStamp& msg_receive_time,
+	const Ns3FMUBackendEventQueue::MessageID& msg_id,
+	const Ns3FMUBackendEventQueue::Receiver& receiver );
+
+	// This function adds a new event to the event queue.
+	void addNewEvent( const Ns3FMUBackendEventQueue::TimeStamp& msg_receive_time,
+	const Ns3FMUBackendEventQueue::MessageID& msg_id,
+	const Ns3FMUBackendEventQueue::Receiver& receiver );
+
+	// Event iteration: deliver the messages of the current event (if any) and simulate new messages.
+	void iterate( const Ns3FMUBackendEventQueue::TimeStamp& sync_time, const fmippReal& syncTime );
+
+	// Check if any message has been sent, i.e., if any integer input is set.
+	bool hasNewMessages() const;
+
+	// This function sets the next event time according to the event queue and the default events.
+	void updateNextEventTime();
+
+	// This function sets the next event time (internal timestamp and FMI output variable).
+	void setNextEventTime( const Ns3FMUBackendEventQueue::TimeStamp& t );
+
+	// This function signals the frontend that the step has returned early (i.e., has been discarded).
+	void discardStep( const Ns3FMUBackendEventQueue::TimeStamp& requested_sync_time );
+
+	// This function writes the state of the backend at the given time to the checkpoint file.
+	void writeCheckpointFile( const Ns3FMUBackendEventQueue::TimeStamp& time );
+
+	// This function restores the state of the backend from the checkpoint file (if it exists).
+	// Returns false in case the checkpoint cannot be used.
+	bool resumeFromCheckpoint();
+
+	// This function defines the inputs/outputs for state snapshots.
+	void initializeStateSnapshotVariables();
+
+	// This function applies the state snapshot commands (FMU iterations only). Returns true in case a
+	// command has been applied, the FMU iteration does nothing else in this case.
+	bool applyStateCommands( const fmippReal& syncTime, const fmippReal& lastSyncTime );
+
 	//
 	// Internal class members.
 	//
@@ -100,18 +316,101 @@ private:
 	// Output variable indicating the time of the next scheduled event.
 	fmippReal next_event_time;
 
+	// Output variable indicating the time reached by the last step. This is the end of the step, unless
+	// an event lies within the step. In this case the step returns early at the time of the event and
+	// is discarded (the co-simulation master continues from this time).
+	fmippReal last_successful_time;
+	bool step_discarded_ = false;
+
 	// Default step size (parameter).
 	fmippReal default_event_step_size;
 
 	// Random generator seed (parameter).
 	fmippInteger random_seed;
 
-	// Event queue.
+	// Fused step mode (parameter). If non-zero, a time advance also applies the inputs set before the
+	// step and does the event iteration, i.e., messages can be sent and received without separate
+	// FMU iterations (FMU iterations at the same time are still supported, e.g., for postponed deliveries).
+	fmippInteger fused_steps = 0;
+
+	// Internal representation of the next event time and the current synchronization time.
+	Ns3FMUBackendEventQueue::TimeStamp next_event_time_stamp_;
+	Ns3FMUBackendEventQueue::TimeStamp sync_time_stamp_;
+
+	// Event queue (holds only events for messages).
 	Ns3FMUBackendEventQueue::EventQueue event_queue_;
-	Ns3FMUBackendEventQueue::EventQueue::iterator current_event_;
 
-	// Output file stream (for debugging).
-	std::ofstream* debug_;
+	// Generator for default events.
+	Ns3FMUBackendEventQueue::DefaultEventTimer default_event_timer_;
+
+	// Auxiliary containers for delivering events (kept as members to avoid reallocations).
+	std::vector<Ns3FMUBackendEventQueue::Receiver> written_receivers_;
+	std::vector<Ns3FMUBackendEventQueue::Delivery> postponed_deliveries_;
+
+	// Number of integer inputs/outputs associated to messages.
+	size_t n_message_inputs_;
+	size_t n_message_outputs_;
+
+	// Lookahead outputs (only used if enabled).
+	size_t lookahead_size_ = 0;
+	fmippReal lookahead_times_[MAX_LOOKAHEAD_SIZE];
+	fmippInteger lookahead_receivers_[MAX_LOOKAHEAD_SIZE];
+	fmippInteger pending_events;
+	std::vector<const Ns3FMUBackendEventQueue::Event*> lookahead_events_;
+
+	// Delay cache (only used if enabled).
+	bool delay_cache_enabled_ = false;
+	std::string delay_cache_file_name_;
+	DelayCache delay_cache_;
+
+	// Size of the messages to be simulated (0 for the scenario's default size).
+	fmippInteger message_size_ = 0;
+
+	// Surrogate delay table (only used if enabled).
+	std::string surrogate_table_file_name_;
+	fmippInteger surrogate_default_message_size_ = 0;
+	SurrogateDelayTable surrogate_table_;
+	std::mt19937_64 surrogate_rng_;
+
+	// Messages recorded when generating a surrogate delay table.
+	bool capturing_ = false;
+	std::vector<Ns3FMUBackendEventQueue::Message> captured_;
+
+	// Payload channels (only used if payload inputs/outputs have been added).
+	std::vector<PayloadBinding> payload_inputs_;
+	std::vector<PayloadBinding> payload_outputs_;
+	std::unordered_map<Ns3FMUBackendEventQueue::MessageID, Payload> sent_payloads_;
+	std::map<PayloadKey, Payload> payloads_;
+
+	// Checkpoints (only used if enabled).
+	bool checkpoints_enabled_ = false;
+	std::string checkpoint_file_name_;
+	fmippReal checkpoint_interval = 0.;
+	bool remove_checkpoint_ = false;
+	Ns3FMUBackendEventQueue::TimeStamp next_checkpoint_time_stamp_ = Ns3FMUBackendEventQueue::TIME_STAMP_MAX;
+	CheckpointWriter checkpoint_;
+
+	// State snapshot commands and result (only used if enabled).
+	bool state_snapshots_enabled_ = false;
+	fmippInteger save_state = 0;
+	fmippInteger restore_state = 0;
+	fmippInteger release_state = 0;
+	fmippInteger saved_state = 0;
+
+	// Debug trace (only used if logging is on).
+	EventTrace* trace_ = 0;
+
+	// Settings of the FMU instance in case the backend runs in the same process as the FMU (set by
+	// class 'InProcessBackEnd'). Otherwise, these settings are provided by the FMI++ backend component.
+	struct InProcessSettings {
+		fmippReal start_time;
+		fmippReal stop_time;
+		bool stop_time_defined;
+		bool logging_on;
+	};
+	const InProcessSettings* in_process_ = 0;
+
+	friend class InProcessBackEnd;
 };
 
 
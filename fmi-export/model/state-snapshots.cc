@@ -0,0 +1,354 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include "state-snapshots.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <cerrno>
+
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+
+// Process ID used to identify the backend to the FMU frontend (see 'lib/backEndProcessId.cpp').
+extern "C" pid_t fmippex_backend_pid();
+extern "C" void fmippex_set_backend_pid( pid_t pid );
+
+
+namespace {
+
+	// Commands sent to a snapshot (the reply is a single integer).
+	enum Command {
+		COMMAND_RESTORE = 1, // Reply: process ID of the restored copy (0 in case of failure).
+		COMMAND_RELEASE = 2, // Reply: 1.
+		COMMAND_FINISH = 3 // Reply: 1, the snapshot terminates when the connection is closed.
+	};
+
+	// How often a snapshot checks for terminated child processes (in milliseconds).
+	const int SNAPSHOT_POLL_INTERVAL = 1000;
+
+	// Process ID of the first snapshot (0 if no snapshot has been saved yet).
+	pid_t origin_pid = 0;
+
+
+	bool writeAll( int fd, const void* data, size_t size )
+	{
+		const char* p = static_cast<const char*>( data );
+		while ( 0 < size ) {
+			ssize_t n = write( fd, p, size );
+			if ( ( 0 > n ) && ( EINTR == errno ) ) continue;
+			if ( 0 >= n ) return false;
+			p += n;
+			size -= n;
+		}
+		return true;
+	}
+
+
+	bool readAll( int fd, void* data, size_t size )
+	{
+		char* p = static_cast<char*>( data );
+		while ( 0 < size ) {
+			ssize_t n = read( fd, p, size );
+			if ( ( 0 > n ) && ( EINTR == errno ) ) continue;
+			if ( 0 >= n ) return false;
+			p += n;
+			size -= n;
+		}
+		return true;
+	}
+
+
+	// Socket address of a snapshot. The name contains the process ID of the first snapshot, hence
+	// snapshots of other backends cannot be addressed by mistake.
+	socklen_t snapshotAddress( pid_t id, sockaddr_un& addr )
+	{
+		std::memset( &addr, 0, sizeof( addr ) );
+		addr.sun_family = AF_UNIX;
+
+		// Abstract namespace (leading null byte), the socket vanishes along with the process.
+		int n = std::snprintf( addr.sun_path + 1, sizeof( addr.sun_path ) - 1, "ns3-fmu-state-%d-%d",
+			static_cast<int>( origin_pid ), static_cast<int>( id ) );
+		return static_cast<socklen_t>( offsetof( sockaddr_un, sun_path ) + 1 + n );
+	}
+
+
+	int connectTo( int32_t id )
+	{
+		if ( ( 0 == origin_pid ) || ( 0 >= id ) ) return -1;
+
+		sockaddr_un addr;
+		socklen_t addr_len = snapshotAddress( id, addr );
+
+		int fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+		if ( 0 > fd ) return -1;
+
+		if ( 0 != connect( fd, reinterpret_cast<sockaddr*>( &addr ), addr_len ) ) {
+			close( fd );
+			return -1;
+		}
+
+		return fd;
+	}
+
+
+	bool sendCommand( int fd, uint32_t command, int32_t& reply )
+	{
+		return writeAll( fd, &command, sizeof( command ) ) && readAll( fd, &reply, sizeof( reply ) );
+	}
+
+
+	// Only accept commands from processes of the same user.
+	bool isSameUser( int fd )
+	{
+#ifdef __linux__
+		ucred cred;
+		socklen_t len = sizeof( cred );
+		return ( 0 == getsockopt( fd, SOL_SOCKET, SO_PEERCRED, &cred, &len ) ) && ( getuid() == cred.uid );
+#else
+		return false;
+#endif
+	}
+
+
+	// Fork a new process that becomes a child of the first snapshot (a subreaper), i.e., all snapshots and
+	// the active process are siblings and none of them depends on another one. Returns the process ID of the
+	// new process (0 in the new process itself, -1 in case of failure).
+	pid_t forkSibling()
+	{
+		if ( getpid() == origin_pid ) return fork();
+
+		int fds[2];
+		if ( 0 != pipe( fds ) ) return -1;
+
+		pid_t intermediate = fork();
+
+		if ( 0 == intermediate ) {
+			close( fds[0] );
+			pid_t self = getpid();
+			pid_t pid = fork();
+
+			if ( 0 == pid ) {
+				// Wait until the intermediate process has terminated, i.e., the process has been handed over.
+				close( fds[1] );
+				while ( self == getppid() ) usleep( 100 );
+				return 0;
+			}
+
+			writeAll( fds[1], &pid, sizeof( pid ) );
+			_exit( 0 );
+		}
+
+		close( fds[1] );
+
+		pid_t pid = -1;
+		if ( 0 < intermediate ) {
+			if ( false == readAll( fds[0], &pid, sizeof( pid ) ) ) pid = -1;
+			while ( ( 0 > waitpid( intermediate, 0, 0 ) ) && ( EINTR == errno ) ) {}
+		}
+		close( fds[0] );
+
+		return pid;
+	}
+
+
+	// Set up a process forked from a snapshot (or from the active process when saving a snapshot).
+	void resume( pid_t backend_pid )
+	{
+#ifdef __linux__
+		// Terminate along with the first snapshot (which might have terminated already).
+		prctl( PR_SET_PDEATHSIG, SIGKILL );
+#endif
+		if ( getppid() != origin_pid ) _exit( 0 );
+
+		// Keep on identifying as the process started for the backend.
+		fmippex_set_backend_pid( backend_pid );
+	}
+
+
+	// Wait for commands. Returns only in a copy forked for restoring the snapshot.
+	void serve( int listen_fd, pid_t backend_pid )
+	{
+		pid_t self = getpid();
+		bool released = false;
+
+		while ( true )
+		{
+			// Reap terminated child processes (only the first snapshot has any).
+			while ( 0 < waitpid( -1, 0, WNOHANG ) ) {}
+
+			pollfd pfd = { listen_fd, POLLIN, 0 };
+			if ( 0 >= poll( &pfd, 1, SNAPSHOT_POLL_INTERVAL ) ) continue;
+
+			int fd = accept( listen_fd, 0, 0 );
+			if ( 0 > fd ) continue;
+
+			uint32_t command = 0;
+			if ( ( false == isSameUser( fd ) ) || ( false == readAll( fd, &command, sizeof( command ) ) ) ) {
+				close( fd );
+				continue;
+			}
+
+			int32_t reply = 1;
+
+			if ( COMMAND_RESTORE == command )
+			{
+				pid_t copy = ( false == released ) ? forkSibling() : -1;
+
+				if ( 0 == copy ) { // This is the restored copy.
+					close( fd );
+					close( listen_fd );
+					resume( backend_pid );
+					return;
+				}
+
+				reply = ( 0 < copy ) ? static_cast<int32_t>( copy ) : 0;
+			}
+			else if ( COMMAND_RELEASE == command )
+			{
+				released = true;
+			}
+
+			writeAll( fd, &reply, sizeof( reply ) );
+
+			// A released snapshot terminates right away (except for the first snapshot, which terminates
+			// when the backend has finished).
+			if ( ( true == released ) && ( origin_pid != self ) ) _exit( 0 );
+
+			if ( ( COMMAND_FINISH == command ) && ( origin_pid == self ) ) {
+				// Wait until the active process has terminated, all other processes terminate along with this one.
+				char c;
+				ssize_t n;
+				do { n = read( fd, &c, 1 ); } while ( ( 0 < n ) || ( ( 0 > n ) && ( EINTR == errno ) ) );
+				_exit( 0 );
+			}
+
+			close( fd );
+		}
+	}
+}
+
+
+int32_t
+StateSnapshots::save( bool& restored )
+{
+	restored = false;
+
+	pid_t self = getpid();
+	pid_t backend_pid = fmippex_backend_pid();
+	if ( 0 == origin_pid ) {
+		origin_pid = self;
+#ifdef __linux__
+		// Processes forked later on are handed over to the first snapshot (see function 'forkSibling').
+		prctl( PR_SET_CHILD_SUBREAPER, 1 );
+#endif
+	}
+
+	sockaddr_un addr;
+	socklen_t addr_len = snapshotAddress( self, addr );
+
+	int listen_fd = socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+	if ( 0 > listen_fd ) return 0;
+
+	if ( ( 0 != bind( listen_fd, reinterpret_cast<sockaddr*>( &addr ), addr_len ) ) || ( 0 != listen( listen_fd, 8 ) ) ) {
+		close( listen_fd );
+		return 0;
+	}
+
+	// Flush buffered output, otherwise it would be written by every copy.
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush( 0 );
+
+	pid_t active = forkSibling();
+
+	if ( 0 > active ) { // Forking failed.
+		close( listen_fd );
+		return 0;
+	}
+
+	if ( 0 == active ) { // This process continues as the active backend process.
+		close( listen_fd );
+		resume( backend_pid );
+		return self;
+	}
+
+	// This process is frozen as snapshot.
+	serve( listen_fd, backend_pid );
+
+	restored = true;
+	return self;
+}
+
+
+bool
+StateSnapshots::restore( int32_t id )
+{
+	int fd = connectTo( id );
+	if ( 0 > fd ) return false;
+
+	int32_t reply = 0;
+	bool ok = sendCommand( fd, COMMAND_RESTORE, reply ) && ( 0 < reply );
+	close( fd );
+
+	if ( false == ok ) return false;
+
+	// The restored copy takes over. Terminate immediately, i.e., without calling destructors or
+	// flushing buffers (the resources shared with the FMU frontend are still in use).
+	_exit( 0 );
+}
+
+
+bool
+StateSnapshots::release( int32_t id )
+{
+	int fd = connectTo( id );
+	if ( 0 > fd ) return false;
+
+	int32_t reply = 0;
+	bool ok = sendCommand( fd, COMMAND_RELEASE, reply ) && ( 1 == reply );
+	close( fd );
+
+	return ok;
+}
+
+
+void
+StateSnapshots::finish()
+{
+	if ( ( 0 == origin_pid ) || ( getpid() == origin_pid ) ) return;
+
+	int fd = connectTo( origin_pid );
+	int32_t reply = 0;
+	if ( 0 <= fd ) sendCommand( fd, COMMAND_FINISH, reply );
+
+	// The connection is intentionally left open, it is closed when this process terminates.
+}
@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_STATE_SNAPSHOTS
+#define _NS3_FMU_STATE_SNAPSHOTS
+
+
+#include <stdint.h>
+
+
+// Snapshots of the complete state of a backend process (Linux only). Saving the state forks the process:
+// the parent is frozen as snapshot, the child continues as the active backend process. Restoring a snapshot
+// forks a new active process from the frozen snapshot, the previously active process terminates. Hence, a
+// snapshot captures everything (event queue, ns-3 simulator, random number generators) at the cost of a
+// fork and can be restored any number of times.
+//
+// Snapshots are identified by the process ID of the frozen process and receive commands via a Unix
+// socket (in the abstract namespace). The first snapshot is kept by the process started for the backend,
+// all other processes terminate along with it (see function 'finish'). All other processes (snapshots
+// and the active process) are children of the first snapshot, i.e., they do not depend on each other.
+//
+// The calling process must not run any other threads (e.g., the background thread of the debug trace).
+class StateSnapshots
+{
+public:
+
+	// Save the state. Returns the ID of the snapshot (0 in case of failure). On success, this function
+	// also returns in every process forked from the snapshot when restoring it (with restored = true).
+	static int32_t save( bool& restored );
+
+	// Restore a snapshot. Returns false in case of failure. Otherwise the function does not return, the
+	// calling process terminates and function 'save' returns in the restored copy instead.
+	static bool restore( int32_t id );
+
+	// Release a snapshot, i.e., it cannot be restored anymore. The frozen process terminates right away
+	// (except for the first snapshot). Returns false in case the snapshot does not exist.
+	static bool release( int32_t id );
+
+	// Terminate all snapshots once the calling (active) process has terminated. Call this function when
+	// the backend has finished, otherwise the process started for the backend would never terminate.
+	static void finish();
+};
+
+
+#endif // _NS3_FMU_STATE_SNAPSHOTS
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "surrogate-delay-table.h"
+
+
+namespace {
+
+	const char MAGIC[8] = { 'N', 'S', '3', 'F', 'M', 'U', 'D', 'T' };
+	const uint32_t VERSION = 1;
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+		uint32_t n_entries;
+		uint64_t n_samples;
+	};
+
+	// Order of entries in the table (by sender).
+	bool senderLess( const SurrogateDelayTable::Entry& e, int32_t sender ) {
+		return e.sender < sender;
+	}
+
+	// Order of entries in the table (by size, for entries of the same sender).
+	bool sizeLess( const SurrogateDelayTable::Entry& e, int32_t size ) {
+		return e.size < size;
+	}
+}
+
+
+SurrogateDelayTable::SurrogateDelayTable() :
+	data_( 0 ), data_size_( 0 ), entries_( 0 ), n_entries_( 0 ), samples_( 0 )
+{}
+
+
+SurrogateDelayTable::~SurrogateDelayTable()
+{
+	if ( 0 != data_ ) munmap( data_, data_size_ );
+}
+
+
+void
+SurrogateDelayTable::addSample( int32_t sender, int32_t size, int32_t receiver, int64_t delay )
+{
+	std::vector<int32_t> key( 3 );
+	key[0] = sender; key[1] = size; key[2] = receiver;
+	added_[key].push_back( delay );
+}
+
+
+bool
+SurrogateDelayTable::write( const std::string& file_name ) const
+{
+	std::ofstream output( file_name.c_str(), std::ios::binary | std::ios::trunc );
+	if ( false == output.good() ) return false;
+
+	std::vector<Entry> entries;
+	std::vector<int64_t> samples;
+
+	std::map< std::vector<int32_t>, std::vector<int64_t> >::const_iterator it;
+	for ( it = added_.begin(); it != added_.end(); ++it )
+	{
+		Entry entry;
+		entry.sender = it->first[0];
+		entry.size = it->first[1];
+		entry.receiver = it->first[2];
+		entry.n_samples = static_cast<uint32_t>( it->second.size() );
+		entry.offset = samples.size();
+		entries.push_back( entry );
+
+		size_t begin = samples.size();
+		samples.insert( samples.end(), it->second.begin(), it->second.end() );
+		std::sort( samples.begin() + begin, samples.end() );
+	}
+
+	Header header;
+	std::memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+	header.version = VERSION;
+	header.n_entries = static_cast<uint32_t>( entries.size() );
+	header.n_samples = samples.size();
+
+	output.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+	output.write( reinterpret_cast<const char*>( entries.data() ), entries.size() * sizeof( Entry ) );
+	output.write( reinterpret_cast<const char*>( samples.data() ), samples.size() * sizeof( int64_t ) );
+
+	return output.good();
+}
+
+
+bool
+SurrogateDelayTable::open( const std::string& file_name )
+{
+	int fd = ::open( file_name.c_str(), O_RDONLY );
+	if ( 0 > fd ) return false;
+
+	struct stat st;
+	if ( ( 0 != fstat( fd, &st ) ) || ( static_cast<size_t>( st.st_size ) < sizeof( Header ) ) ) {
+		close( fd );
+		return false;
+	}
+
+	void* data = mmap( 0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( MAP_FAILED == data ) return false;
+
+	const Header* header = static_cast<const Header*>( data );
+	size_t expected_size = sizeof( Header ) + header->n_entries * sizeof( Entry ) + header->n_samples * sizeof( int64_t );
+
+	if ( ( 0 != std::memcmp( header->magic, MAGIC, sizeof( MAGIC ) ) ) ||
+		( VERSION != header->version ) || ( static_cast<size_t>( st.st_size ) != expected_size ) ) {
+		munmap( data, st.st_size );
+		return false;
+	}
+
+	if ( 0 != data_ ) munmap( data_, data_size_ );
+
+	data_ = data;
+	data_size_ = st.st_size;
+	n_entries_ = header->n_entries;
+	entries_ = reinterpret_cast<const Entry*>( static_cast<const char*>( data ) + sizeof( Header ) );
+	samples_ = reinterpret_cast<const int64_t*>( entries_ + n_entries_ );
+
+	return true;
+}
+
+
+size_t
+SurrogateDelayTable::find( int32_t sender, int32_t size, const Entry*& first ) const
+{
+	const Entry* end = entries_ + n_entries_;
+
+	// All entries for this sender.
+	const Entry* sender_begin = std::lower_bound( entries_, end, sender, senderLess );
+	const Entry* sender_end = std::lower_bound( sender_begin, end, sender + 1, senderLess );
+	if ( sender_begin == sender_end ) return 0;
+
+	// Find the nearest size.
+	const Entry* it = std::lower_bound( sender_begin, sender_end, size, sizeLess );
+
+	int32_t nearest_size;
+	if ( sender_end == it ) {
+		nearest_size = ( sender_end - 1 )->size;
+	} else if ( ( it->size == size ) || ( sender_begin == it ) ) {
+		nearest_size = it->size;
+	} else {
+		int32_t upper = it->size;
+		int32_t lower = ( it - 1 )->size;
+		nearest_size = ( size - lower <= upper - size ) ? lower : upper;
+	}
+
+	first = std::lower_bound( sender_begin, sender_end, nearest_size, sizeLess );
+
+	const Entry* last = first;
+	while ( ( last != sender_end ) && ( last->size == nearest_size ) ) ++last;
+
+	return last - first;
+}
@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- *//*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License version 2 as
+* published by the Free Software Foundation;
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+#ifndef _NS3_FMU_SURROGATE_DELAY_TABLE
+#define _NS3_FMU_SURROGATE_DELAY_TABLE
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+#include <stdint.h>
+
+
+// Table of delay distributions, generated offline by running a scenario for a grid of senders,
+// message sizes and random seeds. For every combination of sender, message size and receiver,
+// the table holds the (sorted) delays of all runs. Negative delays denote lost messages.
+//
+// File layout (native byte order):
+//   header:  char magic[8], uint32 version, uint32 number of entries, uint64 number of samples
+//   entries: sorted by sender, size and receiver (see struct Entry)
+//   samples: int64 delays in nanoseconds
+// The file is memory-mapped when it is opened for reading.
+class SurrogateDelayTable
+{
+public:
+
+	struct Entry {
+		int32_t sender; // Index of the integer input associated to the sender.
+		int32_t size; // Message size (0 for the scenario's default size).
+		int32_t receiver; // Index of the integer output associated to the receiver.
+		uint32_t n_samples; // Number of samples.
+		uint64_t offset; // Index of the first sample.
+	};
+
+	SurrogateDelayTable();
+	~SurrogateDelayTable();
+
+	// Add a sample (for writing a table).
+	void addSample( int32_t sender, int32_t size, int32_t receiver, int64_t delay );
+
+	// Write all added samples to a file.
+	bool write( const std::string& file_name ) const;
+
+	// Open a table for reading. Returns false in case the file does not exist or is invalid.
+	bool open( const std::string& file_name );
+
+	bool isOpen() const { return 0 != entries_; }
+
+	// Find all entries for a sender. If there are no entries for the given size, the entries
+	// with the nearest size are returned. Returns the number of entries found.
+	size_t find( int32_t sender, int32_t size, const Entry*& first ) const;
+
+	// Retrieve the samples of an entry.
+	const int64_t* samples( const Entry& entry ) const { return samples_ + entry.offset; }
+
+private:
+
+	// The table is not copyable.
+	SurrogateDelayTable( const SurrogateDelayTable& );
+	SurrogateDelayTable& operator=( const SurrogateDelayTable& );
+
+	// Samples added for writing, ordered by sender, size and receiver.
+	std::map< std::vector<int32_t>, std::vector<int64_t> > added_;
+
+	// Memory-mapped table.
+	void* data_;
+	size_t data_size_;
+	const Entry* entries_;
+	uint32_t n_entries_;
+	const int64_t* samples_;
+};
+
+
+#endif // _NS3_FMU_SURROGATE_DELAY_TABLE
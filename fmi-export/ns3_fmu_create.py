@@ -27,6 +27,7 @@ def log( *arg ):
 
 from scripts.utils import *
 from scripts.generate_fmu import *
+from scripts.surrogate import *
 
 
 def main( ns3_fmu_root_dir = os.path.dirname( __file__ ), parser = None ):
@@ -58,6 +59,19 @@ def main( ns3_fmu_root_dir = os.path.dirname( __file__ ), parser = None ):
     fmi_version = cmd_line_args.fmi_version
     if ( True == verbose ): modules.log( '[DEBUG] Using FMI version', fmi_version )
 
+    # In-process flag (only supported for FMI 2.0 and 3.0). FMUs for FMI 3.0 are always loaded in-process.
+    in_process = getattr( cmd_line_args, 'in_process', False ) or ( '3' == fmi_version )
+    if ( True == in_process ) and ( '1' == fmi_version ):
+        modules.log( '\n[ERROR] In-process FMUs are only supported for FMI versions 2 and 3' )
+        sys.exit(4)
+
+    # Zygote flags (not supported for in-process FMUs, which do not start a backend process).
+    shared_process = getattr( cmd_line_args, 'shared_process', False )
+    zygote = getattr( cmd_line_args, 'zygote', False ) or shared_process
+    if ( True == zygote ) and ( True == in_process ):
+        modules.log( '\n[ERROR] Options --zygote/--shared-process and --in-process (or FMI version 3) are mutually exclusive' )
+        sys.exit(4)
+
     # Check if specified ns-3 script exists.
     if ( False == os.path.isfile( script_file_path ) ):
         modules.log( '\n[ERROR] Invalid ns-3 script: ', script_file_path )
@@ -88,9 +102,38 @@ def main( ns3_fmu_root_dir = os.path.dirname( __file__ ), parser = None ):
 
     # Copy the script to ns-3's scratch directory, compile it and
     # retrieve FMI input/output variable names from the script.
-    ( script_name, fmi_input_vars, fmi_output_vars, fmi_params ) = \
+    ( script_name, fmi_input_vars, fmi_output_vars, fmi_params, message_counts ) = \
         prepareNs3Script( script_file_path, ns3_install_dir, verbose, modules )
 
+    # The FMU launches the compiled script directly (i.e., without waf).
+    ns3_executable = findNs3Executable( script_name, ns3_install_dir, verbose, modules )
+    bundle_libraries = getattr( cmd_line_args, 'bundle_libraries', False )
+
+    # Optionally, create a surrogate delay table (stored in the FMU's resources directory).
+    surrogate_seeds = getattr( cmd_line_args, 'surrogate_seeds', None )
+    surrogate_table_file_path = None
+    if ( None != surrogate_seeds ):
+        surrogate_table_file_path = createSurrogateTable(
+            ns3_executable,
+            ns3_install_dir,
+            fmi_input_vars,
+            fmi_output_vars,
+            fmi_params,
+            start_values,
+            surrogate_seeds,
+            getattr( cmd_line_args, 'surrogate_message_sizes', None ),
+            getattr( cmd_line_args, 'surrogate_validate', False ),
+            fmi_model_identifier,
+            verbose,
+            modules )
+        optional_files.append( surrogate_table_file_path )
+
+    # Optionally, compile the script as shared library (stored in the FMU's resources directory).
+    in_process_library = None
+    if ( True == in_process ):
+        in_process_library = compileInProcessLibrary(
+            script_file_path, ns3_install_dir, fmipp_include_dir, fmipp_lib_dir, verbose, modules )
+
     if ( True == verbose ):
         modules.log( '[DEBUG] FMI model identifier: ', fmi_model_identifier )
         modules.log( '[DEBUG] ns-3 script: ', script_file_path )
@@ -102,6 +145,7 @@ def main( ns3_fmu_root_dir = os.path.dirname( __file__ ), parser = None ):
     try:
         fmu_name = generateNs3FMU(
             script_name,
+            ns3_executable,
             fmi_version,
             fmi_model_identifier,
             fmi_input_vars,
@@ -115,10 +159,21 @@ def main( ns3_fmu_root_dir = os.path.dirname( __file__ ), parser = None ):
             fmipp_lib_dir,
             verbose,
             litter,
-            modules )
+            modules,
+            in_process_library,
+            bundle_libraries,
+            zygote,
+            shared_process,
+            message_counts )
 
         if ( True == verbose ): modules.log( "[DEBUG] FMU created successfully:", fmu_name )
 
+        if ( None != surrogate_table_file_path ) and ( False == litter ):
+            modules.os.remove( surrogate_table_file_path )
+
+        if ( None != in_process_library ) and ( False == litter ):
+            modules.os.remove( in_process_library )
+
     except Exception as e:
         modules.log( e )
         modules.sys.exit( e.args[0] )
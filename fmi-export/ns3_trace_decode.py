@@ -0,0 +1,87 @@
+#!/usr/bin/python3
+
+# -----------------------------------------------------------------
+# Copyright (c) 2018, AIT Austrian Institute of Technology GmbH.
+# -----------------------------------------------------------------
+
+#
+# This file is used to decode the binary debug traces of ns-3 FMUs (file 'sim_ict_exe.log',
+# written when logging is on) into text.
+#
+
+import sys, struct, argparse
+
+
+# Maximum time stamp (i.e., no event scheduled).
+TIME_STAMP_MAX = 2**63 - 1
+
+
+# Text for each record type (see enum 'EventTraceType' in 'model/event-trace.h').
+# Arguments: t (time in seconds), id (message ID), n (value).
+TRACE_FORMATS = {
+    1 : 'DOSTEP: t = {t}',
+    2 : 'DOSTEP: coincides with event at t = {t}',
+    3 : 'next default event at t = {t}',
+    4 : 'DOSTEP: event has msg_id = {id}',
+    5 : 'postpone msg_id = {id}',
+    6 : 'DOSTEP: next event time = {t}',
+    7 : 'add new evt at t = {t} - id = {id}',
+    8 : 'set new event as next event at t = {t}',
+    9 : 'added {n} new events',
+    10 : 'no new evt for lost message - id = {id}',
+    11 : 'loaded {n} delays from delay cache file',
+    12 : '{surrogate}',
+    13 : 'failed to start worker process',
+    14 : 'worker process for message group {n} failed',
+    15 : 'ns-3 simulation is ahead of synchronization time: t_ns3 = {t}, t_sync = {n_t}',
+    16 : 'wait for {n} message(s) in flight',
+    17 : '{n} message(s) not received within delivery horizon',
+    18 : 'WARNING: {n} trace record(s) dropped (trace buffer full)',
+    19 : 'DOSTEP: early return at event time t = {t} (requested t = {n_t})',
+    20 : 'DOSTEP: saved state snapshot {n} (0 = failed)',
+    21 : 'DOSTEP: restored state snapshot {n} at t = {t}',
+    22 : 'DOSTEP: failed to restore state snapshot {n}',
+    23 : 'DOSTEP: released state snapshot {n}',
+    24 : 'DOSTEP: failed to release state snapshot {n}',
+    25 : 'DOSTEP: wrote checkpoint at t = {t} ({n} bytes, 0 = failed)',
+    26 : 'resumed from checkpoint at t = {t}',
+    27 : 'ERROR: checkpoint file cannot be used (corrupt or different parameters)',
+    }
+
+
+def toSeconds( t ):
+    return 'inf' if ( TIME_STAMP_MAX == t ) else repr( t * 1e-9 )
+
+
+# Decode a binary trace file, returns a list of text lines.
+def decodeTrace( trace_file_path ):
+    with open( trace_file_path, 'rb' ) as trace_file:
+        data = trace_file.read()
+
+    ( magic, version, record_size ) = struct.unpack_from( '=8sII', data, 0 )
+    if ( b'NS3TRACE' != magic ) or ( 1 != version ) or ( struct.calcsize( '=Iiqq' ) != record_size ):
+        raise Exception( 'not a valid trace file: {}'.format( trace_file_path ) )
+
+    lines = []
+    offset = struct.calcsize( '=8sII' )
+    while offset + record_size <= len( data ):
+        ( record_type, msg_id, t, n ) = struct.unpack_from( '=Iiqq', data, offset )
+        offset += record_size
+
+        fmt = TRACE_FORMATS.get( record_type, 'unknown record (type = {type}, t = {t}, id = {id}, value = {n})' )
+        surrogate = 'using surrogate delay table' if ( 0 != n ) else 'surrogate delay table not available, run full simulations'
+        lines.append( fmt.format( type = record_type, t = toSeconds( t ), id = msg_id, n = n, n_t = toSeconds( n ), surrogate = surrogate ) )
+
+    return lines
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser( description = 'decode the debug trace of an ns-3 FMU into text' )
+    parser.add_argument( 'trace', nargs = '?', default = 'sim_ict_exe.log', help = 'trace file (default: sim_ict_exe.log)' )
+    args = parser.parse_args()
+
+    try:
+        for line in decodeTrace( args.trace ): print( line )
+    except Exception as e:
+        print( 'ERROR: {}'.format( e ) )
+        sys.exit( 1 )
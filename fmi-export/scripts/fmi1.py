@@ -10,26 +10,21 @@
 # Get templates for the XML model description depending on the FMI version.
 def fmi1GetModelDescriptionTemplates( verbose, modules ):
     # Template string for XML model description header.
-    header = '<?xml version="1.0" encoding="UTF-8"?>\n<fmiModelDescription fmiVersion="1.0" modelName="__MODEL_NAME__" modelIdentifier="__MODEL_IDENTIFIER__" description="NS3 FMI CS export" generationTool="FMI++ NS3 Export Utility" generationDateAndTime="__DATE_AND_TIME__" variableNamingConvention="flat" numberOfContinuousStates="0" numberOfEventIndicators="0" author="__USER__" guid="{__GUID__}">\n\t<VendorAnnotations>\n\t\t<Tool name="waf">\n\t\t\t<Executable preArguments="--run" arguments="__SCRIPT_NAME__" executableURI="__WAF_URI__"/>\n\t\t</Tool>\n\t</VendorAnnotations>\n\t<ModelVariables>\n'
+    header = '<?xml version="1.0" encoding="UTF-8"?>\n<fmiModelDescription fmiVersion="1.0" modelName="__MODEL_NAME__" modelIdentifier="__MODEL_IDENTIFIER__" description="NS3 FMI CS export" generationTool="FMI++ NS3 Export Utility" generationDateAndTime="__DATE_AND_TIME__" variableNamingConvention="flat" numberOfContinuousStates="0" numberOfEventIndicators="0" author="__USER__" guid="{__GUID__}">\n\t<VendorAnnotations>\n\t\t<Tool name="waf">\n\t\t\t<Executable preArguments="__PRE_ARGUMENTS__" arguments="" executableURI="__EXECUTABLE_URI__"/>\n\t\t</Tool>\n\t</VendorAnnotations>\n\t<ModelVariables>\n'
 
     # Template string for XML model description of scalar variables.
     scalar_variable_node = '\t\t<ScalarVariable name="__VAR_NAME__" valueReference="__VAL_REF__" variability="__VARIABILITY__" causality="__CAUSALITY__">\n\t\t\t<__VAR_TYPE____START_VALUE__/>\n\t\t</ScalarVariable>\n'
 
     # Template string for XML model description footer.
-    footer = '\t</ModelVariables>\n\t<Implementation>\n\t\t<CoSimulation_Tool>\n\t\t\t<Capabilities canHandleVariableCommunicationStepSize="true" canHandleEvents="true" canRejectSteps="false" canInterpolateInputs="false" maxOutputDerivativeOrder="0" canRunAsynchronuously="false" canBeInstantiatedOnlyOncePerProcess="true" canNotUseMemoryManagementFunctions="true"/>\n\t\t\t<Model entryPoint="" manualStart="false" type="application/x-waf">__ADDITIONAL_FILES__\n\t\t\t</Model>\n\t\t</CoSimulation_Tool>\n\t</Implementation>\n</fmiModelDescription>'
+    footer = '\t</ModelVariables>\n\t<Implementation>\n\t\t<CoSimulation_Tool>\n\t\t\t<Capabilities canHandleVariableCommunicationStepSize="true" canHandleEvents="true" canRejectSteps="false" canInterpolateInputs="false" maxOutputDerivativeOrder="0" canRunAsynchronuously="false" canBeInstantiatedOnlyOncePerProcess="true" canNotUseMemoryManagementFunctions="true"/>\n\t\t\t<Model entryPoint="" manualStart="false" type="application/x-executable">__ADDITIONAL_FILES__\n\t\t\t</Model>\n\t\t</CoSimulation_Tool>\n\t</Implementation>\n</fmiModelDescription>'
 
     return ( header, scalar_variable_node, footer )
 
 
-# Add URI to waf.
-def fmi1AddWafUriToModelDescription( waf_uri, header, footer, verbose, modules ):
-    header = header.replace( '__WAF_URI__', waf_uri )
-    return ( header, footer )
-
-
-# Add name of script as input argument to waf.
-def fmi1AddScriptToModelDescription( script_name, header, footer, vebose, modules ):
-    header = header.replace( '__SCRIPT_NAME__', script_name )
+# Add URI of the executable (the compiled ns-3 script, which is launched directly, or the zygote launcher).
+def fmi1AddExecutableUriToModelDescription( executable_uri, pre_arguments, header, footer, verbose, modules ):
+    header = header.replace( '__EXECUTABLE_URI__', executable_uri )
+    header = header.replace( '__PRE_ARGUMENTS__', pre_arguments )
     return ( header, footer )
 
 
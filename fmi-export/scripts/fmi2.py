@@ -10,7 +10,7 @@
 # Get templates for the XML model description depending on the FMI version.
 def fmi2GetModelDescriptionTemplates( verbose, modules ):
     # Template string for XML model description header.
-    header = '<?xml version="1.0" encoding="UTF-8"?>\n<fmiModelDescription\n\txmlns:xsi="http://www.w3.org/2001/XMLSchema-instance"\n\tfmiVersion="2.0"\n\tmodelName="__MODEL_NAME__"\n\tguid="{__GUID__}"\n\tgenerationTool="FMI++ NS3 Export Utility"\n\tauthor="__USER__"\n\tgenerationDateAndTime="__DATE_AND_TIME__"\n\tvariableNamingConvention="flat"\n\tnumberOfEventIndicators="0">\n\t<CoSimulation\n\t\tmodelIdentifier="__MODEL_IDENTIFIER__"\n\t\tneedsExecutionTool="true"\n\t\tcanHandleVariableCommunicationStepSize="false"\n\t\tcanNotUseMemoryManagementFunctions="true"\n\t\tcanInterpolateInputs="false"\n\t\tmaxOutputDerivativeOrder="0"\n\t\tcanGetAndSetFMUstate="false"\n\t\tprovidesDirectionalDerivative="false"/>\n\t<VendorAnnotations>\n\t\t<Tool name="FMI++Export">\n\t\t\t<Executable\n\t\t\t\texecutableURI="__WAF_URI__"\n\t\t\t\tpreArguments="--run"\n\t\t\t\targuments="__SCRIPT_NAME__"/>__ADDITIONAL_FILES__\n\t\t</Tool>\n\t</VendorAnnotations>\n\t<ModelVariables>\n'
+    header = '<?xml version="1.0" encoding="UTF-8"?>\n<fmiModelDescription\n\txmlns:xsi="http://www.w3.org/2001/XMLSchema-instance"\n\tfmiVersion="2.0"\n\tmodelName="__MODEL_NAME__"\n\tguid="{__GUID__}"\n\tgenerationTool="FMI++ NS3 Export Utility"\n\tauthor="__USER__"\n\tgenerationDateAndTime="__DATE_AND_TIME__"\n\tvariableNamingConvention="flat"\n\tnumberOfEventIndicators="0">\n\t<CoSimulation\n\t\tmodelIdentifier="__MODEL_IDENTIFIER__"\n\t\tneedsExecutionTool="true"\n\t\tcanHandleVariableCommunicationStepSize="true"\n\t\tcanNotUseMemoryManagementFunctions="true"\n\t\tcanInterpolateInputs="false"\n\t\tmaxOutputDerivativeOrder="0"\n\t\tcanGetAndSetFMUstate="false"\n\t\tprovidesDirectionalDerivative="false"/>\n\t<VendorAnnotations>\n\t\t<Tool name="FMI++Export">\n\t\t\t<Executable\n\t\t\t\texecutableURI="__EXECUTABLE_URI__"\n\t\t\t\tpreArguments="__PRE_ARGUMENTS__"\n\t\t\t\targuments=""/>__ADDITIONAL_FILES__\n\t\t</Tool>\n\t</VendorAnnotations>\n\t<ModelVariables>\n'
 
     # Template string for XML model description of scalar variables.
     scalar_variable_node = '\t\t<ScalarVariable name="__VAR_NAME__" valueReference="__VAL_REF__" variability="__VARIABILITY__" causality="__CAUSALITY__" __INITIAL__>\n\t\t\t<__VAR_TYPE____START_VALUE__/>\n\t\t</ScalarVariable>\n'
@@ -21,15 +21,10 @@ def fmi2GetModelDescriptionTemplates( verbose, modules ):
     return ( header, scalar_variable_node, footer )
 
 
-# Add URI to waf.
-def fmi2AddWafUriToModelDescription( waf_uri, header, footer, verbose, modules ):
-    header = header.replace( '__WAF_URI__', waf_uri )
-    return ( header, footer )
-
-
-# Add name of script as input argument to waf.
-def fmi2AddScriptToModelDescription( script_name, header, footer, verbose, modules ):
-    header = header.replace( '__SCRIPT_NAME__', script_name )
+# Add URI of the executable (the compiled ns-3 script, which is launched directly, or the zygote launcher).
+def fmi2AddExecutableUriToModelDescription( executable_uri, pre_arguments, header, footer, verbose, modules ):
+    header = header.replace( '__EXECUTABLE_URI__', executable_uri )
+    header = header.replace( '__PRE_ARGUMENTS__', pre_arguments )
     return ( header, footer )
 
 
@@ -50,19 +45,30 @@ def fmi2AddOptionalFilesToModelDescription( optional_files, header, footer, verb
     return ( header, footer )
 
 
+# Load the ns-3 script compiled as shared library in-process (instead of starting the ns-3 executable).
+def fmi2UseInProcessLibrary( library_name, header, footer, verbose, modules ):
+    header = header.replace( 'needsExecutionTool="true"', 'needsExecutionTool="false"' )
+    executable_start = header.index( '<Executable' )
+    executable_end = header.index( '/>', executable_start ) + 2
+    header = header[ : executable_start ] + '<InProcess library="' + library_name + '"/>' + header[ executable_end : ]
+    if ( True == verbose ): modules.log( '[DEBUG] Added in-process library to model description: ', library_name )
+    return ( header, footer )
+
+
 # Create DLL for FMU.
-def fmi2CreateSharedLibrary( fmi_model_identifier, ns3_fmu_root_dir, verbose, modules ):
+def fmi2CreateSharedLibrary( fmi_model_identifier, ns3_fmu_root_dir, verbose, modules, in_process = False ):
     # Define name of shared library.
     fmu_shared_library_name = str()
     fmi2_shared_library_path = str()
+    fmi2_library = 'fmi2_inprocess' if ( True == in_process ) else 'fmi2'
 
     platform_id = modules.platform.platform().lower()
     if 'linux' in platform_id:
         fmu_shared_library_name = fmi_model_identifier + '.so'
-        fmi2_shared_library_path = modules.os.path.join( ns3_fmu_root_dir, 'lib', 'libfmi2.so' )
+        fmi2_shared_library_path = modules.os.path.join( ns3_fmu_root_dir, 'lib', 'lib' + fmi2_library + '.so' )
     elif 'cygwin' in platform_id:
         fmu_shared_library_name = fmi_model_identifier + '.dll'
-        fmi2_shared_library_path = modules.os.path.join( ns3_fmu_root_dir, 'lib', 'cygfmi2.dll' )
+        fmi2_shared_library_path = modules.os.path.join( ns3_fmu_root_dir, 'lib', 'cyg' + fmi2_library + '.dll' )
 
     if ( False == modules.os.path.isfile( fmi2_shared_library_path ) ):
         modules.log( '\n[ERROR] shared library not found: ', fmi2_shared_library_path )
@@ -0,0 +1,194 @@
+# -----------------------------------------------------------------
+# Copyright (c) 2018, AIT Austrian Institute of Technology GmbH.
+# -----------------------------------------------------------------
+
+#
+# Collection of helper functions for creating FMU CS according to FMI 3.0 (in-process mode only)
+#
+
+
+# Get templates for the XML model description depending on the FMI version.
+def fmi3GetModelDescriptionTemplates( verbose, modules ):
+    # Template string for XML model description header.
+    header = '<?xml version="1.0" encoding="UTF-8"?>\n<fmiModelDescription\n\tfmiVersion="3.0"\n\tmodelName="__MODEL_NAME__"\n\tinstantiationToken="{__GUID__}"\n\tgenerationTool="FMI++ NS3 Export Utility"\n\tauthor="__USER__"\n\tgenerationDateAndTime="__DATE_AND_TIME__"\n\tvariableNamingConvention="flat">\n\t<CoSimulation\n\t\tmodelIdentifier="__MODEL_IDENTIFIER__"\n\t\tneedsExecutionTool="false"\n\t\tcanBeInstantiatedOnlyOncePerProcess="true"\n\t\tcanGetAndSetFMUState="false"\n\t\tcanSerializeFMUState="false"\n\t\tprovidesDirectionalDerivatives="false"\n\t\tprovidesAdjointDerivatives="false"\n\t\tcanHandleVariableCommunicationStepSize="true"\n\t\tmaxOutputDerivativeOrder="0"\n\t\tprovidesIntermediateUpdate="false"\n\t\tmightReturnEarlyFromDoStep="true"\n\t\tcanReturnEarlyAfterIntermediateUpdate="false"\n\t\thasEventMode="true"/>\n\t<ModelVariables>\n\t\t<Float64 name="time" valueReference="0" causality="independent" variability="continuous"/>\n'
+
+    # Template string for XML model description of scalar variables.
+    scalar_variable_node = '\t\t<__VAR_TYPE__ name="__VAR_NAME__" valueReference="__VAL_REF__" variability="__VARIABILITY__" causality="__CAUSALITY__"__CLOCKS____INITIAL____START_VALUE__\n'
+
+    # Template string for XML model description footer.
+    footer = '\t</ModelVariables>\n\t<ModelStructure>__OUTPUTS__\n\t</ModelStructure>\n\t<Annotations>\n\t\t<Annotation type="FMI++Export">__IN_PROCESS____ADDITIONAL_FILES__\n\t\t</Annotation>\n\t</Annotations>\n</fmiModelDescription>'
+
+    return ( header, scalar_variable_node, footer )
+
+
+# FMI 3.0 FMUs are loaded in-process, i.e., there is no executable.
+def fmi3AddExecutableUriToModelDescription( executable_uri, pre_arguments, header, footer, verbose, modules ):
+    return ( header, footer )
+
+
+# Add optional files to XML model description.
+def fmi3AddOptionalFilesToModelDescription( optional_files, header, footer, verbose, modules ):
+    additional_files_description = ''
+    indent = '\n\t\t\t'
+
+    for file_name in optional_files:
+        additional_files_description += indent + '<File file=\"fmu://resources/' + modules.os.path.basename( file_name ) + '\"/>'
+        if ( True == verbose ): modules.log( '[DEBUG] Added additional file to model description: ', modules.os.path.basename( file_name ) )
+
+    footer = footer.replace( '__ADDITIONAL_FILES__', additional_files_description )
+
+    return ( header, footer )
+
+
+# Load the ns-3 script compiled as shared library in-process.
+def fmi3UseInProcessLibrary( library_name, header, footer, verbose, modules ):
+    footer = footer.replace( '__IN_PROCESS__', '\n\t\t\t<InProcess library="' + library_name + '"/>' )
+    if ( True == verbose ): modules.log( '[DEBUG] Added in-process library to model description: ', library_name )
+    return ( header, footer )
+
+
+# Create the variable descriptions. Messages are exchanged via clocks, i.e., every integer input (output)
+# associated to messages is clocked by an input (output) clock. These are the first integer inputs (outputs),
+# their numbers are given by message_counts (all integer inputs and outputs in case message_counts is None).
+# String inputs and outputs are binary variables (raw bytes, e.g., payloads), string parameters remain strings.
+# Value references for clocks start with 3001 (after all other variables).
+def fmi3CreateModelVariables( fmi_input_vars, fmi_output_vars, fmi_params, start_values, message_counts, scalar_variable_node, footer, verbose, modules ):
+    variables = ''
+    clocks = ''
+    outputs = ''
+    output_clocks = ''
+    initial_unknowns = ''
+
+    # Value references for inputs start with 1, for outputs with 1001 and for parameters with 2001 (except
+    # there are already value references with corresponding values).
+    groups = [ ( 'input', 1, fmi_input_vars ), ( 'output', 1001, fmi_output_vars ), ( 'parameter', 2001, fmi_params ) ]
+
+    clock_val_ref = 1
+    for ( causality, first_val_ref, fmi_vars ) in groups:
+        clock_val_ref = max( clock_val_ref, first_val_ref ) + sum( len( var_list ) for var_list in fmi_vars.values() )
+    clock_val_ref = max( clock_val_ref, 3001 )
+
+    if ( None == message_counts ):
+        message_counts = ( len( fmi_input_vars.get( 'IntegerInputs', [] ) ), len( fmi_output_vars.get( 'IntegerOutputs', [] ) ) )
+    n_messages = { 'input': message_counts[0], 'output': message_counts[1] }
+
+    var_ref = 1
+    for ( causality, first_val_ref, fmi_vars ) in groups:
+        var_ref = max( var_ref, first_val_ref )
+        for var_type, var_list in fmi_vars.items():
+            for ( index, var ) in enumerate( var_list ):
+                element = fmi3GetScalarVariableType( var_type )
+                variable_description = scalar_variable_node
+                variable_description = variable_description.replace( '__VAR_TYPE__', element )
+                variable_description = variable_description.replace( '__VAR_NAME__', var )
+                variable_description = variable_description.replace( '__VAL_REF__', str( var_ref ) )
+                variable_description = variable_description.replace( '__VARIABILITY__', fmi3GetScalarVariableVariability( var_type, modules ) )
+                variable_description = variable_description.replace( '__CAUSALITY__', fmi3GetScalarVariableCausality( var_type, modules ) )
+
+                # Messages (integer inputs and outputs associated to messages) are clocked.
+                if ( 'Int32' == element ) and ( causality in n_messages ) and ( index < n_messages[causality] ):
+                    clocks += '\t\t<Clock name="' + var + '_clock" valueReference="' + str( clock_val_ref ) + '" causality="' + causality + '" intervalVariability="triggered"/>\n'
+                    variable_description = variable_description.replace( '__CLOCKS__', ' clocks="' + str( clock_val_ref ) + '"' )
+                    if ( 'output' == causality ): output_clocks += '\n\t\t<Output valueReference="' + str( clock_val_ref ) + '"/>'
+                    clock_val_ref += 1
+                else:
+                    variable_description = variable_description.replace( '__CLOCKS__', '' )
+
+                if ( 'output' == causality ): outputs += '\n\t\t<Output valueReference="' + str( var_ref ) + '"/>'
+
+                initial = ''
+                if ( 'output' == causality ) and ( var in start_values ):
+                    initial = ' initial="exact"'
+                elif ( 'output' == causality ):
+                    initial_unknowns += '\n\t\t<InitialUnknown valueReference="' + str( var_ref ) + '"/>'
+                variable_description = variable_description.replace( '__INITIAL__', initial )
+
+                if var in start_values:
+                    variable_description = variable_description.replace( '__START_VALUE__', fmi3GetStartValue( element, start_values[var] ) )
+                    if ( True == verbose ): modules.log( '[DEBUG] Added start value to model description: ', var, '=', start_values[var] )
+                else:
+                    variable_description = variable_description.replace( '__START_VALUE__', '/>' )
+
+                variables += variable_description
+                var_ref += 1
+
+    footer = footer.replace( '__OUTPUTS__', outputs + output_clocks + initial_unknowns )
+
+    return ( variables + clocks, footer )
+
+
+# Start value of a variable (closes the variable's XML element). The start values of string and binary
+# variables are defined by child elements, binary values are encoded as hex string.
+def fmi3GetStartValue( element, value ):
+    if ( 'String' == element ):
+        return '>\n\t\t\t<Start value="' + value + '"/>\n\t\t</String>'
+    elif ( 'Binary' == element ):
+        return '>\n\t\t\t<Start value="' + ''.join( '{0:02x}'.format( b ) for b in bytearray( value.encode( 'utf-8' ) ) ) + '"/>\n\t\t</Binary>'
+    return ' start="' + value + '"/>'
+
+
+# Create DLL for FMU.
+def fmi3CreateSharedLibrary( fmi_model_identifier, ns3_fmu_root_dir, verbose, modules ):
+    # Define name of shared library.
+    fmu_shared_library_name = str()
+    fmi3_shared_library_path = str()
+
+    platform_id = modules.platform.platform().lower()
+    if 'linux' in platform_id:
+        fmu_shared_library_name = fmi_model_identifier + '.so'
+        fmi3_shared_library_path = modules.os.path.join( ns3_fmu_root_dir, 'lib', 'libfmi3_inprocess.so' )
+    elif 'cygwin' in platform_id:
+        fmu_shared_library_name = fmi_model_identifier + '.dll'
+        fmi3_shared_library_path = modules.os.path.join( ns3_fmu_root_dir, 'lib', 'cygfmi3_inprocess.dll' )
+
+    if ( False == modules.os.path.isfile( fmi3_shared_library_path ) ):
+        modules.log( '\n[ERROR] shared library not found (FMI 3.0 headers available during configuration?): ', fmi3_shared_library_path )
+        raise Exception( 16 )
+    modules.shutil.copy( fmi3_shared_library_path, fmu_shared_library_name )
+
+    if ( False == modules.os.path.isfile( fmu_shared_library_name ) ):
+        modules.log( '\n[ERROR] Not able to create shared library: ', fmu_shared_library_name )
+        raise Exception( 17 )
+
+    return fmu_shared_library_name
+
+
+# Retrieve the platform tuple (name of the FMU's binaries directory).
+def fmi3GetPlatformType( modules ):
+    platform_id = modules.platform.platform().lower()
+    architecture = 'x86_64' if ( '64' == modules.platform.architecture()[0][:2] ) else 'x86'
+    if 'linux' in platform_id:
+        return architecture + '-linux'
+    elif ( 'cygwin' in platform_id ) or ( 'windows' in platform_id ):
+        return architecture + '-windows'
+    return None
+
+
+# Retrieve type of scalar variable from JSON-file label.
+def fmi3GetScalarVariableType( label ):
+    if label.startswith( 'Real' ):
+        return 'Float64'
+    elif label.startswith( 'Integer' ):
+        return 'Int32'
+    elif label.startswith( 'Boolean' ):
+        return 'Boolean'
+    elif label.startswith( 'String' ):
+        return 'String' if label.endswith( 'Parameters' ) else 'Binary'
+
+
+# Retrieve variability of scalar variable from JSON-file label.
+def fmi3GetScalarVariableVariability( label, modules ):
+    for label_type in [ 'Inputs', 'Outputs' ]:
+        if label_type in label:
+            return 'discrete' # all inputs/outputs to ns-3 FMUs are of type 'discrete'
+    return 'fixed'
+
+
+# Retrieve causality of scalar variable from JSON-file label.
+def fmi3GetScalarVariableCausality( label, modules ):
+    if 'Inputs' in label:
+        return 'input'
+    elif 'Outputs' in label:
+        return 'output'
+    else:
+        return 'parameter'
@@ -9,9 +9,12 @@
 ### Import helper functions for specific FMI versions.
 from .fmi1 import *
 from .fmi2 import *
+from .fmi3 import *
+from .utils import getNs3Libraries, getZygoteLauncher
 
 
 def generateNs3FMU( script_name,
+    ns3_executable,
     fmi_version,
     fmi_model_identifier,
     fmi_input_vars,
@@ -25,11 +28,17 @@ def generateNs3FMU( script_name,
     fmipp_lib_dir,
     verbose,
     litter,
-    modules ) :
+    modules,
+    in_process_library = None,
+    bundle_libraries = False,
+    zygote = False,
+    shared_process = False,
+    message_counts = None ) :
     """Generate an FMU for ns-3.
 
     Keyword arguments:
         script_name -- name of ns-3 script (string)
+        ns3_executable -- path to the compiled ns-3 script (string)
         fmi_version -- FMI version (string)
         fmi_model_identifier -- FMI model identfier for FMU (string)
         fmi_input_vars -- definition of input variable names (dict: key = type, value = name)
@@ -44,16 +53,47 @@ def generateNs3FMU( script_name,
         verbose -- verbosity flag (boolean)
         litter -- do not clean-up intermediate files (boolean)
         modules -- named tuple containing all imported modules
+        in_process_library -- ns-3 script compiled as shared library for in-process FMUs (string, optional)
+        bundle_libraries -- copy the executable and the ns-3 libraries to the FMU (boolean, optional)
+        zygote -- fork backend instances from a pre-initialized zygote via the launcher (boolean, optional)
+        shared_process -- host all backend instances in the zygote's process (boolean, optional, requires zygote)
+        message_counts -- number of integer inputs and outputs associated to messages (tuple of integers, optional)
     """
 
+    # The FMU launches the compiled ns-3 script directly, either from the ns-3 build directory or
+    # from the FMU's resources directory (together with all ns-3 libraries).
+    bundled_files = []
+    if ( True == bundle_libraries ):
+        bundled_files = getNs3Libraries( ns3_install_dir, fmipp_lib_dir, modules )
+        if ( None == in_process_library ): bundled_files.append( ns3_executable )
+        executable_uri = 'fmu://resources/' + modules.os.path.basename( ns3_executable )
+    else:
+        executable_uri = modules.urlparse.urljoin( 'file:', modules.urllib.pathname2url( ns3_executable ) )
+
+    # With a zygote, the FMU starts the launcher instead, which takes the executable as first argument
+    # (relative to the launcher's directory in case the launcher is bundled with the FMU).
+    pre_arguments = ''
+    if ( True == zygote ):
+        launcher = getZygoteLauncher( ns3_fmu_root_dir, modules )
+        if ( True == bundle_libraries ):
+            bundled_files.append( launcher )
+            pre_arguments = modules.os.path.basename( ns3_executable )
+            executable_uri = 'fmu://resources/' + modules.os.path.basename( launcher )
+        else:
+            pre_arguments = ns3_executable
+            executable_uri = modules.urlparse.urljoin( 'file:', modules.urllib.pathname2url( launcher ) )
+        if ( True == shared_process ): pre_arguments = '--shared ' + pre_arguments
+        if ( True == verbose ): modules.log( '[DEBUG] Using zygote launcher: ', launcher )
+
     # Create FMU model description.
     model_description_name = \
-        createModelDescription( fmi_version, fmi_model_identifier, script_name, ns3_install_dir,
-            fmi_input_vars, fmi_output_vars, fmi_params, start_values, optional_files, verbose, modules )
+        createModelDescription( fmi_version, fmi_model_identifier, script_name, executable_uri, pre_arguments,
+            fmi_input_vars, fmi_output_vars, fmi_params, start_values, optional_files, verbose, modules,
+            in_process_library, message_counts )
 
     # Create FMU shared library.
     fmu_shared_library_name = createSharedLibrary( fmi_model_identifier, fmi_version, ns3_fmu_root_dir,
-        fmipp_include_dir, fmipp_lib_dir, verbose, modules )
+        fmipp_include_dir, fmipp_lib_dir, verbose, modules, None != in_process_library )
 
     # Check if working directory for FMU creation already exists.
     if ( True == modules.os.path.isdir( fmi_model_identifier ) ):
@@ -63,13 +103,16 @@ def generateNs3FMU( script_name,
     platform_type = str()
     platform_id = modules.platform.platform().lower()
     platform_bits = modules.platform.architecture()[0][:2]
-    if 'linux' in platform_id:
+    if ( '3' == fmi_version ): # FMI 3.0 uses platform tuples (e.g., 'x86_64-linux').
+        platform_type = fmi3GetPlatformType( modules )
+    elif 'linux' in platform_id:
         platform_type = 'linux' + platform_bits
     elif 'cygwin' in platform_id:
         platform_type = 'cygwin' + platform_bits
     elif 'windows' in platform_id:
         platform_type = 'win' + platform_bits
-    else:
+
+    if ( None == platform_type ) or ( 0 == len( platform_type ) ):
         modules.log( '\n[ERROR] platform not supported: ', modules.platform.platform() )
         modules.sys.exit(6)
 
@@ -89,6 +132,10 @@ def generateNs3FMU( script_name,
     modules.shutil.copy( model_description_name, fmi_model_identifier ) # XML model description.
     for file_name in optional_files: # Additional files.
         modules.shutil.copy( file_name, resources_dir )
+    if ( None != in_process_library ): # ns-3 script compiled as shared library.
+        modules.shutil.copy( in_process_library, resources_dir )
+    for file_name in bundled_files: # Executable and libraries.
+        modules.shutil.copy( file_name, resources_dir )
     modules.shutil.copy( fmu_shared_library_name, binaries_dir ) # FMU DLL.
 
     # Create ZIP archive.
@@ -119,14 +166,17 @@ def createModelDescription(
         fmi_version,
         fmi_model_identifier,
         script_name,
-        ns3_install_dir,
+        executable_uri,
+        pre_arguments,
         fmi_input_vars,
         fmi_output_vars,
         fmi_params,
         start_values,
         optional_files,
         verbose,
-        modules ):
+        modules,
+        in_process_library = None,
+        message_counts = None ):
 
     # Retrieve templates for different parts of XML model description according to FMI version.
     ( model_description_header, scalar_variable_node, model_description_footer ) = getModelDescriptionTemplates( fmi_version, verbose, modules )
@@ -148,86 +198,91 @@ def createModelDescription(
     # GUID.
     model_description_header = model_description_header.replace( '__GUID__', str( modules.uuid.uuid1() ) )
 
-    # URI of ns-3 main executable (waf).
-    waf_uri = modules.urlparse.urljoin( 'file:', modules.urllib.pathname2url( ns3_install_dir ) ) + '/waf'
+    # URI of the executable (compiled ns-3 script).
     ( model_description_header, model_description_footer ) = \
-        addWafUriToModelDescription( waf_uri, model_description_header, model_description_footer, fmi_version, verbose, modules )
+        addExecutableUriToModelDescription( executable_uri, pre_arguments, model_description_header, model_description_footer, fmi_version, verbose, modules )
 
     # Define a string to collect all scalar variable definitions.
     model_description_scalars = ''
 
-    # Add scalar input variables description. Value references for inputs start with 1.
-    input_val_ref = 1
-    for var_type, var_list in fmi_input_vars.items():
-        for var in var_list:
-            scalar_variable_description = scalar_variable_node
-            scalar_variable_description = scalar_variable_description.replace( '__VAR_TYPE__', getScalarVariableType( var_type ) )
-            scalar_variable_description = scalar_variable_description.replace( '__VARIABILITY__', getScalarVariableVariability( var_type, fmi_version, modules ) )
-            scalar_variable_description = scalar_variable_description.replace( '__VAR_NAME__', var )
-            scalar_variable_description = scalar_variable_description.replace( '__CAUSALITY__', "input" )
-            scalar_variable_description = scalar_variable_description.replace( '__VAL_REF__', str( input_val_ref ) )
-            scalar_variable_description = scalar_variable_description.replace( '__INITIAL__', '' )
-            if var in start_values:
-                start_value_description = ' start=\"' + start_values[var] + '\"'
-                scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', start_value_description )
-                if ( True == verbose ): modules.log( '[DEBUG] Added start value to model description: ', var, '=', start_values[var] )
-            else:
-                scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', '' )
-            input_val_ref += 1
-            # Write scalar variable description to file.
-            model_description_scalars += scalar_variable_description;
-
-    # Add scalar output variables description. Value references for outputs start with 1001 (except there are already input value references with corresponding values).
-    output_val_ref = 1001 if ( input_val_ref < 1001 ) else input_val_ref
-    for var_type, var_list in fmi_output_vars.items():
-        for var in var_list:
-            scalar_variable_description = scalar_variable_node
-            scalar_variable_description = scalar_variable_description.replace( '__VAR_TYPE__', getScalarVariableType( var_type ) )
-            scalar_variable_description = scalar_variable_description.replace( '__VARIABILITY__', getScalarVariableVariability( var_type, fmi_version, modules ) )
-            scalar_variable_description = scalar_variable_description.replace( '__VAR_NAME__', var )
-            scalar_variable_description = scalar_variable_description.replace( '__CAUSALITY__', "output" )
-            scalar_variable_description = scalar_variable_description.replace( '__VAL_REF__', str( output_val_ref ) )
-            if var in start_values:
-                start_value_description = ' start=\"' + start_values[var] + '\"'
-                scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', start_value_description )
-                scalar_variable_description = scalar_variable_description.replace( '__INITIAL__', 'initial="exact"' )
-                if ( True == verbose ): modules.log( '[DEBUG] Added start value to model description: ', var, '=', start_values[var] )
-            else:
-                scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', '' )
+    # FMI 3.0 uses typed variable elements and exchanges messages via clocks.
+    if ( '3' == fmi_version ):
+        ( model_description_scalars, model_description_footer ) = fmi3CreateModelVariables(
+            fmi_input_vars, fmi_output_vars, fmi_params, start_values, message_counts, scalar_variable_node, model_description_footer, verbose, modules )
+    else:
+        # Add scalar input variables description. Value references for inputs start with 1.
+        input_val_ref = 1
+        for var_type, var_list in fmi_input_vars.items():
+            for var in var_list:
+                scalar_variable_description = scalar_variable_node
+                scalar_variable_description = scalar_variable_description.replace( '__VAR_TYPE__', getScalarVariableType( var_type ) )
+                scalar_variable_description = scalar_variable_description.replace( '__VARIABILITY__', getScalarVariableVariability( var_type, fmi_version, modules ) )
+                scalar_variable_description = scalar_variable_description.replace( '__VAR_NAME__', var )
+                scalar_variable_description = scalar_variable_description.replace( '__CAUSALITY__', "input" )
+                scalar_variable_description = scalar_variable_description.replace( '__VAL_REF__', str( input_val_ref ) )
                 scalar_variable_description = scalar_variable_description.replace( '__INITIAL__', '' )
-            output_val_ref += 1
-            # Write scalar variable description to file.
-            model_description_scalars += scalar_variable_description;
-
-    # Add scalar parameter description. Value references for inputs start with 2001.
-    param_val_ref = 2001 if ( output_val_ref < 2001 ) else output_val_ref
-    for var_type, var_list in fmi_params.items():
-        for var in var_list:
-            scalar_variable_description = scalar_variable_node
-            scalar_variable_description = scalar_variable_description.replace( '__VAR_TYPE__', getScalarVariableType( var_type ) )
-            scalar_variable_description = scalar_variable_description.replace( '__VARIABILITY__', getScalarVariableVariability( var_type, fmi_version, modules ) )
-            scalar_variable_description = scalar_variable_description.replace( '__VAR_NAME__', var )
-            scalar_variable_description = scalar_variable_description.replace( '__CAUSALITY__', getScalarVariableCausality( var_type, fmi_version, modules ) )
-            scalar_variable_description = scalar_variable_description.replace( '__VAL_REF__', str( param_val_ref ) )
-            scalar_variable_description = scalar_variable_description.replace( '__INITIAL__', '' )
-            if var in start_values:
-                start_value_description = ' start=\"' + start_values[var] + '\"'
-                scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', start_value_description )
-                if ( True == verbose ): modules.log( '[DEBUG] Added start value to model description: ', var, '=', start_values[var] )
-            else:
-                scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', '' )
-            param_val_ref += 1
-            # Write scalar variable description to file.
-            model_description_scalars += scalar_variable_description;
-
-    # Add name of script as input argument to waf.
-    ( model_description_header, model_description_footer ) = \
-        addScriptToModelDescription( script_name, model_description_header, model_description_footer, fmi_version, verbose, modules )
+                if var in start_values:
+                    start_value_description = ' start=\"' + start_values[var] + '\"'
+                    scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', start_value_description )
+                    if ( True == verbose ): modules.log( '[DEBUG] Added start value to model description: ', var, '=', start_values[var] )
+                else:
+                    scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', '' )
+                input_val_ref += 1
+                # Write scalar variable description to file.
+                model_description_scalars += scalar_variable_description;
+
+        # Add scalar output variables description. Value references for outputs start with 1001 (except there are already input value references with corresponding values).
+        output_val_ref = 1001 if ( input_val_ref < 1001 ) else input_val_ref
+        for var_type, var_list in fmi_output_vars.items():
+            for var in var_list:
+                scalar_variable_description = scalar_variable_node
+                scalar_variable_description = scalar_variable_description.replace( '__VAR_TYPE__', getScalarVariableType( var_type ) )
+                scalar_variable_description = scalar_variable_description.replace( '__VARIABILITY__', getScalarVariableVariability( var_type, fmi_version, modules ) )
+                scalar_variable_description = scalar_variable_description.replace( '__VAR_NAME__', var )
+                scalar_variable_description = scalar_variable_description.replace( '__CAUSALITY__', "output" )
+                scalar_variable_description = scalar_variable_description.replace( '__VAL_REF__', str( output_val_ref ) )
+                if var in start_values:
+                    start_value_description = ' start=\"' + start_values[var] + '\"'
+                    scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', start_value_description )
+                    scalar_variable_description = scalar_variable_description.replace( '__INITIAL__', 'initial="exact"' )
+                    if ( True == verbose ): modules.log( '[DEBUG] Added start value to model description: ', var, '=', start_values[var] )
+                else:
+                    scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', '' )
+                    scalar_variable_description = scalar_variable_description.replace( '__INITIAL__', '' )
+                output_val_ref += 1
+                # Write scalar variable description to file.
+                model_description_scalars += scalar_variable_description;
+
+        # Add scalar parameter description. Value references for inputs start with 2001.
+        param_val_ref = 2001 if ( output_val_ref < 2001 ) else output_val_ref
+        for var_type, var_list in fmi_params.items():
+            for var in var_list:
+                scalar_variable_description = scalar_variable_node
+                scalar_variable_description = scalar_variable_description.replace( '__VAR_TYPE__', getScalarVariableType( var_type ) )
+                scalar_variable_description = scalar_variable_description.replace( '__VARIABILITY__', getScalarVariableVariability( var_type, fmi_version, modules ) )
+                scalar_variable_description = scalar_variable_description.replace( '__VAR_NAME__', var )
+                scalar_variable_description = scalar_variable_description.replace( '__CAUSALITY__', getScalarVariableCausality( var_type, fmi_version, modules ) )
+                scalar_variable_description = scalar_variable_description.replace( '__VAL_REF__', str( param_val_ref ) )
+                scalar_variable_description = scalar_variable_description.replace( '__INITIAL__', '' )
+                if var in start_values:
+                    start_value_description = ' start=\"' + start_values[var] + '\"'
+                    scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', start_value_description )
+                    if ( True == verbose ): modules.log( '[DEBUG] Added start value to model description: ', var, '=', start_values[var] )
+                else:
+                    scalar_variable_description = scalar_variable_description.replace( '__START_VALUE__', '' )
+                param_val_ref += 1
+                # Write scalar variable description to file.
+                model_description_scalars += scalar_variable_description;
 
     # Optional files.
     ( model_description_header, model_description_footer ) = \
         addOptionalFilesToModelDescription( model_description_header, model_description_footer, optional_files, fmi_version, verbose, modules)
 
+    # Load the script in-process instead of starting the ns-3 executable.
+    if ( None != in_process_library ):
+        ( model_description_header, model_description_footer ) = \
+            useInProcessLibrary( modules.os.path.basename( in_process_library ), model_description_header, model_description_footer, fmi_version, verbose, modules )
+
     # Create new XML model description file.
     model_description_name = 'modelDescription.xml'
     model_description = open( model_description_name, 'w' )
@@ -245,22 +300,18 @@ def getModelDescriptionTemplates( fmi_version, verbose, modules ):
        return fmi1GetModelDescriptionTemplates( verbose, modules )
     elif ( '2' == fmi_version ): # FMI 2.0
         return fmi2GetModelDescriptionTemplates( verbose, modules )
+    elif ( '3' == fmi_version ): # FMI 3.0
+        return fmi3GetModelDescriptionTemplates( verbose, modules )
 
 
-# Add URI to waf.
-def addWafUriToModelDescription( waf_uri, header, footer, fmi_version, verbose, modules ):
-    if ( '1' == fmi_version ): # FMI 1.0
-        return fmi1AddWafUriToModelDescription( waf_uri, header, footer, verbose, modules )
-    elif ( '2' == fmi_version ): # FMI 2.0
-        return fmi2AddWafUriToModelDescription( waf_uri, header, footer, verbose, modules )
-
-
-# Add name of script as input argument to waf.
-def addScriptToModelDescription( script_name, header, footer, fmi_version, verbose, modules ):
+# Add URI of the executable (compiled ns-3 script).
+def addExecutableUriToModelDescription( executable_uri, pre_arguments, header, footer, fmi_version, verbose, modules ):
     if ( '1' == fmi_version ): # FMI 1.0
-        return fmi1AddScriptToModelDescription( script_name, header, footer, verbose, modules )
+        return fmi1AddExecutableUriToModelDescription( executable_uri, pre_arguments, header, footer, verbose, modules )
     elif ( '2' == fmi_version ): # FMI 2.0
-        return fmi2AddScriptToModelDescription( script_name, header, footer, verbose, modules )
+        return fmi2AddExecutableUriToModelDescription( executable_uri, pre_arguments, header, footer, verbose, modules )
+    elif ( '3' == fmi_version ): # FMI 3.0
+        return fmi3AddExecutableUriToModelDescription( executable_uri, pre_arguments, header, footer, verbose, modules )
 
 
 # Add optional files to XML model description.
@@ -269,14 +320,26 @@ def addOptionalFilesToModelDescription( header, footer, optional_files, fmi_vers
         return fmi1AddOptionalFilesToModelDescription( optional_files, header, footer, verbose, modules )
     if ( '2' == fmi_version ):
         return fmi2AddOptionalFilesToModelDescription( optional_files, header, footer, verbose, modules )
+    if ( '3' == fmi_version ):
+        return fmi3AddOptionalFilesToModelDescription( optional_files, header, footer, verbose, modules )
+
+
+# Load the ns-3 script compiled as shared library in-process (instead of starting the ns-3 executable).
+def useInProcessLibrary( library_name, header, footer, fmi_version, verbose, modules ):
+    if ( '2' == fmi_version ):
+        return fmi2UseInProcessLibrary( library_name, header, footer, verbose, modules )
+    if ( '3' == fmi_version ):
+        return fmi3UseInProcessLibrary( library_name, header, footer, verbose, modules )
 
 
 # Create DLL for FMU.
-def createSharedLibrary( fmi_model_identifier, fmi_version, ns3_fmu_root_dir, fmipp_include_dir, fmipp_lib_dir, verbose, modules ):
+def createSharedLibrary( fmi_model_identifier, fmi_version, ns3_fmu_root_dir, fmipp_include_dir, fmipp_lib_dir, verbose, modules, in_process = False ):
     if ( '1' == fmi_version ):
         return fmi1CreateSharedLibrary( fmi_model_identifier, ns3_fmu_root_dir, fmipp_include_dir, fmipp_lib_dir, verbose, modules )
     if ( '2' == fmi_version ):
-        return fmi2CreateSharedLibrary( fmi_model_identifier, ns3_fmu_root_dir, verbose, modules )
+        return fmi2CreateSharedLibrary( fmi_model_identifier, ns3_fmu_root_dir, verbose, modules, in_process )
+    if ( '3' == fmi_version ):
+        return fmi3CreateSharedLibrary( fmi_model_identifier, ns3_fmu_root_dir, verbose, modules )
 
 
 # Retrieve variability of scalar variable from JSON-file label.
@@ -285,6 +348,8 @@ def getScalarVariableVariability( label, fmi_version, modules ):
         return fmi1GetScalarVariableVariability( label, modules )
     if ( '2' == fmi_version ):
         return fmi2GetScalarVariableVariability( label, modules )
+    if ( '3' == fmi_version ):
+        return fmi3GetScalarVariableVariability( label, modules )
 
 
 # Retrieve causality of scalar variable from JSON-file label.
@@ -293,6 +358,8 @@ def getScalarVariableCausality( label, fmi_version, modules ):
         return fmi1GetScalarVariableCausality( label, modules )
     if ( '2' == fmi_version ):
         return fmi2GetScalarVariableCausality( label, modules )
+    if ( '3' == fmi_version ):
+        return fmi3GetScalarVariableCausality( label, modules )
 
 
 # Retrieve type of scalar variable from JSON-file label.
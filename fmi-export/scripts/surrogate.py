@@ -0,0 +1,151 @@
+# -----------------------------------------------------------------
+# Copyright (c) 2018, AIT Austrian Institute of Technology GmbH.
+# -----------------------------------------------------------------
+
+#
+# Collection of helper functions for creating surrogate delay tables for ns-3 FMUs.
+#
+
+import struct
+
+
+# Name of the surrogate delay table (in the FMU's resources directory).
+SURROGATE_TABLE_FILE_NAME = 'surrogate-delays.bin'
+
+
+# Create a surrogate delay table by running the ns-3 script offline (and optionally validate it).
+def createSurrogateTable(
+        ns3_executable,
+        ns3_install_dir,
+        fmi_input_vars,
+        fmi_output_vars,
+        fmi_params,
+        start_values,
+        seeds,
+        message_sizes,
+        validate,
+        fmi_model_identifier,
+        verbose,
+        modules ):
+
+    table_file_path = modules.os.path.abspath( SURROGATE_TABLE_FILE_NAME )
+
+    # Only start values of parameters are passed to the ns-3 script.
+    param_names = [ name for names in fmi_params.values() for name in names ]
+    param_values = [ '{0}={1}'.format( name, start_values[name] ) for name in param_names if name in start_values ]
+
+    runSurrogateTableGeneration( ns3_executable, ns3_install_dir, table_file_path,
+        seeds, 0, message_sizes, param_values, verbose, modules )
+
+    if ( True == validate ):
+        # Run the simulations again with different seeds, which serve as reference.
+        reference_file_path = modules.os.path.abspath( fmi_model_identifier + '-surrogate-reference.bin' )
+        runSurrogateTableGeneration( ns3_executable, ns3_install_dir, reference_file_path,
+            seeds, seeds, message_sizes, param_values, verbose, modules )
+
+        report_file_path = fmi_model_identifier + '-surrogate-report.txt'
+        writeSurrogateValidationReport( readSurrogateTable( table_file_path ), readSurrogateTable( reference_file_path ),
+            fmi_input_vars.get( 'IntegerInputs', [] ), fmi_output_vars.get( 'IntegerOutputs', [] ), report_file_path, modules )
+        modules.os.remove( reference_file_path )
+
+        if ( True == verbose ): modules.log( '[DEBUG] Wrote validation report for surrogate delay table:', report_file_path )
+
+    return table_file_path
+
+
+# Execute the compiled ns-3 script (directly, i.e., without waf) for generating a surrogate delay table.
+def runSurrogateTableGeneration( ns3_executable, ns3_install_dir, table_file_path, seeds, seed_offset, message_sizes, param_values, verbose, modules ):
+    script_args = [ ns3_executable,
+        '--generate-surrogate-table=' + table_file_path,
+        '--surrogate-seeds=' + str( seeds ),
+        '--surrogate-seed-offset=' + str( seed_offset ) ]
+    if ( None != message_sizes ):
+        script_args.append( '--surrogate-message-sizes=' + message_sizes )
+    script_args += param_values
+
+    exit_code = modules.subprocess.call( script_args, cwd=ns3_install_dir )
+    if ( 0 != exit_code ) or ( False == modules.os.path.isfile( table_file_path ) ):
+        modules.log( '[ERROR] generation of surrogate delay table failed' )
+        modules.sys.exit(10)
+    elif ( True == verbose ):
+        modules.log( '[DEBUG] successfully created surrogate delay table:', table_file_path )
+
+
+# Read a surrogate delay table (returns a dict with keys (sender, size, receiver) and lists of delays in seconds, None for lost messages).
+def readSurrogateTable( table_file_path ):
+    with open( table_file_path, 'rb' ) as table_file:
+        data = table_file.read()
+
+    ( magic, version, n_entries, n_samples ) = struct.unpack_from( '=8sIIQ', data, 0 )
+    if ( b'NS3FMUDT' != magic ) or ( 1 != version ):
+        raise Exception( 11 )
+
+    entries_offset = struct.calcsize( '=8sIIQ' )
+    entry_size = struct.calcsize( '=iiiIQ' )
+    samples_offset = entries_offset + n_entries * entry_size
+
+    table = {}
+    for i in range( n_entries ):
+        ( sender, size, receiver, n, offset ) = struct.unpack_from( '=iiiIQ', data, entries_offset + i * entry_size )
+        samples = struct.unpack_from( '={0}q'.format( n ), data, samples_offset + offset * 8 )
+        table[ ( sender, size, receiver ) ] = [ ( s * 1e-9 if s >= 0 else None ) for s in samples ]
+
+    return table
+
+
+# Compute statistics of a list of delays.
+def surrogateStatistics( delays ):
+    received = sorted( [ d for d in delays if d != None ] )
+    loss_rate = 1. - float( len( received ) ) / len( delays ) if delays else 0.
+    if not received: return ( loss_rate, None, None, None )
+    mean = sum( received ) / len( received )
+    median = received[ len( received ) // 2 ]
+    p95 = received[ min( len( received ) - 1, int( 0.95 * len( received ) ) ) ]
+    return ( loss_rate, mean, median, p95 )
+
+
+# Kolmogorov-Smirnov distance between two empirical delay distributions (lost messages count as infinite delay).
+def surrogateKSDistance( delays1, delays2 ):
+    inf = float( 'inf' )
+    d1 = sorted( [ d if d != None else inf for d in delays1 ] )
+    d2 = sorted( [ d if d != None else inf for d in delays2 ] )
+    if not d1 or not d2: return 1.
+    distance = 0.
+    i1 = i2 = 0
+    for x in sorted( set( d1 + d2 ) ):
+        while i1 < len( d1 ) and d1[i1] <= x: i1 += 1
+        while i2 < len( d2 ) and d2[i2] <= x: i2 += 1
+        distance = max( distance, abs( float( i1 ) / len( d1 ) - float( i2 ) / len( d2 ) ) )
+    return distance
+
+
+# Write a report comparing the surrogate delay table with reference simulations (using different seeds).
+def writeSurrogateValidationReport( table, reference, input_names, output_names, report_file_path, modules ):
+    input_names = list( input_names )
+    output_names = list( output_names )
+
+    def name( names, index ):
+        return names[ index ] if index < len( names ) else str( index )
+
+    def fmt( value ):
+        return '{0:12.6f}'.format( value * 1e3 ) if value != None else '{0:>12}'.format( '-' )
+
+    lines = []
+    lines.append( 'Validation of surrogate delay table (delays in ms, reference simulations use different seeds)' )
+    lines.append( '' )
+    lines.append( '{0:<20} {1:<20} {2:>8} {3:>8} {4:>8} {5:>12} {6:>12} {7:>12} {8:>12} {9:>12} {10:>12} {11:>8}'.format(
+        'sender', 'receiver', 'size', 'loss', 'loss_ref', 'mean', 'mean_ref', 'median', 'median_ref', 'p95', 'p95_ref', 'KS' ) )
+
+    for key in sorted( set( table.keys() ) | set( reference.keys() ) ):
+        ( sender, size, receiver ) = key
+        delays = table.get( key, [] )
+        delays_ref = reference.get( key, [] )
+        stats = surrogateStatistics( delays ) if delays else ( 1., None, None, None )
+        stats_ref = surrogateStatistics( delays_ref ) if delays_ref else ( 1., None, None, None )
+        lines.append( '{0:<20} {1:<20} {2:>8} {3:8.3f} {4:8.3f} {5} {6} {7} {8} {9} {10} {11:8.3f}'.format(
+            name( input_names, sender ), name( output_names, receiver ), size, stats[0], stats_ref[0],
+            fmt( stats[1] ), fmt( stats_ref[1] ), fmt( stats[2] ), fmt( stats_ref[2] ), fmt( stats[3] ), fmt( stats_ref[3] ),
+            surrogateKSDistance( delays, delays_ref ) ) )
+
+    with open( report_file_path, 'w' ) as report_file:
+        report_file.write( '\n'.join( lines ) + '\n' )
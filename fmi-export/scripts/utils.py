@@ -15,7 +15,14 @@ def parseCommandLineArguments( modules ):
     parser.add_argument( '-v', '--verbose', action = 'store_true', help = 'turn on log messages' )
     parser.add_argument( '-l', '--litter', action = 'store_true', help = 'do not clean-up intermediate files' )
     parser.add_argument( '-t', '--ns3-install-dir', default = None, help = 'path to ns-3 installation directory', metavar = 'NS3-INSTALL-DIR' )
-    parser.add_argument( '-f', '--fmi-version', choices = [ '1', '2' ], default = '2', help = 'specify FMI version (default: 2)' )
+    parser.add_argument( '-f', '--fmi-version', choices = [ '1', '2', '3' ], default = '2', help = 'specify FMI version (default: 2, version 3 implies --in-process)' )
+    parser.add_argument( '--surrogate-seeds', type = int, default = None, help = 'embed a surrogate delay table generated offline with the given number of seeds per message', metavar = 'N' )
+    parser.add_argument( '--surrogate-message-sizes', default = None, help = 'comma-separated list of message sizes for the surrogate delay table', metavar = 'SIZES' )
+    parser.add_argument( '--surrogate-validate', action = 'store_true', help = 'compare the surrogate delay table against simulations with different seeds' )
+    parser.add_argument( '--bundle-libraries', action = 'store_true', help = 'copy the compiled ns-3 script and the ns-3 libraries to the FMU' )
+    parser.add_argument( '--in-process', action = 'store_true', help = 'load the ns-3 script as shared library into the FMU (FMI 2 and 3 only, no separate ns-3 process)' )
+    parser.add_argument( '--zygote', action = 'store_true', help = 'fork ns-3 processes from a pre-initialized zygote process (Linux only)' )
+    parser.add_argument( '--shared-process', action = 'store_true', help = 'host all FMU instances in a single ns-3 process (Linux only, implies --zygote)' )
 
     # Define mandatory arguments.
     required_args = parser.add_argument_group( 'required arguments' )
@@ -112,10 +119,89 @@ def prepareNs3Script( script_file_path, ns3_install_dir, verbose, modules ):
 
     for label, value in json_data.items():
         if label in input_labels:
-            fmi_input_vars[ str( label ) ] = map( str, value )
+            fmi_input_vars[ str( label ) ] = list( map( str, value ) )
         elif label in output_labels:
-            fmi_output_vars[ str( label ) ] = map( str, value )
+            fmi_output_vars[ str( label ) ] = list( map( str, value ) )
         elif label in param_labels:
-            fmi_params[ str( label ) ] = map( str, value )
+            fmi_params[ str( label ) ] = list( map( str, value ) )
 
-    return ( script_name_root, fmi_input_vars, fmi_output_vars, fmi_params )
+    # Number of integer inputs/outputs associated to messages (the first ones of each list).
+    message_counts = ( json_data.get( 'MessageInputs', len( fmi_input_vars.get( 'IntegerInputs', [] ) ) ),
+        json_data.get( 'MessageOutputs', len( fmi_output_vars.get( 'IntegerOutputs', [] ) ) ) )
+
+    return ( script_name_root, fmi_input_vars, fmi_output_vars, fmi_params, message_counts )
+
+
+# Compile the ns-3 script as shared library, which the FMU loads in-process (instead of starting the ns-3 executable).
+def compileInProcessLibrary( script_file_path, ns3_install_dir, fmipp_include_dir, fmipp_lib_dir, verbose, modules ):
+    # The script has already been copied to ns-3's scratch directory (see function prepareNs3Script).
+    script_path, script_name = modules.os.path.split( script_file_path )
+    script_name_root, script_name_ext = modules.os.path.splitext( script_name )
+    script_file_path = modules.os.path.join( ns3_install_dir, 'scratch', script_name )
+    library_name = 'lib' + script_name_root + '.so'
+
+    # Link against all ns-3 module libraries and the FMI++ backend library. In case the libraries
+    # are bundled with the FMU, they are found in the same directory as the library itself.
+    ns3_lib_dir = modules.os.path.join( ns3_install_dir, 'build', 'lib' )
+
+    compile_cmd = [ modules.os.environ.get( 'CXX', 'g++' ), '-std=c++11', '-O2', '-shared', '-fPIC',
+        '-o', library_name, script_file_path,
+        '-I' + modules.os.path.join( ns3_install_dir, 'build' ), '-I' + fmipp_include_dir,
+        '-Wl,--no-as-needed' ] + getNs3Libraries( ns3_install_dir, fmipp_lib_dir, modules ) + [
+        '-Wl,-rpath,$ORIGIN', '-Wl,-rpath,' + ns3_lib_dir, '-Wl,-rpath,' + fmipp_lib_dir ]
+
+    if ( True == verbose ): modules.log( '[DEBUG] compiling in-process library:', ' '.join( compile_cmd ) )
+
+    exit_code = modules.subprocess.call( compile_cmd )
+    if ( 0 != exit_code ) or ( False == modules.os.path.isfile( library_name ) ):
+        modules.log( '[ERROR] compilation of in-process library failed:', script_file_path )
+        modules.sys.exit(8)
+    elif ( True == verbose ):
+        modules.log( '[DEBUG] successfully compiled in-process library' )
+
+    return library_name
+
+
+# Retrieve the path to the executable of the compiled ns-3 script.
+def findNs3Executable( script_name, ns3_install_dir, verbose, modules ):
+    ns3_scratch_build_dir = modules.os.path.join( ns3_install_dir, 'build', 'scratch' )
+
+    # Depending on the ns-3 version, the executable is called either like the script or
+    # like 'ns3.XX-<script>-<profile>'.
+    candidates = [ modules.os.path.join( ns3_scratch_build_dir, script_name ) ] + \
+        sorted( modules.glob.glob( modules.os.path.join( ns3_scratch_build_dir, 'ns3*-' + script_name + '-*' ) ) )
+
+    for file_path in candidates:
+        if ( True == modules.os.path.isfile( file_path ) ) and ( True == modules.os.access( file_path, modules.os.X_OK ) ):
+            file_path = modules.os.path.abspath( file_path )
+            if ( True == verbose ): modules.log( '[DEBUG] found executable of ns-3 script:', file_path )
+            return file_path
+
+    modules.log( '\n[ERROR] executable of ns-3 script not found in: ', ns3_scratch_build_dir )
+    modules.sys.exit(8)
+
+
+# Retrieve the paths to all ns-3 module libraries and the FMI++ backend library.
+def getNs3Libraries( ns3_install_dir, fmipp_lib_dir, modules ):
+    ns3_lib_dir = modules.os.path.join( ns3_install_dir, 'build', 'lib' )
+    ns3_libs = modules.glob.glob( modules.os.path.join( ns3_lib_dir, 'libns3*.so' ) )
+    if ( 0 == len( ns3_libs ) ):
+        modules.log( '\n[ERROR] no ns-3 libraries found in: ', ns3_lib_dir )
+        modules.sys.exit(8)
+
+    fmipp_backend_lib = modules.os.path.join( fmipp_lib_dir, 'libfmipp_backend.so' )
+    if ( False == modules.os.path.isfile( fmipp_backend_lib ) ):
+        modules.log( '\n[ERROR] shared library not found: ', fmipp_backend_lib )
+        modules.sys.exit(8)
+
+    return ns3_libs + [ fmipp_backend_lib ]
+
+
+# Retrieve the path to the launcher for backend instances forked from a zygote.
+def getZygoteLauncher( ns3_fmu_root_dir, modules ):
+    launcher = modules.os.path.join( ns3_fmu_root_dir, 'lib', 'ns3_fmu_launcher' )
+    if ( False == modules.os.path.isfile( launcher ) ):
+        modules.log( '\n[ERROR] zygote launcher not found: ', launcher )
+        modules.sys.exit(8)
+
+    return modules.os.path.abspath( launcher )
@@ -7,6 +7,20 @@ SCRIPT_DIR="$(dirname $(readlink -f $0))"
 
 ${SCRIPT_DIR}/../../fmi-export/ns3_fmu_create.py -v -m SimpleFMU -s scratch/SimpleFMU.cc -f 1 channel_delay=0.2
 ${SCRIPT_DIR}/../../fmi-export/ns3_fmu_create.py -v -m TC3 -s scratch/TC3.cc -f 1
+${SCRIPT_DIR}/../../fmi-export/ns3_fmu_create.py -v -m SimpleFMUPersistent -s scratch/SimpleFMUPersistent.cc -f 1 channel_delay=0.2
 
 python3 ${SCRIPT_DIR}/test/testSimpleFMU.py
+python3 ${SCRIPT_DIR}/test/testSimpleFMUEarlyReturn.py
+python3 ${SCRIPT_DIR}/test/testSimpleFMUFusedSteps.py
 python3 ${SCRIPT_DIR}/test/testTC3.py
+python3 ${SCRIPT_DIR}/test/testSimpleFMUPersistent.py
+python3 ${SCRIPT_DIR}/test/testSimpleFMUCheckpoint.py
+
+# Smoke tests for FMUs for FMI 2.0 (in-process) and FMI 3.0 (only if the FMI 3.0 headers are available).
+${SCRIPT_DIR}/../../fmi-export/ns3_fmu_create.py -v -m TC3InProcess -s scratch/TC3.cc -f 2 --in-process
+python3 ${SCRIPT_DIR}/test/testModelDescription.py TC3InProcess.fmu u3_send u4_send ctrl_send ctrl_receive tap_receive
+
+if [ -n "${FMI3_INCLUDE_DIR}" ]; then
+	${SCRIPT_DIR}/../../fmi-export/ns3_fmu_create.py -v -m TC3FMI3 -s scratch/TC3.cc -f 3
+	python3 ${SCRIPT_DIR}/test/testModelDescription.py TC3FMI3.fmu u3_send u4_send ctrl_send ctrl_receive tap_receive
+fi
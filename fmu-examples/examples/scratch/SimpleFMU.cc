@@ -68,6 +68,12 @@ SimpleFMU::initializeSimulation()
 
   // Define FMI parameter.
   addRealParameter( channel_delay );
+
+  // The simulation is deterministic, hence delays can be re-used.
+  enableDelayCache();
+
+  // Aborted runs can be resumed from a checkpoint (written if parameter 'checkpoint_interval' is set).
+  enableCheckpoints();
 }
 
 
@@ -77,6 +83,17 @@ SimpleFMU::runSimulation( const double& sync_time )
   // Check if nodeA received an input message. If not, don't run a simulation ...
   if ( 0 == nodeA_send ) return;
 
+  uint32_t packet_size = 1024;
+
+  // Check if the delay for this kind of message is already known. If so, don't run a simulation ...
+  DelayCacheKey key = createDelayCacheKey().add( "nodeA" ).add( "nodeB" ).add( static_cast<fmippInteger>( packet_size ) );
+  Time cached_delay;
+  if ( true == lookupDelay( key, cached_delay ) )
+    {
+      addNewEventForMessageWithDelay( cached_delay, nodeA_send, &nodeB_receive );
+      return;
+    }
+
   std::stringstream str_delay;
   str_delay << channel_delay << "s";
   
@@ -110,7 +127,7 @@ SimpleFMU::runSimulation( const double& sync_time )
   TC3CustomClientHelper echo_client( interfaces.GetAddress(1), port );
   echo_client.SetAttribute( "MaxPackets", UintegerValue(1) );
   echo_client.SetAttribute( "Interval", TimeValue( Seconds(1.0) ) );
-  echo_client.SetAttribute( "PacketSize", UintegerValue(1024) );
+  echo_client.SetAttribute( "PacketSize", UintegerValue( packet_size ) );
 
   ApplicationContainer client_apps = echo_client.Install( nodes.Get(0) );
   client_apps.Start( Seconds(2.0) );
@@ -121,13 +138,16 @@ SimpleFMU::runSimulation( const double& sync_time )
 
   // Retrieve the massage delay.
   const TC3CustomServer& server = dynamic_cast< const TC3CustomServer& >( *server_apps.Get(0) ) ;
-  double delay = server.GetEndToEndDelay();
+  Time delay = server.GetEndToEndDelay();
 
   // Terminate the simulation.
   Simulator::Destroy ();
 
+  // Store the delay for re-use.
+  storeDelay( key, delay );
+
   // Add message as output to nodeB using the calculated delay.
-  addNewEventForMessage( sync_time + delay, nodeA_send, &nodeB_receive );
+  addNewEventForMessageWithDelay( delay, nodeA_send, &nodeB_receive );
   
 }
   
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// --------------------------------------------------------------
+// Copyright (c) 2017, AIT Austrian Institute of Technology GmbH.
+// --------------------------------------------------------------
+
+// ns-3 includes.
+#include "ns3/core-module.h"
+
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include "ns3/fmi-export-module.h"
+
+#include <sstream>
+#include <map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE( "SimpleFMUPersistent" );
+
+
+// Same as example SimpleFMU, but the topology is set up only once and the
+// ns-3 simulation is advanced incrementally (see class PersistentEventQueueFMUBase).
+class SimpleFMUPersistent : public PersistentEventQueueFMUBase {
+
+public:
+
+  // Define all FMI input/output variables and parameters as class members:
+  fmippInteger nodeA_send; // Input variable associated to nodeA.
+  fmippInteger nodeB_receive; // Output variable associated to nodeB.
+  fmippReal channel_delay; // Parameter for channel delay.
+
+  // Define the inputs/outputs/parameters of the ns-3 simulation.
+  virtual void initializeSimulation();
+
+  // Set up the topology of the ns-3 simulation.
+  virtual void initializeTopology();
+
+  // Send messages according to the current inputs.
+  virtual void sendMessages();
+
+private:
+
+  // Callback for receiving packets at nodeB.
+  void receive( Ptr<Socket> socket );
+
+  Ptr<Socket> sender_;
+  Ptr<Socket> receiver_;
+
+  // Message IDs of the packets in flight (packet UIDs are preserved during transmission).
+  std::map<uint64_t, fmippInteger> msg_ids_;
+};
+
+
+void
+SimpleFMUPersistent::initializeSimulation()
+{
+  // Define FMI integer input variable.
+  addIntegerInput( nodeA_send );
+
+  // Define FMI integer output variable.
+  addIntegerOutput( nodeB_receive );
+
+  // Define FMI parameter.
+  addRealParameter( channel_delay );
+}
+
+
+void
+SimpleFMUPersistent::initializeTopology()
+{
+  std::stringstream str_delay;
+  str_delay << channel_delay << "s";
+
+  // Setup of the simulation.
+  NodeContainer nodes;
+  nodes.Create(2);
+
+  PointToPointHelper point_to_point;
+  point_to_point.SetDeviceAttribute( "DataRate", StringValue( "5Mbps" ) );
+  point_to_point.SetChannelAttribute( "Delay", StringValue( str_delay.str() ) );
+
+  NetDeviceContainer devices;
+  devices = point_to_point.Install( nodes );
+
+  InternetStackHelper stack;
+  stack.Install( nodes );
+
+  Ipv4AddressHelper address;
+  address.SetBase( "10.1.1.0", "255.255.255.0" );
+
+  Ipv4InterfaceContainer interfaces = address.Assign( devices );
+
+  uint16_t port = 9;
+
+  // Sockets are used directly (instead of applications), because they stay open during the entire simulation.
+  TypeId tid = TypeId::LookupByName( "ns3::UdpSocketFactory" );
+
+  receiver_ = Socket::CreateSocket( nodes.Get(1), tid );
+  receiver_->Bind( InetSocketAddress( Ipv4Address::GetAny(), port ) );
+  receiver_->SetRecvCallback( MakeCallback( &SimpleFMUPersistent::receive, this ) );
+
+  sender_ = Socket::CreateSocket( nodes.Get(0), tid );
+  sender_->Connect( InetSocketAddress( interfaces.GetAddress(1), port ) );
+}
+
+
+void
+SimpleFMUPersistent::sendMessages()
+{
+  // Check if nodeA received an input message. If not, don't send anything ...
+  if ( 0 == nodeA_send ) return;
+
+  Ptr<Packet> packet = Create<Packet>( 1024 );
+  msg_ids_[packet->GetUid()] = nodeA_send;
+
+  sender_->Send( packet );
+  notifyMessageSent();
+}
+
+
+void
+SimpleFMUPersistent::receive( Ptr<Socket> socket )
+{
+  Ptr<Packet> packet;
+  while ( ( packet = socket->Recv() ) )
+    {
+      std::map<uint64_t, fmippInteger>::iterator it = msg_ids_.find( packet->GetUid() );
+      if ( msg_ids_.end() == it ) continue;
+
+      // Add message as output to nodeB (received at the current simulation time).
+      notifyMessageReceived( it->second, &nodeB_receive );
+      msg_ids_.erase( it );
+    }
+}
+
+
+// The next line creates a working FMU backend.
+CREATE_NS3_FMU_BACKEND( SimpleFMUPersistent )
@@ -19,6 +19,7 @@
 #include "ns3/tc3-custom-server.h"
 #include "ns3/tc3-smartmeter-custom-client.h"
 #include "ns3/tc3-helper.h"
+#include "ns3/batch-send-helper.h"
 
 #include <iostream>
 #include <algorithm>
@@ -50,18 +51,34 @@ public:
 	fmippInteger ctrl_receive;  // Output variable associated to controller
 	fmippInteger tap_receive; // Output variable associated to the OLTC
 
+	// Payloads of the messages (meter readings and tap set point)
+	fmippReal u3_reading; // Payload sent by SmartMeterA
+	fmippReal u4_reading; // Payload sent by SmartMeterB
+	fmippReal ctrl_setpoint; // Payload sent by the controller
+
+	fmippReal ctrl_reading; // Payload received by the controller
+	fmippReal tap_setpoint; // Payload received by the OLTC
+
+	// Delay statistics of all simulations so far (all packets received by the controller / the OLTC)
+	DelayStatistics ctrl_stats;
+	DelayStatistics tap_stats;
+
+	// Delays and numbers of lost packets of all simulations so far (the servers only exist during a simulation)
+	DelayHistogram ctrl_delays_;
+	DelayHistogram tap_delays_;
+	unsigned int ctrl_lost_ = 0;
+	unsigned int tap_lost_ = 0;
+
 	// Variables to hold the nodes' IP addresses
 	Ipv4Address smartMeterA_;
 	Ipv4Address smartMeterB_;
 	Ipv4Address transformer_;
 
-	// Variables are used to keep the delay from each smart meter to the controller
-	double SMA_delay_ = 0;
-	double SMB_delay_ = 0;
-	double ctrl_delay_ = 0;
-
 	double delay_factor_ = 1e0;
 
+	// The topology is the same for all simulations, hence the routes are computed only once.
+	RoutingTableCache routing_cache_;
+
 	// Define the inputs outputs and parameters of the ns3 simulation
 	virtual void initializeSimulation();
 
@@ -83,6 +100,25 @@ TC3CommNetworkFMU::initializeSimulation()
 	addIntegerOutput( ctrl_receive );
 	addIntegerOutput( tap_receive );
 
+	// Define FMI real input and output variables for the payloads
+	addRealInput( u3_reading );
+	addRealInput( u4_reading );
+	addRealInput( ctrl_setpoint );
+
+	addRealOutput( ctrl_reading );
+	addRealOutput( tap_setpoint );
+
+	// Transport the payloads together with the messages
+	addPayloadInput( u3_send, u3_reading );
+	addPayloadInput( u4_send, u4_reading );
+	addPayloadInput( ctrl_send, ctrl_setpoint );
+
+	addPayloadOutput( ctrl_receive, ctrl_reading );
+	addPayloadOutput( tap_receive, tap_setpoint );
+
+	// Define FMI real outputs for the delay statistics
+	addDelayStatisticsOutputs( ctrl_stats );
+	addDelayStatisticsOutputs( tap_stats );
 }
 
 
@@ -189,77 +225,85 @@ TC3CommNetworkFMU::runSimulation(const double& sync_time)
 	mobility.SetMobilityModel( "ns3::ConstantPositionMobilityModel" );
 	mobility.Install( wifiStaNodes );
 
-	Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+	routing_cache_.populateRoutingTables();
+
+    // Simulation topology complete, assign applications to the nodes.
+	// All messages sent at this synchronization point are simulated with a single run.
+	BatchSendHelper batch( Seconds(1.0), Seconds(10.0) );
 
-    // Simulation topology complete, assign applications to the nodes
+	// Servers that receive messages during this simulation (null if not used)
+	Ptr<TC3ControllerServer> SM;
+	Ptr<TC3OltcCustomServer> oltc_srv;
 
     // Smartmeters send at the same time data to the server.
 	if( ( u3_send !=0 ) ||( u4_send != 0 ) )
     {
-		// std::cout << "\n(Debug): SMART METER SEND" << std::endl;
-	  	TC3SmartmeterCustomClientHelper smartMeterHlpA( csmaInterfaces.GetAddress(0), 9 );
-	  	smartMeterHlpA.SetAttribute( "MaxPackets", UintegerValue(1) );
-	  	smartMeterHlpA.SetAttribute( "Interval", TimeValue( Seconds(10.0) ) );
-	  	smartMeterHlpA.SetAttribute( "PacketSize", UintegerValue(100) );
-	  	ApplicationContainer smartMeterAppA = smartMeterHlpA.Install( wifiStaNodes.Get(0) );
-	  	smartMeterAppA.Start( Seconds(1.0) );
-	  	smartMeterAppA.Stop( Seconds(10.0) );
-
-	  	TC3SmartmeterCustomClientHelper smartMeterHlpB( csmaInterfaces.GetAddress(0), 9 );
-	  	smartMeterHlpB.SetAttribute( "MaxPackets", UintegerValue(1) );
-	  	smartMeterHlpB.SetAttribute( "Interval", TimeValue( Seconds(10.0) ) );
-	  	smartMeterHlpB.SetAttribute( "PacketSize", UintegerValue(100) );
-	  	ApplicationContainer smartMeterAppB = smartMeterHlpB.Install( wifiStaNodes.Get(1) );
-	  	smartMeterAppB.Start( Seconds(1.0) );
-	  	smartMeterAppB.Stop( Seconds(10.0) );
-
   		// Controller receives from the smartmeters in this case.
     	TC3ControllerServerHelper controllerHlp(9);
 		controllerHlp.SetAttribute( "SmartMeterA_Ipv4Address", AddressValue( smartMeterA_ ) );
 		controllerHlp.SetAttribute( "SmartMeterB_Ipv4Address", AddressValue( smartMeterB_ ) );
 	  	ApplicationContainer controllerApp = controllerHlp.Install( csmaNodes.Get(0) );
-	  	controllerApp.Start( Seconds(0.0) );
-	  	controllerApp.Stop( Seconds(10.0) );
-
-		Simulator::Stop( Seconds(10.0) );
-
-		Simulator::Run();
-
-		const TC3ControllerServer& SM = dynamic_cast<const TC3ControllerServer&>( *controllerApp.Get(0) );
-
-		// Retrieve the end to end delay for each smartmeter
-   	  	SMA_delay_ = SM.GetEndToEndDelay_SMA();
-		SMB_delay_ = SM.GetEndToEndDelay_SMB();
-		
-		// Add the two events to the event queue.
-		if( u3_send != 0 ) addNewEventForMessage( sync_time + delay_factor_ * SMA_delay_, u3_send, &ctrl_receive );
-		if( u4_send != 0 ) addNewEventForMessage( sync_time + delay_factor_ * SMB_delay_, u4_send, &ctrl_receive );
+		batch.AddReceivers( controllerApp );
+
+		SM = DynamicCast<TC3ControllerServer>( controllerApp.Get(0) );
+
+		if( u3_send != 0 )
+		{
+		  	TC3SmartmeterCustomClientHelper smartMeterHlpA( csmaInterfaces.GetAddress(0), 9 );
+		  	smartMeterHlpA.SetAttribute( "MaxPackets", UintegerValue(1) );
+		  	smartMeterHlpA.SetAttribute( "Interval", TimeValue( Seconds(10.0) ) );
+		  	smartMeterHlpA.SetAttribute( "PacketSize", UintegerValue( getMessageSize( u3_send, 100 ) ) );
+		  	ApplicationContainer smartMeterAppA = smartMeterHlpA.Install( wifiStaNodes.Get(0) );
+			batch.AddMessage( smartMeterAppA, MakeCallback( &ServerBase::GetMessageDelay, SM ), u3_send, &ctrl_receive );
+		}
+
+		if( u4_send != 0 )
+		{
+		  	TC3SmartmeterCustomClientHelper smartMeterHlpB( csmaInterfaces.GetAddress(0), 9 );
+		  	smartMeterHlpB.SetAttribute( "MaxPackets", UintegerValue(1) );
+		  	smartMeterHlpB.SetAttribute( "Interval", TimeValue( Seconds(10.0) ) );
+		  	smartMeterHlpB.SetAttribute( "PacketSize", UintegerValue( getMessageSize( u4_send, 100 ) ) );
+		  	ApplicationContainer smartMeterAppB = smartMeterHlpB.Install( wifiStaNodes.Get(1) );
+			batch.AddMessage( smartMeterAppB, MakeCallback( &ServerBase::GetMessageDelay, SM ), u4_send, &ctrl_receive );
+		}
 	}
 
-
     if( ctrl_send != 0 )
 	{
-		// std::cout << "\n(Debug): CTRL SEND" << std::endl;
 	  	// Controller acts as the client in this case
 	  	TC3ControllerClientHelper controllerHlp( wifiStaInterfaces.GetAddress(0), 19 );
 	  	controllerHlp.SetAttribute( "MaxPackets", UintegerValue(1) );
+	  	controllerHlp.SetAttribute( "PacketSize", UintegerValue( getMessageSize( ctrl_send, 100 ) ) );
 		ApplicationContainer controllerApp = controllerHlp.Install( csmaNodes.Get(0) );
-	  	controllerApp.Start( Seconds(2.0) );
-	  	controllerApp.Stop( Seconds(10.0) );
 
 	  	TC3OltcCustomServerHelper OltcHlp(19);
 	  	ApplicationContainer OltcApp = OltcHlp.Install( wifiStaNodes.Get(0) );
-	  	OltcApp.Start( Seconds(0.0) );
-	  	OltcApp.Stop( Seconds(10.0) );
+		batch.AddReceivers( OltcApp );
 
-		Simulator::Stop( Seconds(10.0) );
+		oltc_srv = DynamicCast<TC3OltcCustomServer>( OltcApp.Get(0) );
+		// The controller starts sending one second after the smart meters (i.e., at 2 s).
+		batch.AddMessage( controllerApp, MakeCallback( &ServerBase::GetMessageDelay, oltc_srv ), ctrl_send, &tap_receive, Seconds(1.0) );
+	}
 
-		Simulator::Run();
+	// Run the simulation (once for all messages) and add the resulting events to the event queue.
+	const std::vector<BatchSendHelper::Result>& results = batch.Run();
 
-		const TC3OltcCustomServer& oltc_srv = dynamic_cast<const TC3OltcCustomServer&>( *OltcApp.Get(0) );
-		ctrl_delay_ = oltc_srv.GetEndToEndDelay();
+	std::vector<BatchSendHelper::Result>::const_iterator it;
+	for ( it = results.begin(); it != results.end(); ++it )
+		addNewEventForMessageWithDelay( it->delay * int64x64_t( delay_factor_ ), it->msg_id, it->receiver );
 
-		addNewEventForMessage( sync_time + delay_factor_ * ctrl_delay_, ctrl_send, &tap_receive );
+	// Add the delays of this simulation to the delay statistics (messages without delay have been sent but not received).
+	if ( SM )
+	{
+		ctrl_delays_.Merge( SM->GetDelays() );
+		ctrl_lost_ += batch.GetLost( &ctrl_receive );
+		ctrl_stats.update( ctrl_delays_, ctrl_lost_ );
+	}
+	if ( oltc_srv )
+	{
+		tap_delays_.Merge( oltc_srv->GetDelays() );
+		tap_lost_ += batch.GetLost( &tap_receive );
+		tap_stats.update( tap_delays_, tap_lost_ );
 	}
 
 	Simulator::Destroy();
@@ -395,7 +395,7 @@ class FMUCoSimulationV1:
         assert( status == self.fmi_ok  )
 
 
-    def doStep( self, current_communication_point, communication_step_size, new_step = True ):
+    def doStep( self, current_communication_point, communication_step_size, new_step = True, discard_allowed = False ):
 
         func_name_do_step = self.fmu_name + '_fmiDoStep'
         func_do_step = getattr( self.fmu_shared_library, func_name_do_step )
@@ -406,8 +406,10 @@ class FMUCoSimulationV1:
             c_char( self.fmi_true if new_step is True else self.fmi_false )
             )
 
-        # Check the FMU status.
-        assert( status == self.fmi_ok  )
+        # Check the FMU status (steps that return early are discarded).
+        assert( status == self.fmi_ok or ( discard_allowed is True and status == self.fmi_discard ) )
+
+        return status
 
 
     def terminateSlave( self ):
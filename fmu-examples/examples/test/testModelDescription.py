@@ -0,0 +1,62 @@
+#!/usr/bin/python3
+
+# Check the model description of an FMU for FMI 2.0 or FMI 3.0.
+# Usage: testModelDescription.py <fmu> <message variable> [<message variable> ...]
+#
+# Only the message variables (integer inputs/outputs associated to messages) must be clocked
+# (FMI 3.0 only), all other variables must not be clocked.
+
+from pathlib import Path
+import sys, zipfile
+import xml.etree.ElementTree
+
+fmu_file_path = Path( sys.argv[1] )
+message_vars = set( sys.argv[2:] )
+
+with zipfile.ZipFile( fmu_file_path ) as fmu:
+    model_description = xml.etree.ElementTree.fromstring( fmu.read( 'modelDescription.xml' ) )
+
+fmi_version = model_description.get( 'fmiVersion' )
+print( '{}: FMI version {}'.format( fmu_file_path.name, fmi_version ) )
+
+co_simulation = model_description.find( 'CoSimulation' )
+assert( co_simulation is not None )
+
+# The FMU accepts arbitrary step sizes (and returns early at events).
+assert( 'true' == co_simulation.get( 'canHandleVariableCommunicationStepSize' ) )
+
+model_variables = list( model_description.find( 'ModelVariables' ) )
+var_names = set( var.get( 'name' ) for var in model_variables )
+assert( message_vars <= var_names )
+
+if ( '2.0' == fmi_version ):
+
+    # FMI 2.0 has no clocks.
+    for var in model_variables:
+        assert( var.get( 'clocks' ) is None )
+
+elif ( '3.0' == fmi_version ):
+
+    assert( 'true' == co_simulation.get( 'mightReturnEarlyFromDoStep' ) )
+
+    clocks = dict( ( var.get( 'valueReference' ), var ) for var in model_variables if 'Clock' == var.tag )
+    assert( len( message_vars ) == len( clocks ) )
+
+    for var in model_variables:
+        if ( 'Clock' == var.tag ): continue
+
+        clock_val_ref = var.get( 'clocks' )
+        if ( var.get( 'name' ) in message_vars ):
+            # Each message variable has a clock of its own (with the same causality).
+            print( '{} is clocked by {}'.format( var.get( 'name' ), clocks[clock_val_ref].get( 'name' ) ) )
+            assert( 'Int32' == var.tag )
+            assert( var.get( 'causality' ) == clocks[clock_val_ref].get( 'causality' ) )
+            del clocks[clock_val_ref]
+        else:
+            assert( clock_val_ref is None )
+
+    assert( 0 == len( clocks ) )
+
+else:
+
+    assert( False )
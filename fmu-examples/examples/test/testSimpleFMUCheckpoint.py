@@ -0,0 +1,139 @@
+#!/usr/bin/python3
+
+from FMUCoSimulationV1 import *
+from extractFMU import *
+from pathlib import Path
+import math, os, signal, subprocess, sys
+
+model_name = 'SimpleFMU'
+
+start_time = 0.
+stop_time = 4.
+
+checkpoint_interval = 0.1
+
+# Line printed by the aborted run, which tells the receive time of the message in flight.
+event_time_info = 'receive time of message in flight : '
+
+
+# Instantiate and initialize the FMU.
+def initializeFMU( instance_name ):
+
+    fmu = FMUCoSimulationV1(
+        model_name,
+        Path( __file__ ).parent
+        )
+
+    fmu.instantiateSlave(
+        name = instance_name,
+        visible = False,
+        interactive = False,
+        logging_on = False
+        )
+
+    # Set checkpoint interval.
+    fmu.setReal( [ 'checkpoint_interval' ], [ checkpoint_interval ] )
+
+    fmu.initializeSlave(
+        start_time = start_time,
+        stop_time = stop_time,
+        stop_time_defined = True
+        )
+
+    return fmu
+
+
+# Send a message and abort the co-simulation run while the message is in flight (called in a
+# separate process, which kills itself and the backend without terminating the FMU).
+def abortRun():
+
+    fmu = initializeFMU( 'test_checkpoint' )
+
+    time = 1.
+    msg_id = 1
+
+    fmu.doStep(
+        current_communication_point = start_time,
+        communication_step_size = time - start_time
+        )
+
+    print( 'At time {:.5f}: SEND message with ID = {}'.format( time, msg_id ) )
+
+    fmu.setInteger( [ 'nodeA_send' ], [ msg_id ] )
+
+    fmu.doStep(
+        current_communication_point = time,
+        communication_step_size = 0.
+        )
+
+    event_time = fmu.getReal( [ 'next_event_time' ] )[0]
+    print( event_time_info + repr( event_time ), flush = True )
+
+    # The checkpoint interval has elapsed, hence this time advance writes a checkpoint.
+    fmu.doStep(
+        current_communication_point = time,
+        communication_step_size = checkpoint_interval
+        )
+
+    assert( time + checkpoint_interval < event_time )
+
+    os.killpg( os.getpgrp(), signal.SIGKILL )
+
+
+if ( 1 < len( sys.argv ) ) and ( 'abort' == sys.argv[1] ):
+    abortRun()
+
+extractFMU(
+    Path( __file__ ).parent / '..' / ( model_name + '.fmu' ),
+    Path( __file__ ).parent,
+    command = 'unzip -o -u {fmu} -d {dir}'
+    )
+
+print( '================================================' )
+print( 'abort co-simulation run' )
+
+aborted_run = subprocess.run(
+    [ sys.executable, __file__, 'abort' ],
+    stdout = subprocess.PIPE,
+    universal_newlines = True,
+    start_new_session = True
+    )
+
+print( aborted_run.stdout )
+assert( -signal.SIGKILL == aborted_run.returncode )
+
+event_time = None
+for line in aborted_run.stdout.splitlines():
+    if line.startswith( event_time_info ): event_time = float( line[ len( event_time_info ): ] )
+
+assert( event_time is not None )
+
+print( '================================================' )
+print( 'resume co-simulation run from checkpoint' )
+
+fmu = initializeFMU( 'test_checkpoint_resumed' )
+
+# The FMU resumes at the time of the checkpoint, the message is still in flight.
+time = fmu.getReal( [ 'last_successful_time' ] )[0]
+print( 'last successful time : {}'.format( time ) )
+assert( math.fabs( time - ( 1. + checkpoint_interval ) ) < 1e-9 )
+assert( event_time == fmu.getReal( [ 'next_event_time' ] )[0] )
+
+# Receive the message (iterate the FMU once at the time of the event).
+fmu.doStep(
+    current_communication_point = time,
+    communication_step_size = event_time - time
+    )
+
+fmu.doStep(
+    current_communication_point = event_time,
+    communication_step_size = 0.
+    )
+
+received_msg_id = fmu.getInteger( [ 'nodeB_receive' ] )[0]
+print( 'At time {:.5f}: RECEIVE message with ID = {}'.format( event_time, received_msg_id ) )
+assert( 1 == received_msg_id )
+
+# Done (the checkpoint is removed).
+fmu.terminateSlave()
+fmu.freeSlaveInstance()
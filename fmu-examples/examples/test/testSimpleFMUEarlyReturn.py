@@ -0,0 +1,99 @@
+#!/usr/bin/python3
+
+from FMUCoSimulationV1 import *
+from extractFMU import *
+from pathlib import Path
+import math, sys
+
+model_name = 'SimpleFMU'
+
+extractFMU(
+    Path( __file__ ).parent / '..' / ( model_name + '.fmu' ),
+    Path( __file__ ).parent,
+    command = 'unzip -o -u {fmu} -d {dir}'
+    )
+
+fmu = FMUCoSimulationV1(
+    model_name,
+    Path( __file__ ).parent
+    )
+
+# Instantiate FMU.
+fmu.instantiateSlave(
+    name = 'test_early_return',
+    visible = False,
+    interactive = False,
+    logging_on = False
+    )
+
+start_time = 0.
+stop_time = 4.
+
+# Initialize FMU.
+fmu.initializeSlave(
+    start_time = start_time,
+    stop_time = stop_time,
+    stop_time_defined = True
+    )
+
+time = 1.
+msg_id = 1
+
+# Advance to the send time.
+fmu.doStep(
+    current_communication_point = start_time,
+    communication_step_size = time - start_time
+    )
+
+print( 'At time {:.5f}: SEND message with ID = {}'.format( time, msg_id ) )
+
+# Send a message (iterate the FMU once).
+fmu.setInteger( [ 'nodeA_send' ], [ msg_id ] )
+
+fmu.doStep(
+    current_communication_point = time,
+    communication_step_size = 0.
+    )
+
+event_time = fmu.getReal( [ 'next_event_time' ] )[0]
+print( 'next event time : {}'.format( event_time ) )
+assert( time < event_time < stop_time )
+
+# Take a step beyond the receive time of the message. The FMU returns early at the time of the event.
+status = fmu.doStep(
+    current_communication_point = time,
+    communication_step_size = stop_time - time,
+    discard_allowed = True
+    )
+
+last_successful_time = fmu.getReal( [ 'last_successful_time' ] )[0]
+print( 'last successful time : {}'.format( last_successful_time ) )
+assert( fmu.fmi_discard == status )
+assert( event_time == last_successful_time )
+
+# The message is not received before the FMU is iterated.
+assert( 0 == fmu.getInteger( [ 'nodeB_receive' ] )[0] )
+
+# Receive the message (iterate the FMU once at the time of the event).
+fmu.doStep(
+    current_communication_point = last_successful_time,
+    communication_step_size = 0.
+    )
+
+received_msg_id = fmu.getInteger( [ 'nodeB_receive' ] )[0]
+print( 'At time {:.5f}: RECEIVE message with ID = {}'.format( last_successful_time, received_msg_id ) )
+assert( msg_id == received_msg_id )
+
+# No more events, the FMU advances to the stop time without returning early.
+assert( stop_time == fmu.getReal( [ 'next_event_time' ] )[0] )
+
+fmu.doStep(
+    current_communication_point = last_successful_time,
+    communication_step_size = stop_time - last_successful_time
+    )
+
+assert( stop_time == fmu.getReal( [ 'last_successful_time' ] )[0] )
+
+# Done.
+fmu.terminateSlave()
+fmu.freeSlaveInstance()
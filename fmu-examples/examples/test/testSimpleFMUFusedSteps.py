@@ -0,0 +1,113 @@
+#!/usr/bin/python3
+
+from FMUCoSimulationV1 import *
+from extractFMU import *
+from pathlib import Path
+import math, sys
+
+model_name = 'SimpleFMU'
+
+extractFMU(
+    Path( __file__ ).parent / '..' / ( model_name + '.fmu' ),
+    Path( __file__ ).parent,
+    command = 'unzip -o -u {fmu} -d {dir}'
+    )
+
+fmu = FMUCoSimulationV1(
+    model_name,
+    Path( __file__ ).parent
+    )
+
+# Instantiate FMU.
+fmu.instantiateSlave(
+    name = 'test_fused_steps',
+    visible = False,
+    interactive = False,
+    logging_on = False
+    )
+
+start_time = 0.
+stop_time = 4.
+
+# Enable fused step mode.
+fmu.setInteger( [ 'fused_steps' ], [ 1 ] )
+
+# Initialize FMU.
+fmu.initializeSlave(
+    start_time = start_time,
+    stop_time = stop_time,
+    stop_time_defined = True
+    )
+
+
+# Set the message to be sent (0 for none) and do a fused step. Returns the status of the
+# step, the time reached by the step and the received message.
+def fusedStep( time, step_size, msg_id ):
+
+    fmu.setInteger( [ 'nodeA_send' ], [ msg_id ] )
+
+    status = fmu.doStep(
+        current_communication_point = time,
+        communication_step_size = step_size,
+        discard_allowed = True
+        )
+
+    last_successful_time = fmu.getReal( [ 'last_successful_time' ] )[0]
+
+    if ( 0 != msg_id ):
+        print( 'At time {:.5f}: SEND message with ID = {}'.format( last_successful_time, msg_id ) )
+
+    received_msg_id = fmu.getInteger( [ 'nodeB_receive' ] )[0]
+    if ( 0 != received_msg_id ):
+        print( 'At time {:.5f}: RECEIVE message with ID = {}'.format( last_successful_time, received_msg_id ) )
+
+    return ( status, last_successful_time, received_msg_id )
+
+
+# The message is sent at the end of the step, without a separate FMU iteration.
+( status, time, received_msg_id ) = fusedStep( start_time, 1., 1 )
+assert( fmu.fmi_ok == status )
+assert( 1. == time )
+assert( 0 == received_msg_id )
+
+receive_time = fmu.getReal( [ 'next_event_time' ] )[0]
+delay = receive_time - time
+print( 'next event time : {}'.format( receive_time ) )
+assert( 0. < delay < stop_time - time )
+
+# The step is clamped to the receive time and the message is received right away.
+( status, time, received_msg_id ) = fusedStep( time, stop_time - time, 0 )
+assert( fmu.fmi_discard == status )
+assert( receive_time == time )
+assert( 1 == received_msg_id )
+
+# Send another message.
+( status, time, received_msg_id ) = fusedStep( time, 0.5, 2 )
+assert( fmu.fmi_ok == status )
+assert( 0 == received_msg_id )
+
+receive_time = fmu.getReal( [ 'next_event_time' ] )[0]
+assert( math.fabs( receive_time - ( time + delay ) ) < 1e-6 )
+
+# The step is clamped to the receive time. The message is received and the
+# new message is sent at the receive time (instead of the requested time).
+( status, time, received_msg_id ) = fusedStep( time, stop_time - time, 3 )
+assert( fmu.fmi_discard == status )
+assert( receive_time == time )
+assert( 2 == received_msg_id )
+
+receive_time = fmu.getReal( [ 'next_event_time' ] )[0]
+assert( math.fabs( receive_time - ( time + delay ) ) < 1e-6 )
+
+# A step to the receive time is not clamped.
+( status, time, received_msg_id ) = fusedStep( time, receive_time - time, 0 )
+assert( fmu.fmi_ok == status )
+assert( receive_time == time )
+assert( 3 == received_msg_id )
+
+# No more events.
+assert( stop_time == fmu.getReal( [ 'next_event_time' ] )[0] )
+
+# Done.
+fmu.terminateSlave()
+fmu.freeSlaveInstance()
@@ -0,0 +1,131 @@
+#!/usr/bin/python3
+
+from FMUCoSimulationV1 import *
+from extractFMU import *
+from pathlib import Path
+import math, sys
+
+model_name = 'SimpleFMUPersistent'
+
+extractFMU(
+    Path( __file__ ).parent / '..' / ( model_name + '.fmu' ),
+    Path( __file__ ).parent,
+    command = 'unzip -o -u {fmu} -d {dir}'
+    )
+
+start_time = 0.
+stop_time = 4.
+
+# The channel delay is set when creating the FMU (see 'run-tests.sh').
+channel_delay = 0.2
+
+
+# Instantiate and initialize the FMU with the given delivery horizon.
+def initializeFMU( instance_name, delivery_horizon ):
+
+    fmu = FMUCoSimulationV1(
+        model_name,
+        Path( __file__ ).parent
+        )
+
+    fmu.instantiateSlave(
+        name = instance_name,
+        visible = False,
+        interactive = False,
+        logging_on = False
+        )
+
+    # Set delivery horizon.
+    fmu.setReal( [ 'delivery_horizon' ], [ delivery_horizon ] )
+
+    fmu.initializeSlave(
+        start_time = start_time,
+        stop_time = stop_time,
+        stop_time_defined = True
+        )
+
+    return fmu
+
+
+# Advance the FMU to the given time and send a message (iterate the FMU once).
+def send( fmu, time, new_time, msg_id ):
+
+    fmu.doStep(
+        current_communication_point = time,
+        communication_step_size = new_time - time
+        )
+
+    print( 'At time {:.5f}: SEND message with ID = {}'.format( new_time, msg_id ) )
+
+    fmu.setInteger( [ 'nodeA_send' ], [ msg_id ] )
+
+    fmu.doStep(
+        current_communication_point = new_time,
+        communication_step_size = 0.
+        )
+
+    return fmu.getReal( [ 'next_event_time' ] )[0]
+
+
+# Advance the FMU to the given time and return the received message (iterate the FMU once).
+def receive( fmu, time, new_time ):
+
+    fmu.doStep(
+        current_communication_point = time,
+        communication_step_size = new_time - time
+        )
+
+    fmu.doStep(
+        current_communication_point = new_time,
+        communication_step_size = 0.
+        )
+
+    msg_id = fmu.getInteger( [ 'nodeB_receive' ] )[0]
+    if ( 0 != msg_id ):
+        print( 'At time {:.5f}: RECEIVE message with ID = {}'.format( new_time, msg_id ) )
+
+    return msg_id
+
+
+print( '================================================' )
+print( 'run ahead until messages are received' )
+
+fmu = initializeFMU( 'test_persistent_run_ahead', 10. )
+
+# The ns-3 simulation runs ahead until the message has been received.
+receive_time_1 = send( fmu, start_time, 1., 1 )
+delay = receive_time_1 - 1.
+print( 'next event time : {}'.format( receive_time_1 ) )
+assert( channel_delay < delay < channel_delay + 0.1 )
+
+# The ns-3 simulation is still ahead (at the receive time of the first message),
+# hence the second message is sent at the ns-3 simulation time.
+assert( receive_time_1 == send( fmu, 1., 1.1, 2 ) )
+assert( 1 == receive( fmu, 1.1, receive_time_1 ) )
+
+receive_time_2 = fmu.getReal( [ 'next_event_time' ] )[0]
+print( 'next event time : {}'.format( receive_time_2 ) )
+assert( math.fabs( receive_time_2 - ( receive_time_1 + delay ) ) < 1e-6 )
+assert( 2 == receive( fmu, receive_time_1, receive_time_2 ) )
+
+fmu.terminateSlave()
+fmu.freeSlaveInstance()
+
+print( '================================================' )
+print( 'drop messages received after the delivery horizon' )
+
+fmu = initializeFMU( 'test_persistent_late_message', 0.5 * channel_delay )
+
+# The ns-3 simulation stops at the delivery horizon, before the message has been received.
+next_event_time = send( fmu, start_time, 1., 1 )
+print( 'next event time : {}'.format( next_event_time ) )
+assert( stop_time == next_event_time )
+
+# The message is received by the ns-3 simulation only when it is advanced beyond the
+# delivery horizon, which is too late. Hence, the message is dropped.
+assert( 0 == receive( fmu, 1., 2. ) )
+assert( stop_time == fmu.getReal( [ 'next_event_time' ] )[0] )
+
+# Done.
+fmu.terminateSlave()
+fmu.freeSlaveInstance()
@@ -80,8 +80,9 @@ while ( time < stop_time ):
         debug_msg = 'At time {:.5f}: SEND messages to controller with ID = {} and  ID = {}'
         print( debug_msg.format( time, msg_id, -msg_id ) )
 
-        # Set input variable 'u3_send' and 'u4_send'.
+        # Set input variable 'u3_send' and 'u4_send' (with meter readings as payload).
         fmu.setInteger( [ 'u3_send', 'u4_send' ], [ msg_id, -msg_id ] )
+        fmu.setReal( [ 'u3_reading', 'u4_reading' ], [ 1. + 0.01 * msg_id, 1. - 0.01 * msg_id ] )
 
         msg_id += 1
 
@@ -100,13 +101,15 @@ while ( time < stop_time ):
     print( 'ctrl_msg_id = {}'.format( ctrl_msg_id ) )
 
     if 0 != ctrl_msg_id:
-        debug_msg = 'At time {:.5f}: RECEIVE message at controller with ID = {}'
-        print( debug_msg.format( time, ctrl_msg_id ) )
+        ctrl_reading = fmu.getReal( [ 'ctrl_reading' ] )[0]
+        debug_msg = 'At time {:.5f}: RECEIVE message at controller with ID = {} (reading = {:.3f})'
+        print( debug_msg.format( time, ctrl_msg_id, ctrl_reading ) )
         
         debug_msg = 'At time {:.5f}: SEND message from controller with ID = {}'
         print( debug_msg.format( time, 10 * ctrl_msg_id ) )
 
         fmu.setInteger( [ 'ctrl_send' ], [ 10 * ctrl_msg_id ] )
+        fmu.setReal( [ 'ctrl_setpoint' ], [ 2. - ctrl_reading ] )
 
         fmu.doStep(
             current_communication_point = time,
@@ -116,7 +119,8 @@ while ( time < stop_time ):
     # Get output variable 'Transformer_receive'
     trafo_msg_id = fmu.getInteger( [ 'tap_receive' ] )[0]
     if 0 != trafo_msg_id:
-        print( 'At time {:.5f}: RECEIVE message at transformer with ID = {}'.format( time, trafo_msg_id ) )
+        tap_setpoint = fmu.getReal( [ 'tap_setpoint' ] )[0]
+        print( 'At time {:.5f}: RECEIVE message at transformer with ID = {} (set point = {:.3f})'.format( time, trafo_msg_id, tap_setpoint ) )
 
     #timer.sleep(1)
 
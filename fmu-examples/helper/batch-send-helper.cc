@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/client-base.h"
+
+#include "batch-send-helper.h"
+
+
+namespace ns3 {
+
+
+BatchSendHelper::BatchSendHelper( Time start, Time stop ) :
+	m_start( start ),
+	m_stop( stop )
+{}
+
+
+void
+BatchSendHelper::AddReceivers( ApplicationContainer servers )
+{
+	servers.Start( Seconds( 0.0 ) );
+	servers.Stop( m_stop );
+}
+
+
+void
+BatchSendHelper::AddMessage( ApplicationContainer clients, Callback<Time> delay,
+	Ns3FMUBackendEventQueue::MessageID msg_id, Ns3FMUBackendEventQueue::Receiver receiver, Time offset )
+{
+	AddClients( clients, msg_id, receiver, offset );
+
+	m_delays.push_back( delay );
+	m_messageDelays.push_back( Callback<Time, int32_t>() );
+}
+
+
+void
+BatchSendHelper::AddMessage( ApplicationContainer clients, Callback<Time, int32_t> delay,
+	Ns3FMUBackendEventQueue::MessageID msg_id, Ns3FMUBackendEventQueue::Receiver receiver, Time offset )
+{
+	AddClients( clients, msg_id, receiver, offset );
+
+	m_delays.push_back( Callback<Time>() );
+	m_messageDelays.push_back( delay );
+}
+
+
+void
+BatchSendHelper::AddClients( ApplicationContainer clients,
+	Ns3FMUBackendEventQueue::MessageID msg_id, Ns3FMUBackendEventQueue::Receiver receiver, Time offset )
+{
+	clients.Start( m_start + offset );
+	clients.Stop( m_stop );
+
+	// Message IDs are only unique per sender, hence the packets are tagged with a key that is unique
+	// within the batch instead (see function 'GetKey').
+	int32_t key = GetKey( m_results.size() );
+	for ( ApplicationContainer::Iterator it = clients.Begin(); it != clients.End(); ++it )
+	{
+		Ptr<ClientBase> client = DynamicCast<ClientBase>( *it );
+		if ( client ) client->SetMessageId( key );
+	}
+
+	Result result;
+	result.msg_id = msg_id;
+	result.receiver = receiver;
+	result.delay = Seconds( -1 );
+
+	m_results.push_back( result );
+}
+
+
+const std::vector<BatchSendHelper::Result>&
+BatchSendHelper::Run()
+{
+	Simulator::Stop( m_stop );
+	Simulator::Run();
+
+	// Demultiplex the delays from the receivers.
+	for ( size_t i = 0; i < m_results.size(); ++i )
+	{
+		if ( false == m_delays[i].IsNull() ) m_results[i].delay = m_delays[i]();
+		else m_results[i].delay = m_messageDelays[i]( GetKey( i ) );
+	}
+
+	return m_results;
+}
+
+
+int32_t
+BatchSendHelper::GetKey( size_t index )
+{
+	return static_cast<int32_t>( index ) + 1; // Tag value 0 means that a packet is not tagged.
+}
+
+
+uint32_t
+BatchSendHelper::GetLost( Ns3FMUBackendEventQueue::Receiver receiver ) const
+{
+	uint32_t lost = 0;
+	for ( std::vector<Result>::const_iterator it = m_results.begin(); it != m_results.end(); ++it )
+		if ( ( receiver == it->receiver ) && ( true == it->delay.IsNegative() ) ) ++lost;
+
+	return lost;
+}
+
+
+} // namespace ns3
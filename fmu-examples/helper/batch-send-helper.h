@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BATCH_SEND_HELPER_H
+#define BATCH_SEND_HELPER_H
+
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/application-container.h"
+#include "ns3/fmu-event-queue.h"
+
+
+namespace ns3 {
+
+
+/**
+ * \ingroup fmu-example
+ * \brief Run all messages sent at the same synchronization point with a single simulation.
+ *
+ * Instead of running one simulation per message, all client applications (senders) and server
+ * applications (receivers) are registered with this helper and started at the same time. After
+ * the simulation has been run, the delay of each message is retrieved from its receiver.
+ *
+ * The packets sent by client applications derived from ClientBase are tagged with a key that is unique
+ * within the batch (the FMI message IDs are only unique per sender). Hence, receivers can record the
+ * delay of every message individually, which allows to send several messages to the same receiver
+ * within a single simulation run (even with the same message ID).
+ */
+class BatchSendHelper
+{
+
+public:
+
+	/**
+	 * \brief Result of a message transmission.
+	 */
+	struct Result
+	{
+		Ns3FMUBackendEventQueue::MessageID msg_id; //!< Message ID.
+		Ns3FMUBackendEventQueue::Receiver receiver; //!< Output variable associated to the message.
+		Time delay; //!< End-to-end delay (negative if the message has not been received).
+	};
+
+	/**
+	 * \param start The time at which all senders are started.
+	 * \param stop The time at which the simulation is stopped.
+	 */
+	BatchSendHelper( Time start = Seconds( 1.0 ), Time stop = Seconds( 10.0 ) );
+
+	/**
+	 * \brief Add receivers (started at the beginning of the simulation).
+	 * \param servers The server applications.
+	 */
+	void AddReceivers( ApplicationContainer servers );
+
+	/**
+	 * \brief Add a message.
+	 * \param clients The client applications sending the message.
+	 * \param delay Callback for retrieving the end-to-end delay after the simulation (typically a getter of the receiving server).
+	 * \param msg_id The message ID.
+	 * \param receiver The output variable associated to the message.
+	 * \param offset Start of the clients relative to the start time of all senders.
+	 */
+	void AddMessage( ApplicationContainer clients, Callback<Time> delay,
+		Ns3FMUBackendEventQueue::MessageID msg_id, Ns3FMUBackendEventQueue::Receiver receiver,
+		Time offset = Seconds( 0.0 ) );
+
+	/**
+	 * \brief Add a message, whose delay is retrieved from the receiver via the message ID.
+	 * \param clients The client applications sending the message.
+	 * \param delay Callback for retrieving the end-to-end delay of a message by its tag after the simulation (typically ServerBase::GetMessageDelay).
+	 *        The packets are tagged with a key that is unique within the batch (not with the message ID).
+	 * \param msg_id The message ID.
+	 * \param receiver The output variable associated to the message.
+	 * \param offset Start of the clients relative to the start time of all senders.
+	 */
+	void AddMessage( ApplicationContainer clients, Callback<Time, int32_t> delay,
+		Ns3FMUBackendEventQueue::MessageID msg_id, Ns3FMUBackendEventQueue::Receiver receiver,
+		Time offset = Seconds( 0.0 ) );
+
+	/**
+	 * \brief Run a single simulation for all messages and retrieve their delays.
+	 * \returns The results for all messages (in the order they have been added).
+	 */
+	const std::vector<Result>& Run();
+
+	/**
+	 * \brief Count the lost messages, i.e., the messages sent that have not been received (call after Run).
+	 * \param receiver The output variable associated to the messages.
+	 * \returns The number of lost messages associated to this output variable.
+	 */
+	uint32_t GetLost( Ns3FMUBackendEventQueue::Receiver receiver ) const;
+
+private:
+
+	/**
+	 * \brief Start the client applications and tag their packets with the key of the message.
+	 */
+	void AddClients( ApplicationContainer clients, Ns3FMUBackendEventQueue::MessageID msg_id,
+		Ns3FMUBackendEventQueue::Receiver receiver, Time offset );
+
+	/**
+	 * \param index The index of the message (in the order the messages have been added).
+	 * \returns The key the packets of the message are tagged with.
+	 */
+	static int32_t GetKey( size_t index );
+
+	Time m_start; //!< Start time of the senders.
+	Time m_stop; //!< Stop time of the simulation.
+
+	std::vector<Callback<Time> > m_delays; //!< Callbacks for retrieving the delays.
+	std::vector<Callback<Time, int32_t> > m_messageDelays; //!< Callbacks for retrieving the delays by message ID.
+	std::vector<Result> m_results; //!< Results.
+
+};
+
+
+} // namespace ns3
+
+
+#endif // BATCH_SEND_HELPER_H
@@ -14,6 +14,8 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
+
 #include "ns3/log.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -29,6 +31,7 @@
 #include "ns3/seq-ts-header.h"
 
 #include "ns3/client-base.h"
+#include "ns3/message-id-tag.h"
 
 
 namespace ns3 {
@@ -43,8 +46,10 @@ ClientBase::ClientBase()
 {
 	NS_LOG_FUNCTION( this );
 	m_sent = 0;
+	m_messageId = 0;
 	m_socket = 0;
 	m_sendEvent = EventId();
+	m_template = 0;
 	m_data = 0;
 	m_dataSize = 0;
 }
@@ -54,6 +59,7 @@ ClientBase::~ClientBase()
 {
 	NS_LOG_FUNCTION( this );
 	m_socket = 0;
+	m_template = 0;
 
 	delete [] m_data;
 	m_data = 0;
@@ -93,6 +99,9 @@ ClientBase::StartApplication()
 
 	if ( m_socket == 0 )
 	{
+		// The address type is resolved only once, the resulting peer name is used for logging.
+		std::ostringstream peerName;
+
 		TypeId tid = TypeId::LookupByName( "ns3::UdpSocketFactory" );
 		m_socket = Socket::CreateSocket( GetNode(), tid );
 		if ( Ipv4Address::IsMatchingType( m_peerAddress ) == true )
@@ -102,6 +111,7 @@ ClientBase::StartApplication()
 				NS_FATAL_ERROR( "Failed to bind socket" );
 			}
 			m_socket->Connect( InetSocketAddress( Ipv4Address::ConvertFrom( m_peerAddress ), m_peerPort ) );
+			peerName << Ipv4Address::ConvertFrom( m_peerAddress ) << " port " << m_peerPort;
 		}
 		else if ( Ipv6Address::IsMatchingType( m_peerAddress ) == true )
 		{
@@ -110,6 +120,7 @@ ClientBase::StartApplication()
 				NS_FATAL_ERROR( "Failed to bind socket" );
 			}
 			m_socket->Connect( Inet6SocketAddress( Ipv6Address::ConvertFrom( m_peerAddress ), m_peerPort ) );
+			peerName << Ipv6Address::ConvertFrom( m_peerAddress ) << " port " << m_peerPort;
 		}
 		else if ( InetSocketAddress::IsMatchingType( m_peerAddress ) == true )
 		{
@@ -118,6 +129,8 @@ ClientBase::StartApplication()
 				NS_FATAL_ERROR( "Failed to bind socket" );
 			}
 			m_socket->Connect( m_peerAddress );
+			peerName << InetSocketAddress::ConvertFrom( m_peerAddress ).GetIpv4()
+				<< " port " << InetSocketAddress::ConvertFrom( m_peerAddress ).GetPort();
 		}
 		else if ( Inet6SocketAddress::IsMatchingType( m_peerAddress ) == true )
 		{
@@ -126,15 +139,20 @@ ClientBase::StartApplication()
 				NS_FATAL_ERROR( "Failed to bind socket" );
 			}
 			m_socket->Connect( m_peerAddress );
+			peerName << Inet6SocketAddress::ConvertFrom( m_peerAddress ).GetIpv6()
+				<< " port " << Inet6SocketAddress::ConvertFrom( m_peerAddress ).GetPort();
 		}
 		else
 		{
 			NS_ASSERT_MSG( false, "Incompatible address type: " << m_peerAddress );
 		}
+
+		m_peerName = peerName.str();
 	}
 
 	SetCallback();
 	m_socket->SetAllowBroadcast( true );
+	BuildPacketTemplate();
 	ScheduleTransmit( Seconds( 0. ) );
 }
 
@@ -169,6 +187,7 @@ ClientBase::SetDataSize( uint32_t dataSize )
 	m_data = 0;
 	m_dataSize = 0;
 	m_size = dataSize;
+	m_template = 0;
 }
 
 
@@ -200,6 +219,7 @@ ClientBase::SetFill( std::string fill )
 	// Overwrite packet size attribute.
 	//
 	m_size = dataSize;
+	m_template = 0;
 }
 
 
@@ -220,6 +240,7 @@ ClientBase::SetFill( uint8_t fill, uint32_t dataSize )
 	// Overwrite packet size attribute.
 	//
 	m_size = dataSize;
+	m_template = 0;
 }
 
 
@@ -238,6 +259,7 @@ ClientBase::SetFill( uint8_t *fill, uint32_t fillSize, uint32_t dataSize )
 	{
 		memcpy( m_data, fill, dataSize );
 		m_size = dataSize;
+		m_template = 0;
 		return;
 	}
 
@@ -260,6 +282,16 @@ ClientBase::SetFill( uint8_t *fill, uint32_t fillSize, uint32_t dataSize )
 	// Overwrite packet size attribute.
 	//
 	m_size = dataSize;
+	m_template = 0;
+}
+
+
+void
+ClientBase::SetMessageId( int32_t messageId )
+{
+	NS_LOG_FUNCTION( this << messageId );
+	m_messageId = messageId;
+	m_template = 0;
 }
 
 
@@ -272,16 +304,14 @@ ClientBase::ScheduleTransmit( Time dt )
 
 
 void
-ClientBase::Send()
+ClientBase::BuildPacketTemplate()
 {
 	NS_LOG_FUNCTION( this );
 
-	NS_ASSERT( m_sendEvent.IsExpired() );
+	// The SeqTs header is added to every packet, the template only holds the remaining payload.
+	uint32_t headerSize = SeqTsHeader().GetSerializedSize();
+	uint32_t payloadSize = ( m_size > headerSize ) ? m_size - headerSize : 0;
 
-	// Integrate a header with the send time on the packet.
-	SeqTsHeader seqTs;
-	seqTs.SetSeq( m_sent );
-	Ptr<Packet> p;
 	if ( m_dataSize )
 	{
 		//
@@ -290,12 +320,9 @@ ClientBase::Send()
 		// the Fill functions is called.  In this case, m_size must have been set
 		// to agree with m_dataSize
 		//
-		NS_ASSERT_MSG( m_dataSize == m_size, "ClientBase::Send(): m_size and m_dataSize inconsistent" );
-		NS_ASSERT_MSG( m_data, "ClientBase::Send(): m_dataSize but no m_data" );
-		p = Create<Packet>( m_data - ( 8+4 ), m_dataSize - ( 8+4 ) );
-
-		// Integrate the seqTs to the packet.
-		p->AddHeader( seqTs );
+		NS_ASSERT_MSG( m_dataSize == m_size, "ClientBase::BuildPacketTemplate(): m_size and m_dataSize inconsistent" );
+		NS_ASSERT_MSG( m_data, "ClientBase::BuildPacketTemplate(): m_dataSize but no m_data" );
+		m_template = Create<Packet>( m_data, payloadSize );
 	}
 	else
 	{
@@ -306,10 +333,29 @@ ClientBase::Send()
 		// this case, we don't worry about it either.  But we do allow m_size
 		// to have a value different from the(zero) m_dataSize.
 		//
-		p = Create<Packet>( m_size - ( 8+4 ) );
+		m_template = Create<Packet>( payloadSize );
 	}
 
-	// Integrate the seqTsHeader to the packet.
+	// Tag the packet with the message ID (does not change the packet size).
+	if ( 0 != m_messageId ) m_template->AddPacketTag( MessageIdTag( m_messageId ) );
+}
+
+
+void
+ClientBase::Send()
+{
+	NS_LOG_FUNCTION( this );
+
+	NS_ASSERT( m_sendEvent.IsExpired() );
+
+	if ( m_template == 0 ) BuildPacketTemplate();
+
+	// Copy the template (the payload buffer is shared copy-on-write) and stamp it with
+	// a header holding the sequence number and the send time.
+	Ptr<Packet> p = m_template->Copy();
+
+	SeqTsHeader seqTs;
+	seqTs.SetSeq( m_sent );
 	p->AddHeader( seqTs );
 
 	// call to the trace sinks before the packet is actually sent,
@@ -319,28 +365,8 @@ ClientBase::Send()
 
 	++m_sent;
 
-	if ( Ipv4Address::IsMatchingType( m_peerAddress ) )
-	{
-		NS_LOG_INFO( "At time " << Simulator::Now().GetSeconds() << "s client sent " << m_size
-			<< " bytes to " << Ipv4Address::ConvertFrom( m_peerAddress ) << " port " << m_peerPort );
-	}
-	else if ( Ipv6Address::IsMatchingType( m_peerAddress ) )
-	{
-		NS_LOG_INFO( "At time " << Simulator::Now().GetSeconds() << "s client sent " << m_size
-			<< " bytes to " << Ipv6Address::ConvertFrom( m_peerAddress ) << " port " << m_peerPort );
-	}
-	else if ( InetSocketAddress::IsMatchingType( m_peerAddress ) )
-	{
-		NS_LOG_INFO( "At time " << Simulator::Now().GetSeconds() << "s client sent " << m_size
-			<< " bytes to " << InetSocketAddress::ConvertFrom( m_peerAddress ).GetIpv4()
-			<< " port " << InetSocketAddress::ConvertFrom( m_peerAddress ).GetPort() );
-	}
-	else if ( Inet6SocketAddress::IsMatchingType( m_peerAddress ) )
-	{
-		NS_LOG_INFO( "At time " << Simulator::Now().GetSeconds() << "s client sent " << m_size
-			<< " bytes to " << Inet6SocketAddress::ConvertFrom( m_peerAddress ).GetIpv6()
-			<< " port " << Inet6SocketAddress::ConvertFrom( m_peerAddress ).GetPort() );
-	}
+	NS_LOG_INFO( "At time " << Simulator::Now().GetSeconds() << "s client sent " << m_size
+		<< " bytes to " << m_peerName );
 
 	if ( m_sent < m_count )
 	{
@@ -87,6 +87,11 @@ public:
 	 */
 	void SetFill( uint8_t *fill, uint32_t fillSize, uint32_t dataSize );
 
+	/**
+	 * \param messageId The ID of the FMU message the sent packets belong to (0 for untagged packets).
+	 */
+	void SetMessageId( int32_t messageId );
+
 protected:
 
 	virtual void DoDispose();
@@ -109,6 +114,11 @@ private:
 	 */
 	void Send();
 
+	/**
+	 * \brief Build the packet template (payload and message ID tag), which is copied for every packet sent.
+	 */
+	void BuildPacketTemplate();
+
 protected:
 
 	uint32_t m_count; //!< Maximum number of packets the application will send
@@ -118,12 +128,17 @@ protected:
 	uint32_t m_dataSize; //!< packet payload size (must be equal to m_size)
 	uint8_t *m_data; //!< packet payload data
 
+	int32_t m_messageId; //!< Message ID attached to sent packets (0 if packets are not tagged)
+
 	uint32_t m_sent; //!< Counter for sent packets
 	Ptr<Socket> m_socket; //!< Socket
 	Address m_peerAddress; //!< Remote peer address
 	uint16_t m_peerPort; //!< Remote peer port
 	EventId m_sendEvent; //!< Event to send the next packet
 
+	Ptr<Packet> m_template; //!< Packet template without SeqTs header (0 if it has to be rebuilt)
+	std::string m_peerName; //!< Remote peer address and port (for logging)
+
 	/// Callbacks for tracing the packet Tx events
 	TracedCallback<Ptr<const Packet> > m_txTrace;
 
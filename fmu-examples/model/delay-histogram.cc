@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <cmath>
+
+#include "delay-histogram.h"
+
+
+namespace ns3 {
+
+
+DelayHistogram::DelayHistogram()
+{
+	Reset();
+}
+
+
+void
+DelayHistogram::Add( Time delay )
+{
+	int64_t value = delay.GetNanoSeconds();
+	if ( 0 > value ) return;
+
+	++m_counts[GetBucket( value )];
+
+	if ( ( 0 == m_count ) || ( value < m_min ) ) m_min = value;
+	if ( ( 0 == m_count ) || ( value > m_max ) ) m_max = value;
+	m_sum += value;
+	++m_count;
+}
+
+
+void
+DelayHistogram::Merge( const DelayHistogram& other )
+{
+	if ( 0 == other.m_count ) return;
+
+	for ( uint32_t i = 0; i < N_BUCKETS; ++i ) m_counts[i] += other.m_counts[i];
+
+	if ( ( 0 == m_count ) || ( other.m_min < m_min ) ) m_min = other.m_min;
+	if ( ( 0 == m_count ) || ( other.m_max > m_max ) ) m_max = other.m_max;
+	m_sum += other.m_sum;
+	m_count += other.m_count;
+}
+
+
+void
+DelayHistogram::Reset()
+{
+	std::memset( m_counts, 0, sizeof( m_counts ) );
+	m_count = 0;
+	m_min = 0;
+	m_max = 0;
+	m_sum = 0.;
+}
+
+
+Time
+DelayHistogram::GetMin() const
+{
+	return NanoSeconds( m_min );
+}
+
+
+Time
+DelayHistogram::GetMax() const
+{
+	return NanoSeconds( m_max );
+}
+
+
+Time
+DelayHistogram::GetMean() const
+{
+	if ( 0 == m_count ) return NanoSeconds( 0 );
+	return NanoSeconds( static_cast<int64_t>( std::floor( m_sum / m_count + 0.5 ) ) );
+}
+
+
+Time
+DelayHistogram::GetPercentile( double q ) const
+{
+	if ( 0 == m_count ) return NanoSeconds( 0 );
+
+	// Rank of the requested delay (1-based).
+	uint64_t rank = static_cast<uint64_t>( std::ceil( q * m_count ) );
+	if ( 1 > rank ) rank = 1;
+	if ( m_count < rank ) rank = m_count;
+
+	uint64_t n = 0;
+	for ( uint32_t i = 0; i < N_BUCKETS; ++i )
+	{
+		n += m_counts[i];
+		if ( n < rank ) continue;
+
+		// Use the middle of the bucket, restricted to the range of recorded delays.
+		int64_t lower = GetBucketLowerBound( i );
+		int64_t value = lower + ( GetBucketUpperBound( i ) - lower ) / 2;
+		if ( value < m_min ) value = m_min;
+		if ( value > m_max ) value = m_max;
+		return NanoSeconds( value );
+	}
+
+	return NanoSeconds( m_max );
+}
+
+
+// Values smaller than 2^SUB_BUCKET_BITS have their own bucket. Larger values are assigned to
+// one of the 2^SUB_BUCKET_BITS sub-buckets of their power of two.
+uint32_t
+DelayHistogram::GetBucket( int64_t value )
+{
+	uint64_t v = static_cast<uint64_t>( value );
+	if ( v < ( 1u << SUB_BUCKET_BITS ) ) return static_cast<uint32_t>( v );
+
+	uint32_t exponent = 63 - __builtin_clzll( v );
+	uint32_t sub = static_cast<uint32_t>( v >> ( exponent - SUB_BUCKET_BITS ) ) & ( ( 1u << SUB_BUCKET_BITS ) - 1 );
+
+	return ( ( exponent - SUB_BUCKET_BITS + 1 ) << SUB_BUCKET_BITS ) + sub;
+}
+
+
+int64_t
+DelayHistogram::GetBucketLowerBound( uint32_t bucket )
+{
+	if ( bucket < ( 1u << SUB_BUCKET_BITS ) ) return bucket;
+
+	uint32_t exponent = ( bucket >> SUB_BUCKET_BITS ) + SUB_BUCKET_BITS - 1;
+	uint64_t sub = bucket & ( ( 1u << SUB_BUCKET_BITS ) - 1 );
+
+	return static_cast<int64_t>( ( ( 1ull << SUB_BUCKET_BITS ) + sub ) << ( exponent - SUB_BUCKET_BITS ) );
+}
+
+
+int64_t
+DelayHistogram::GetBucketUpperBound( uint32_t bucket )
+{
+	if ( bucket < ( 1u << SUB_BUCKET_BITS ) ) return bucket;
+
+	uint32_t exponent = ( bucket >> SUB_BUCKET_BITS ) + SUB_BUCKET_BITS - 1;
+
+	return GetBucketLowerBound( bucket ) + static_cast<int64_t>( ( 1ull << ( exponent - SUB_BUCKET_BITS ) ) - 1 );
+}
+
+
+} // namespace ns3
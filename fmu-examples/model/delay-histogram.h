@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DELAY_HISTOGRAM_H
+#define DELAY_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+
+
+namespace ns3 {
+
+
+/**
+ * \ingroup fmu-example
+ * \brief Streaming histogram of end-to-end delays with fixed memory footprint.
+ *
+ * Delays are recorded in logarithmic buckets: each power of two (in nanoseconds) is split into
+ * 8 linear sub-buckets, hence percentiles are accurate within 12.5% (relative error).
+ * Minimum, maximum and mean are exact.
+ */
+class DelayHistogram
+{
+
+public:
+
+	DelayHistogram();
+
+	/**
+	 * \brief Record a delay (negative delays are ignored).
+	 * \param delay The delay.
+	 */
+	void Add( Time delay );
+
+	/**
+	 * \brief Add all delays recorded by another histogram.
+	 * \param other The other histogram.
+	 */
+	void Merge( const DelayHistogram& other );
+
+	/**
+	 * \brief Remove all recorded delays.
+	 */
+	void Reset();
+
+	uint64_t GetCount() const { return m_count; }
+	Time GetMin() const;
+	Time GetMax() const;
+	Time GetMean() const;
+
+	/**
+	 * \param q The quantile (between 0 and 1).
+	 * \returns The approximate q-quantile of the recorded delays (zero if no delay has been recorded).
+	 */
+	Time GetPercentile( double q ) const;
+
+private:
+
+	static const uint32_t SUB_BUCKET_BITS = 3; //!< 2^3 sub-buckets per power of two.
+	static const uint32_t N_BUCKETS = ( 64 - SUB_BUCKET_BITS ) << SUB_BUCKET_BITS; //!< Buckets for all positive 64-bit values.
+
+	static uint32_t GetBucket( int64_t value );
+	static int64_t GetBucketLowerBound( uint32_t bucket );
+	static int64_t GetBucketUpperBound( uint32_t bucket );
+
+	uint64_t m_counts[N_BUCKETS]; //!< Number of delays per bucket.
+	uint64_t m_count; //!< Number of recorded delays.
+	int64_t m_min; //!< Minimum delay (in nanoseconds).
+	int64_t m_max; //!< Maximum delay (in nanoseconds).
+	double m_sum; //!< Sum of all delays (in nanoseconds).
+
+};
+
+
+} // namespace ns3
+
+
+#endif // DELAY_HISTOGRAM_H
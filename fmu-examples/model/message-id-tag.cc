@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "message-id-tag.h"
+
+
+namespace ns3 {
+
+
+NS_OBJECT_ENSURE_REGISTERED( MessageIdTag );
+
+
+TypeId
+MessageIdTag::GetTypeId()
+{
+	static TypeId tid = TypeId( "ns3::MessageIdTag" )
+	.SetParent<Tag>()
+	.SetGroupName( "Applications" )
+	.AddConstructor<MessageIdTag>();
+
+	return tid;
+}
+
+
+TypeId
+MessageIdTag::GetInstanceTypeId() const
+{
+	return GetTypeId();
+}
+
+
+uint32_t
+MessageIdTag::GetSerializedSize() const
+{
+	return 4;
+}
+
+
+void
+MessageIdTag::Serialize( TagBuffer i ) const
+{
+	i.WriteU32( static_cast<uint32_t>( m_messageId ) );
+}
+
+
+void
+MessageIdTag::Deserialize( TagBuffer i )
+{
+	m_messageId = static_cast<int32_t>( i.ReadU32() );
+}
+
+
+void
+MessageIdTag::Print( std::ostream &os ) const
+{
+	os << "MessageId=" << m_messageId;
+}
+
+
+namespace {
+
+	bool entryLess( const MessageDelays::Entry& entry, int32_t messageId )
+	{
+		return entry.first < messageId;
+	}
+}
+
+
+bool
+MessageDelays::Record( Ptr<const Packet> packet, Time delay )
+{
+	MessageIdTag tag;
+	if ( false == packet->PeekPacketTag( tag ) ) return false;
+
+	return Record( tag.GetMessageId(), delay );
+}
+
+
+bool
+MessageDelays::Record( int32_t messageId, Time delay )
+{
+	if ( 0 == messageId ) return false;
+
+	std::vector<Entry>::iterator it = std::lower_bound( m_delays.begin(), m_delays.end(), messageId, entryLess );
+	if ( ( m_delays.end() != it ) && ( messageId == it->first ) ) return false;
+
+	m_delays.insert( it, Entry( messageId, delay ) );
+	return true;
+}
+
+
+Time
+MessageDelays::Get( int32_t messageId ) const
+{
+	std::vector<Entry>::const_iterator it = std::lower_bound( m_delays.begin(), m_delays.end(), messageId, entryLess );
+	if ( ( m_delays.end() == it ) || ( messageId != it->first ) ) return Seconds( -1 );
+
+	return it->second;
+}
+
+
+} // namespace ns3
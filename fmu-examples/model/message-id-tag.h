@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"bsd"; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MESSAGE_ID_TAG_H
+#define MESSAGE_ID_TAG_H
+
+#include <vector>
+#include <utility>
+
+#include "ns3/tag.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+
+namespace ns3 {
+
+
+/**
+ * \ingroup fmu-example
+ * \brief Packet tag carrying the ID of the FMU message a packet belongs to.
+ *
+ * The ID has to be unique among the messages of a simulation run (e.g., BatchSendHelper uses a key that
+ * is unique within the batch, since FMI message IDs are only unique per sender). The tag does not change
+ * the size of the packet, hence it does not affect the simulated delays.
+ */
+class MessageIdTag : public Tag
+{
+
+public:
+
+	/**
+	 * \brief Get the type ID.
+	 * \return the object TypeId
+	 */
+	static TypeId GetTypeId();
+
+	MessageIdTag( int32_t messageId = 0 ) : m_messageId( messageId ) {}
+
+	virtual TypeId GetInstanceTypeId() const;
+	virtual uint32_t GetSerializedSize() const;
+	virtual void Serialize( TagBuffer i ) const;
+	virtual void Deserialize( TagBuffer i );
+	virtual void Print( std::ostream &os ) const;
+
+	void SetMessageId( int32_t messageId ) { m_messageId = messageId; }
+	int32_t GetMessageId() const { return m_messageId; }
+
+private:
+
+	int32_t m_messageId; //!< Message ID (0 if the packet does not belong to a message).
+
+};
+
+
+/**
+ * \ingroup fmu-example
+ * \brief End-to-end delays of received messages, stored as flat map (sorted by message ID).
+ *
+ * Only the first packet received for each message is taken into account.
+ */
+class MessageDelays
+{
+
+public:
+
+	typedef std::pair<int32_t, Time> Entry; //!< Message ID and end-to-end delay.
+
+	/**
+	 * \brief Record the delay of a packet (ignored if the packet has no message ID tag).
+	 * \param packet The received packet.
+	 * \param delay The end-to-end delay of the packet.
+	 * \returns True in case the delay has been recorded.
+	 */
+	bool Record( Ptr<const Packet> packet, Time delay );
+
+	/**
+	 * \brief Record the delay of a message.
+	 * \param messageId The message ID.
+	 * \param delay The end-to-end delay of the message.
+	 * \returns True in case the delay has been recorded.
+	 */
+	bool Record( int32_t messageId, Time delay );
+
+	/**
+	 * \param messageId The message ID.
+	 * \returns The end-to-end delay of the message (negative if the message has not been received).
+	 */
+	Time Get( int32_t messageId ) const;
+
+	/**
+	 * \returns The delays of all received messages (sorted by message ID).
+	 */
+	const std::vector<Entry>& GetAll() const { return m_delays; }
+
+	void Clear() { m_delays.clear(); }
+
+private:
+
+	std::vector<Entry> m_delays; //!< Delays (sorted by message ID).
+
+};
+
+
+} // namespace ns3
+
+
+#endif // MESSAGE_ID_TAG_H
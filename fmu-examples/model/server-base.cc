@@ -54,6 +54,53 @@ ServerBase::~ServerBase()
 }
 
 
+DelayHistogram
+ServerBase::GetFlowDelays( const Address& flow ) const
+{
+	FlowMap::const_iterator it = m_flows.find( flow );
+	if ( m_flows.end() == it ) return DelayHistogram();
+
+	return it->second;
+}
+
+
+DelayHistogram
+ServerBase::GetDelays() const
+{
+	DelayHistogram delays;
+	for ( FlowMap::const_iterator it = m_flows.begin(); it != m_flows.end(); ++it )
+		delays.Merge( it->second );
+
+	return delays;
+}
+
+
+std::vector<Address>
+ServerBase::GetFlows() const
+{
+	std::vector<Address> flows;
+	for ( FlowMap::const_iterator it = m_flows.begin(); it != m_flows.end(); ++it )
+		flows.push_back( it->first );
+
+	return flows;
+}
+
+
+void
+ServerBase::RecordDelay( Ptr<const Packet> packet, const Address& from, Time delay )
+{
+	m_delays.Record( packet, delay );
+
+	// Flows are identified by the source IP address only (the source port may differ between packets).
+	if ( InetSocketAddress::IsMatchingType( from ) )
+		m_flows[InetSocketAddress::ConvertFrom( from ).GetIpv4()].Add( delay );
+	else if ( Inet6SocketAddress::IsMatchingType( from ) )
+		m_flows[Inet6SocketAddress::ConvertFrom( from ).GetIpv6()].Add( delay );
+	else
+		m_flows[from].Add( delay );
+}
+
+
 void
 ServerBase::DoDispose()
 {
@@ -17,12 +17,16 @@
 #ifndef SERVER_BASE_H
 #define SERVER_BASE_H
 
+#include <map>
+#include <vector>
+
 #include "ns3/application.h"
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/address.h"
-#include "ns3/packet-loss-counter.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/message-id-tag.h"
+#include "ns3/delay-histogram.h"
 
 
 namespace ns3 {
@@ -47,11 +51,46 @@ public:
 
 	virtual ~ServerBase();
 
+	/**
+	 * \param messageId The message ID.
+	 * \returns The end-to-end delay of the message (negative if the message has not been received).
+	 */
+	Time GetMessageDelay( int32_t messageId ) const { return m_delays.Get( messageId ); }
+
+	/**
+	 * \returns The end-to-end delays of all received messages.
+	 */
+	const MessageDelays& GetMessageDelays() const { return m_delays; }
+
+	/**
+	 * \param flow The source IP address of the flow.
+	 * \returns The end-to-end delays of all packets received from this source (empty if the flow is unknown).
+	 */
+	DelayHistogram GetFlowDelays( const Address& flow ) const;
+
+	/**
+	 * \returns The end-to-end delays of all received packets (all flows).
+	 */
+	DelayHistogram GetDelays() const;
+
+	/**
+	 * \returns The source IP addresses of all flows.
+	 */
+	std::vector<Address> GetFlows() const;
+
 protected:
 
 	virtual void DoDispose();
 
 	virtual void SetCallback() {}
+
+	/**
+	 * \brief Record the end-to-end delay of a received packet (call from the receive callback).
+	 * \param packet The received packet.
+	 * \param from The source address of the packet.
+	 * \param delay The end-to-end delay of the packet.
+	 */
+	void RecordDelay( Ptr<const Packet> packet, const Address& from, Time delay );
 	
 private:
 
@@ -74,10 +113,13 @@ protected:
 	Ptr<Socket> m_socket6; //!< IPv6 Socket
 	Address m_local; //!< local multicast address
 
-	double smartMeterA_del;
-	double smartMeterB_del;
-	Address m_smartMeterA;
-	Address m_smartMeterB;
+	MessageDelays m_delays; //!< End-to-end delays of received messages (tagged with a message ID)
+
+private:
+
+	typedef std::map<Address, DelayHistogram> FlowMap;
+
+	FlowMap m_flows; //!< End-to-end delays per flow (indexed by source IP address).
 
 };
 
@@ -16,6 +16,7 @@
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/integer.h"
 
 #include "tc3-controller-client.h"
 
@@ -60,6 +61,11 @@ TC3ControllerClient::GetTypeId()
 		MakeUintegerAccessor( &TC3ControllerClient::SetDataSize,
 		&TC3ControllerClient::GetDataSize ),
 		MakeUintegerChecker<uint32_t>() )
+	.AddAttribute( "MessageId",
+		"The ID of the FMU message the outbound packets belong to (0 for untagged packets)",
+		IntegerValue( 0 ),
+		MakeIntegerAccessor( &TC3ControllerClient::m_messageId ),
+		MakeIntegerChecker<int32_t>() )
 	.AddTraceSource( "Tx", "A new packet is created and is sent",
 		MakeTraceSourceAccessor( &TC3ControllerClient::m_txTrace ),
 		"ns3::Packet::TracedCallback" );
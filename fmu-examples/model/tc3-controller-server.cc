@@ -83,9 +83,12 @@ TC3ControllerServer::HandleRead( Ptr<Socket> socket )
 			packet->PeekHeader( seqTs,12 );
 			Ipv4Address ipAddress = InetSocketAddress::ConvertFrom( from ).GetIpv4();
 
+			Time delay = Simulator::Now() - seqTs.GetTs();
+			RecordDelay( packet, from, delay );
+
 			if ( ipAddress == m_smartMeterA )
 			{
-				smartMeterA_del = Simulator::Now().GetSeconds() - seqTs.GetTs().GetSeconds();
+				smartMeterA_del = delay;
 				NS_LOG_INFO( "At time " << Simulator::Now().GetSeconds()
 					<< "s controller received " << packet->GetSize()
 					<< " bytes from smartmeter (" << InetSocketAddress::ConvertFrom( from ).GetIpv4()
@@ -93,7 +96,7 @@ TC3ControllerServer::HandleRead( Ptr<Socket> socket )
 			}
 			else if ( ipAddress == m_smartMeterB )
 			{
-				smartMeterB_del = Simulator::Now().GetSeconds() - seqTs.GetTs().GetSeconds();
+				smartMeterB_del = delay;
 				NS_LOG_INFO( "At time " << Simulator::Now().GetSeconds()
 					<< "s controller received " << packet->GetSize()
 					<< " bytes from smartmeterB (" << InetSocketAddress::ConvertFrom( from ).GetIpv4()
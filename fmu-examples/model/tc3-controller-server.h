@@ -38,12 +38,13 @@ public:
 	 */
 	static TypeId GetTypeId();
 
-	TC3ControllerServer() {}
+	TC3ControllerServer() : smartMeterA_del( Seconds( -1 ) ), smartMeterB_del( Seconds( -1 ) ) {}
 
 	virtual ~TC3ControllerServer() {}
 
-	double GetEndToEndDelay_SMA() const { return smartMeterA_del; }
-	double GetEndToEndDelay_SMB() const { return smartMeterB_del; }
+	// End-to-end delays of the last messages received from the smart meters (negative if no message has been received).
+	Time GetEndToEndDelay_SMA() const { return smartMeterA_del; }
+	Time GetEndToEndDelay_SMB() const { return smartMeterB_del; }
 
 protected:
 
@@ -60,8 +61,8 @@ private:
 	 */
 	void HandleRead( Ptr<Socket> socket );
 
-	double smartMeterA_del;
-	double smartMeterB_del;
+	Time smartMeterA_del;
+	Time smartMeterB_del;
 	Address m_smartMeterA;
 	Address m_smartMeterB;
 
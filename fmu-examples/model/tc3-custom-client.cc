@@ -16,6 +16,7 @@
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/integer.h"
 #include "ns3/socket.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
@@ -67,6 +68,11 @@ TC3CustomClient::GetTypeId()
 		MakeUintegerAccessor( &TC3CustomClient::SetDataSize,
 		&TC3CustomClient::GetDataSize ),
 		MakeUintegerChecker<uint32_t>() )
+	.AddAttribute( "MessageId",
+		"The ID of the FMU message the outbound packets belong to (0 for untagged packets)",
+		IntegerValue( 0 ),
+		MakeIntegerAccessor( &TC3CustomClient::m_messageId ),
+		MakeIntegerChecker<int32_t>() )
 	.AddTraceSource( "Tx", "A new packet is created and is sent",
 		MakeTraceSourceAccessor( &TC3CustomClient::m_txTrace ),
 		"ns3::Packet::TracedCallback" );
@@ -60,7 +60,7 @@ TC3CustomServer::GetTypeId()
 TC3CustomServer::TC3CustomServer()
 {
 	NS_LOG_FUNCTION( this );
-	ete_delay_ = -1;
+	ete_delay_ = Seconds( -1 );
 }
 
 
@@ -173,7 +173,8 @@ TC3CustomServer::HandleRead( Ptr<Socket> socket )
 		packet->RemoveHeader( st_header );
 		Time t_diff = Simulator::Now() - st_header.GetTs();
 
-		ete_delay_ = Simulator::Now().GetSeconds() - st_header.GetTs().GetSeconds();
+		ete_delay_ = t_diff;
+		m_delays.Record( packet, t_diff );
 		//printf( "\nNs3: Inside the application layer. The value of ete delay is %f\n", ete_delay_ );
 
 		if ( InetSocketAddress::IsMatchingType( from ) )
@@ -22,6 +22,8 @@
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/message-id-tag.h"
 
 
 namespace ns3 {
@@ -54,7 +56,18 @@ public:
 	TC3CustomServer();
 	virtual ~TC3CustomServer();
 
-	double GetEndToEndDelay() const { return ete_delay_; }
+	Time GetEndToEndDelay() const { return ete_delay_; }
+
+	/**
+	 * \param messageId The message ID.
+	 * \returns The end-to-end delay of the message (negative if the message has not been received).
+	 */
+	Time GetMessageDelay( int32_t messageId ) const { return m_delays.Get( messageId ); }
+
+	/**
+	 * \returns The end-to-end delays of all received messages.
+	 */
+	const MessageDelays& GetMessageDelays() const { return m_delays; }
 
 protected:
 
@@ -79,7 +92,8 @@ private:
 	Ptr<Socket> m_socket6; //!< IPv6 Socket
 	Address m_local; //!< local multicast address
 
-	double ete_delay_;
+	Time ete_delay_;
+	MessageDelays m_delays; //!< End-to-end delays of received messages (tagged with a message ID)
 };
 
 
@@ -72,7 +72,8 @@ TC3OltcCustomServer::HandleRead( Ptr<Socket> socket )
 	{
 		SeqTsHeader seqTs;
 		packet->PeekHeader( seqTs );
-		controller_del = Simulator::Now().GetSeconds() - seqTs.GetTs().GetSeconds();
+		controller_del = Simulator::Now() - seqTs.GetTs();
+		RecordDelay( packet, from, controller_del );
 
 		if ( InetSocketAddress::IsMatchingType( from ) )
 		{
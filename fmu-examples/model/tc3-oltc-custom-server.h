@@ -38,11 +38,12 @@ public:
 	 */
 	static TypeId GetTypeId();
 
-	TC3OltcCustomServer() {}
+	TC3OltcCustomServer() : controller_del( Seconds( -1 ) ) {}
 	
 	virtual ~TC3OltcCustomServer() {}
 
-	double GetEndToEndDelay() const { return controller_del; }
+	// End-to-end delay of the last message received (negative if no message has been received).
+	Time GetEndToEndDelay() const { return controller_del; }
 
 protected:
 
@@ -59,7 +60,7 @@ private:
 	 */
 	void HandleRead( Ptr<Socket> socket );
 
-	double controller_del;
+	Time controller_del;
 };
 
 
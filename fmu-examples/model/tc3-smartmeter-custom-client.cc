@@ -16,6 +16,7 @@
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/integer.h"
 
 #include "tc3-smartmeter-custom-client.h"
 
@@ -60,6 +61,11 @@ TC3SmartmeterCustomClient::GetTypeId()
 		MakeUintegerAccessor( &TC3SmartmeterCustomClient::SetDataSize,
 		&TC3SmartmeterCustomClient::GetDataSize ),
 		MakeUintegerChecker<uint32_t>() )
+	.AddAttribute( "MessageId",
+		"The ID of the FMU message the outbound packets belong to (0 for untagged packets)",
+		IntegerValue( 0 ),
+		MakeIntegerAccessor( &TC3SmartmeterCustomClient::m_messageId ),
+		MakeIntegerChecker<int32_t>() )
 	.AddTraceSource( "Tx", "A new packet is created and is sent",
 		MakeTraceSourceAccessor( &TC3SmartmeterCustomClient::m_txTrace ),
 		"ns3::Packet::TracedCallback" );